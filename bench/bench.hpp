@@ -0,0 +1,86 @@
+#pragma once
+// Shared helpers for the standalone benchmarks (make bench).
+// Every benchmark binary prints one JSON document to stdout, or to the file
+// given as its first argument.
+
+#include <cstdarg>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "metrics.hpp"
+
+namespace bench {
+
+/// Collects the results of one benchmark binary and writes them as JSON
+class Report {
+public:
+    explicit Report(const char* suite) : m_suite(suite) {}
+
+    /// Latency distribution (nanoseconds)
+    void latency(const std::string& name, const metrics::Histogram& histogram) {
+        metrics::Summary s = histogram.summary();
+        char buffer[256];
+        snprintf(buffer, sizeof(buffer),
+                 "{\"count\": %llu, \"mean_ns\": %.1f, \"p50_ns\": %llu, \"p90_ns\": %llu, \"p99_ns\": %llu, \"max_ns\": %llu}",
+                 static_cast<unsigned long long>(s.count), s.mean_ns,
+                 static_cast<unsigned long long>(s.p50_ns), static_cast<unsigned long long>(s.p90_ns),
+                 static_cast<unsigned long long>(s.p99_ns), static_cast<unsigned long long>(s.max_ns));
+        add(name, buffer);
+    }
+
+    /// Plain number with a unit, e.g. throughput
+    void value(const std::string& name, double value, const char* unit) {
+        char buffer[128];
+        snprintf(buffer, sizeof(buffer), "{\"value\": %.3f, \"unit\": \"%s\"}", value, unit);
+        add(name, buffer);
+    }
+
+    /// Any other JSON value, already serialized
+    void raw(const std::string& name, const std::string& json) {
+        add(name, json);
+    }
+
+    /// A benchmark that could not run here (missing permission, no cgroup v2, ...)
+    void skipped(const std::string& name, const std::string& reason) {
+        add(name, "{\"skipped\": \"" + reason + "\"}");
+    }
+
+    /// @return process exit code
+    int write(int argc, char** argv) const {
+        FILE* out = argc > 1 ? fopen(argv[1], "w") : stdout;
+        if (!out) {
+            fprintf(stderr, "[bench] Could not open %s\n", argv[1]);
+            return 1;
+        }
+        fprintf(out, "{\n  \"suite\": \"%s\",\n  \"results\": {", m_suite);
+        for (size_t i = 0; i < m_entries.size(); ++i) {
+            fprintf(out, "%s\n    \"%s\": %s", i ? "," : "", m_entries[i].first.c_str(), m_entries[i].second.c_str());
+        }
+        fprintf(out, "\n  }\n}\n");
+        if (out != stdout) fclose(out);
+        return 0;
+    }
+
+private:
+    void add(const std::string& name, const std::string& json) {
+        m_entries.emplace_back(name, json);
+    }
+
+    const char* m_suite;
+    std::vector<std::pair<std::string, std::string>> m_entries;
+};
+
+/// Progress/diagnostic line on stderr, so stdout stays valid JSON
+#if defined(__GNUC__)
+__attribute__((format(printf, 1, 2)))
+#endif
+inline void note(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "[bench] ");
+    vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+} // namespace bench
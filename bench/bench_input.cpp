@@ -0,0 +1,143 @@
+// uinput injection benchmark: emit throughput of CrossInput, and round-trip
+// latency from CrossInput::moveMouse() to reading the event back from the
+// evdev node the kernel created for the virtual device.
+//
+// Needs write access to /dev/uinput (root or the input group). Only relative
+// mouse motion is injected (one pixel back and forth), so nothing gets typed
+// into whatever window has focus.
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "inpctrl.hpp"
+#include "bench.hpp"
+
+static const int ROUND_TRIPS = 2000;
+static const int THROUGHPUT_MOVES = 20000;
+
+// Highest-numbered evdev node named like the CrossInput virtual device (the newest one)
+static int openVirtualDeviceNode() {
+    for (int attempt = 0; attempt < 200; ++attempt) {
+        int best_index = -1;
+        DIR* dir = opendir("/dev/input");
+        if (!dir) return -1;
+        struct dirent* ent;
+        while ((ent = readdir(dir)) != nullptr) {
+            if (strncmp(ent->d_name, "event", 5) != 0) continue;
+            std::string path = "/dev/input/" + std::string(ent->d_name);
+            int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK);
+            if (fd < 0) continue;
+            char name[256] = {0};
+            ioctl(fd, EVIOCGNAME(sizeof(name)), name);
+            close(fd);
+            int index = atoi(ent->d_name + 5);
+            if (strcmp(name, "CrossInput Virtual Device") == 0 && index > best_index) best_index = index;
+        }
+        closedir(dir);
+
+        if (best_index >= 0) {
+            std::string path = "/dev/input/event" + std::to_string(best_index);
+            return open(path.c_str(), O_RDONLY | O_NONBLOCK);
+        }
+        // udev creates the node asynchronously
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return -1;
+}
+
+static void drain(int fd) {
+    struct input_event events[64];
+    while (read(fd, events, sizeof(events)) > 0) {
+    }
+}
+
+// Wait for the next REL_X event; returns its kernel timestamp (ns) or 0 on timeout
+static uint64_t waitForMotion(int fd) {
+    struct input_event events[64];
+    struct pollfd pfd = {fd, POLLIN, 0};
+    while (poll(&pfd, 1, 100) > 0) {
+        ssize_t n = read(fd, events, sizeof(events));
+        if (n <= 0) continue;
+        for (size_t i = 0; i < static_cast<size_t>(n) / sizeof(struct input_event); ++i) {
+            if (events[i].type == EV_REL && events[i].code == REL_X) {
+                return static_cast<uint64_t>(events[i].input_event_sec) * 1000000000ULL +
+                       static_cast<uint64_t>(events[i].input_event_usec) * 1000ULL;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    bench::Report report("input");
+
+    if (access("/dev/uinput", W_OK) != 0) {
+        report.skipped("uinput", "no write access to /dev/uinput");
+        return report.write(argc, argv);
+    }
+
+    // CrossInput reports its status on std::cout; keep stdout for the JSON
+    std::streambuf* saved_cout = std::cout.rdbuf(std::cerr.rdbuf());
+
+    CrossInput input;
+    input.init();
+
+    int node = openVirtualDeviceNode();
+    if (node < 0) {
+        report.skipped("uinput", "virtual device node did not appear in /dev/input");
+        input.cleanup();
+        std::cout.rdbuf(saved_cout);
+        return report.write(argc, argv);
+    }
+    int clock_id = CLOCK_MONOTONIC;
+    ioctl(node, EVIOCSCLOCKID, &clock_id);
+    drain(node);
+
+    metrics::Histogram round_trip;
+    metrics::Histogram emit_to_kernel;
+    metrics::Histogram kernel_to_reader;
+    int lost = 0;
+
+    bench::note("measuring %d uinput round trips", ROUND_TRIPS);
+    for (int i = 0; i < ROUND_TRIPS; ++i) {
+        uint64_t start = metrics::now_ns();
+        input.moveMouse(i % 2 ? -1 : 1, 0);
+        uint64_t stamp = waitForMotion(node);
+        uint64_t end = metrics::now_ns();
+
+        if (stamp == 0) {
+            lost++;
+            continue;
+        }
+        round_trip.record(end - start);
+        emit_to_kernel.record(stamp > start ? stamp - start : 0);
+        kernel_to_reader.record(end > stamp ? end - stamp : 0);
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    close(node);
+
+    report.latency("round_trip", round_trip);
+    report.latency("emit_to_kernel_timestamp", emit_to_kernel);
+    report.latency("kernel_timestamp_to_reader", kernel_to_reader);
+    report.value("round_trip_lost", lost, "events");
+
+    bench::note("measuring throughput over %d moveMouse calls", THROUGHPUT_MOVES);
+    uint64_t start = metrics::now_ns();
+    for (int i = 0; i < THROUGHPUT_MOVES; ++i) {
+        input.moveMouse(i % 2 ? -1 : 1, 0);
+    }
+    double seconds = (metrics::now_ns() - start) / 1e9;
+    report.value("move_mouse_throughput", THROUGHPUT_MOVES / seconds, "calls/s");
+
+    input.cleanup();
+    std::cout.rdbuf(saved_cout);
+    return report.write(argc, argv);
+}
@@ -0,0 +1,148 @@
+// logzz benchmark: parse throughput of loop_handle() on a generated log of a
+// few megabytes, written to a temporary logs folder, and the appStorage.json
+// lookups (load_user_info, find_name_for_universe) against a full DOM parse
+// of the same file.
+
+#include <unistd.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include "logzz.hpp"
+#include "bench.hpp"
+
+static const size_t LOG_BYTES = 8 << 20;
+static const int PARSE_ROUNDS = 20;
+static const int STORAGE_GAMES = 20000;   // universes in the discovery cache
+static const int STORAGE_ROUNDS = 20;
+
+// Lines shaped like the client's log: mostly noise, with the join, load time
+// and camfix markers logzz looks for sprinkled in
+static size_t generateLog(const std::string& path) {
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) return 0;
+
+    static const char* noise[] = {
+        "[FLog::Output] Settings Date header was Mon, 06 Jan 2025 12:00:00 GMT",
+        "[FLog::Network] Replicator: received 1432 bytes",
+        "[FLog::Graphics] Frame time spike detected: 21.4ms",
+        "[DFLog::HttpTraceError] HttpResponse(#42) time:120.3ms status:200",
+        "[FLog::Output] Warning: SetPartCollisionGroup is deprecated, please use BasePart.CollisionGroup instead",
+        "[FLog::Output] Workspace.Obby.Stage12.KillBrick:4: attempt to index nil",
+    };
+
+    size_t written = 0;
+    unsigned long long line = 0;
+    while (written < LOG_BYTES) {
+        char buffer[512];
+        int n;
+        if (line % 5000 == 0) {
+            n = snprintf(buffer, sizeof(buffer),
+                         "2025-01-06T12:00:%02llu.000Z,%llu.000000,1a2b,6 [FLog::Output] ! Joining game "
+                         "'0f1e2d3c-4b5a-6978-8796-a5b4c3d2e1f0' place 1818 at 128.116.1.1\n",
+                         line % 60, line);
+        } else if (line % 5000 == 1) {
+            n = snprintf(buffer, sizeof(buffer),
+                         "2025-01-06T12:00:%02llu.000Z,%llu.000000,1a2b,6 [FLog::GameJoinLoadTime] "
+                         "Report game_join_loadtime: placeid:1818, universeid:1142, time:3.25\n",
+                         line % 60, line);
+        } else {
+            n = snprintf(buffer, sizeof(buffer), "2025-01-06T12:00:%02llu.000Z,%llu.000000,1a2b,6 %s\n",
+                         line % 60, line, noise[line % (sizeof(noise) / sizeof(noise[0]))]);
+        }
+        fwrite(buffer, 1, n, f);
+        written += n;
+        line++;
+    }
+    fclose(f);
+    return written;
+}
+
+// appStorage.json as the client writes it: the user keys, a discovery cache
+// (JSON stored as a string) and play history that grows over time
+static size_t generateAppStorage(const std::string& path) {
+    json cache;
+    json& games = cache["data"]["contentMetadata"]["Game"];
+    for (int i = 0; i < STORAGE_GAMES; ++i) {
+        games[std::to_string(1000 + i)] = {{"name", "Experience " + std::to_string(i)}, {"playerCount", i * 7},
+                                           {"totalUpVotes", i * 3}, {"rootPlaceId", 50000 + i}};
+    }
+    json root;
+    json& history = root["RecentlyPlayedGames"];
+    for (int i = 0; i < STORAGE_GAMES; ++i) {
+        history.push_back({{"universeId", 1000 + i}, {"lastPlayed", 1736160000 + i}});
+    }
+    root["DiscoveryClientFallbackCache"] = cache.dump();
+    root["UserId"] = "1234567890";
+    root["Username"] = "bench_user";
+    root["DisplayName"] = "Bench User";
+
+    std::ofstream f(path);
+    std::string text = root.dump();
+    f << text;
+    return text.size();
+}
+
+int main(int argc, char** argv) {
+    bench::Report report("logzz");
+
+    char dir_template[] = "/tmp/hypersuite-bench-XXXXXX";
+    if (!mkdtemp(dir_template)) {
+        report.skipped("parse", "cannot create a temporary directory");
+        return report.write(argc, argv);
+    }
+    std::string dir = dir_template;
+    std::string log_path = dir + "/0.123.0_20250106T120000Z_Player_abcd_last.log";
+
+    size_t bytes = generateLog(log_path);
+    bench::note("generated %zu bytes of log", bytes);
+
+    logzz::logs_folder_path = dir;
+    size_t join_timings = 0;
+    logzz::on_join_timing = [&join_timings](const logzz::JoinTiming&) { ++join_timings; };
+    metrics::Histogram parse;
+    for (int i = 0; i < PARSE_ROUNDS; ++i) {
+        logzz::last_file_size = -1;  // force a full re-read
+        logzz::calculated_placeIDs.clear();
+        uint64_t start = metrics::now_ns();
+        logzz::loop_handle();
+        parse.record(metrics::now_ns() - start);
+    }
+
+    size_t storage_bytes = generateAppStorage(dir + "/appStorage.json");
+    logzz::local_storage_folder_path = dir;
+    metrics::Histogram dom_parse, user_info, universe_name;
+    std::string name;
+    for (int i = 0; i < STORAGE_ROUNDS; ++i) {
+        uint64_t start = metrics::now_ns();
+        std::ifstream f(dir + "/appStorage.json");
+        json root;
+        f >> root;
+        dom_parse.record(metrics::now_ns() - start);
+
+        start = metrics::now_ns();
+        logzz::load_user_info();
+        user_info.record(metrics::now_ns() - start);
+
+        start = metrics::now_ns();
+        name = logzz::find_name_for_universe(1000 + STORAGE_GAMES - 1);
+        universe_name.record(metrics::now_ns() - start);
+    }
+    bench::note("appStorage.json: %zu bytes, user %llu (%s), last universe \"%s\"", storage_bytes,
+                static_cast<unsigned long long>(logzz::current_user_ID), logzz::current_username.c_str(), name.c_str());
+
+    std::filesystem::remove_all(dir);
+
+    metrics::Summary s = parse.summary();
+    report.value("log_bytes", static_cast<double>(bytes), "bytes");
+    report.latency("loop_handle_full_parse", parse);
+    report.value("parse_throughput", s.p50_ns > 0 ? bytes / (s.p50_ns / 1e9) / (1 << 20) : 0.0, "MiB/s");
+    report.value("detected_place_id", static_cast<double>(logzz::current_place_ID), "id");
+    report.value("join_timings_per_parse", static_cast<double>(join_timings) / PARSE_ROUNDS, "lines");
+    report.value("app_storage_bytes", static_cast<double>(storage_bytes), "bytes");
+    report.latency("app_storage_dom_parse", dom_parse);
+    report.latency("load_user_info", user_info);
+    report.latency("find_name_for_universe", universe_name);
+
+    return report.write(argc, argv);
+}
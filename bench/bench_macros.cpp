@@ -0,0 +1,262 @@
+// Macro catalogue on the simulator backend.
+//
+// With the virtual clock every macro runs in microseconds of wall time and
+// produces a deterministic timeline of key, mouse and suspend events. It must
+// match the expected timeline below exactly. A second pass on the real clock
+// measures how late each step wakes up without touching the game; there the
+// events must come in the same order, none early and at most
+// REAL_CLOCK_LATE_US late. Any mismatch makes the bench exit with 1.
+// Last, the per-game profile tables: the bind lookup of a macro tick and the
+// cost of switching tables when the game changes.
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// The app globals (netctrl) report on std::cout while they are constructed;
+// keep stdout for the JSON. Inline so it is initialized before them.
+inline const bool bench_cout_to_stderr = (std::cout.rdbuf(std::cerr.rdbuf()), true);
+
+#include "Macros.hpp"
+#include "HHJ.hpp"
+#include "bench.hpp"
+
+// The spin threads of speedglitch and HHJ run rotations while active; here two
+// of them while the trigger is held, on the bench thread
+static void speedglitchHeld() {
+    const MacroProfile& profile = macroProfile();
+    if (!macro_backend->isKeyPressed(profile.binds[BIND_SPEEDGLITCH])) return;
+    int sleep1 = 0, sleep2 = 0;
+    speedglitchSleeps(profile.roblox_fps, sleep1, sleep2);
+    for (int i = 0; i < 2; ++i) speedglitchRotation(profile, sleep1, sleep2);
+}
+
+// Expected timelines are [time_us, event, key or dx, value] as the bench
+// writes them; regenerate them from its output when a timing changes on purpose
+struct CatalogueEntry {
+    const char* name;
+    const char* bind;
+    void (*run)();
+    const char* expected;
+};
+
+static const CatalogueEntry CATALOGUE[] = {
+    {"freeze", "Freeze", freezeMacro,
+     R"([[0, "suspend", 0, 0], [0, "resume", 0, 0]])"},
+    {"laugh", "Laugh", laughClip,
+     R"([[0, "key_down", 191, 1], [16666, "key_up", 191, 0], [56666, "key_down", 191, 1],
+        [73332, "key_up", 191, 0], [73332, "key_down", 69, 1], [89998, "key_up", 69, 0],
+        [89998, "key_down", 32, 1], [106664, "key_up", 32, 0], [106664, "key_down", 76, 1],
+        [123330, "key_up", 76, 0], [123330, "key_down", 65, 1], [139996, "key_up", 65, 0],
+        [139996, "key_down", 85, 1], [156662, "key_up", 85, 0], [156662, "key_down", 71, 1],
+        [173328, "key_up", 71, 0], [173328, "key_down", 72, 1], [189994, "key_up", 72, 0],
+        [189994, "key_down", 13, 1], [206660, "key_up", 13, 0], [454660, "key_down", 83, 1],
+        [454660, "suspend", 0, 0], [954660, "resume", 0, 0], [954660, "key_down", 32, 1],
+        [954660, "key_down", 160, 1], [989660, "key_up", 32, 0], [989660, "key_up", 160, 0],
+        [1029660, "key_up", 83, 0]])"},
+    {"e-dance", "E-Dance", extendedDanceClip,
+     R"([[0, "key_down", 191, 1], [16666, "key_up", 191, 0], [56666, "key_down", 191, 1],
+        [73332, "key_up", 191, 0], [73332, "key_down", 69, 1], [89998, "key_up", 69, 0],
+        [89998, "key_down", 32, 1], [106664, "key_up", 32, 0], [106664, "key_down", 68, 1],
+        [123330, "key_up", 68, 0], [123330, "key_down", 65, 1], [139996, "key_up", 65, 0],
+        [139996, "key_down", 78, 1], [156662, "key_up", 78, 0], [156662, "key_down", 67, 1],
+        [173328, "key_up", 67, 0], [173328, "key_down", 69, 1], [189994, "key_up", 69, 0],
+        [189994, "key_down", 50, 1], [206660, "key_up", 50, 0], [206660, "key_down", 13, 1],
+        [223326, "key_up", 13, 0], [1038326, "key_down", 68, 1], [1038326, "suspend", 0, 0],
+        [1538326, "resume", 0, 0], [1538326, "key_down", 160, 1], [1588326, "key_up", 160, 0],
+        [1888326, "key_up", 68, 0]])"},
+    {"buckey-clip", "Buckey-clip", BuckeyClip,
+     R"([[0, "key_down", 191, 1], [16666, "key_up", 191, 0], [56666, "key_down", 191, 1],
+        [73332, "key_up", 191, 0], [73332, "key_down", 69, 1], [89998, "key_up", 69, 0],
+        [89998, "key_down", 32, 1], [106664, "key_up", 32, 0], [106664, "key_down", 76, 1],
+        [123330, "key_up", 76, 0], [123330, "key_down", 65, 1], [139996, "key_up", 65, 0],
+        [139996, "key_down", 85, 1], [156662, "key_up", 85, 0], [156662, "key_down", 71, 1],
+        [173328, "key_up", 71, 0], [173328, "key_down", 72, 1], [189994, "key_up", 72, 0],
+        [189994, "key_down", 13, 1], [206660, "key_up", 13, 0], [406660, "key_down", 32, 1],
+        [437660, "key_down", 83, 1], [446660, "key_down", 160, 1], [520660, "key_up", 32, 0],
+        [576660, "key_up", 160, 0], [658660, "key_up", 83, 0]])"},
+    {"spam-key", "Spam-Key", SpamKeyMacro,
+     R"([[0, "key_down", 49, 1], [1000, "key_up", 49, 0]])"},
+    {"disable-head-collision", "Disable-Head-Collision", DisableHeadCollision,
+     R"([[0, "key_down", 191, 1], [16666, "key_up", 191, 0], [56666, "key_down", 191, 1],
+        [73332, "key_up", 191, 0], [73332, "key_down", 69, 1], [89998, "key_up", 69, 0],
+        [89998, "key_down", 32, 1], [106664, "key_up", 32, 0], [106664, "key_down", 76, 1],
+        [123330, "key_up", 76, 0], [123330, "key_down", 65, 1], [139996, "key_up", 65, 0],
+        [139996, "key_down", 85, 1], [156662, "key_up", 85, 0], [156662, "key_down", 71, 1],
+        [173328, "key_up", 71, 0], [173328, "key_down", 72, 1], [189994, "key_up", 72, 0],
+        [189994, "key_down", 13, 1], [206660, "key_up", 13, 0], [406660, "key_down", 160, 1],
+        [422660, "key_up", 160, 0], [422660, "key_down", 32, 1], [438660, "key_up", 32, 0],
+        [438660, "key_down", 160, 1], [454660, "key_up", 160, 0]])"},
+    {"nhc-roof", "NHC-Roof", NHCRoofClip,
+     R"([[0, "key_down", 191, 1], [16666, "key_up", 191, 0], [56666, "key_down", 191, 1],
+        [73332, "key_up", 191, 0], [73332, "key_down", 69, 1], [89998, "key_up", 69, 0],
+        [89998, "key_down", 32, 1], [106664, "key_up", 32, 0], [106664, "key_down", 67, 1],
+        [123330, "key_up", 67, 0], [123330, "key_down", 72, 1], [139996, "key_up", 72, 0],
+        [139996, "key_down", 69, 1], [156662, "key_up", 69, 0], [173328, "key_down", 69, 1],
+        [189994, "key_up", 69, 0], [189994, "key_down", 82, 1], [206660, "key_up", 82, 0],
+        [206660, "key_down", 13, 1], [223326, "key_up", 13, 0], [833326, "key_down", 32, 1],
+        [853326, "suspend", 0, 0], [1153326, "resume", 0, 0], [1173326, "key_up", 32, 0]])"},
+    {"hhj", "HHJ", helicopterHighJump,
+     R"([[0, "suspend", 0, 0], [500000, "resume", 0, 0], [509000, "key_down", 160, 1],
+        [542000, "key_up", 160, 0]])"},
+    {"full-gear-desync", "Full-Gear-Desync", FullGearDesync,
+     R"([[0, "key_down", 50, 1], [50000, "key_up", 50, 0], [90000, "key_down", 8, 1], [140000, "key_up", 8, 0],
+        [340000, "key_down", 49, 1], [390000, "key_up", 49, 0], [430000, "key_down", 87, 1],
+        [830000, "suspend", 0, 0], [830000, "key_down", 49, 1], [860000, "key_up", 49, 0],
+        [890000, "key_down", 49, 1], [920000, "key_up", 49, 0], [1020000, "resume", 0, 0],
+        [1020000, "key_up", 87, 0], [1060000, "key_down", 49, 1], [1110000, "key_up", 49, 0],
+        [1150000, "key_down", 8, 1], [1200000, "key_up", 8, 0]])"},
+    {"floor-bounce-high-jump", "Floor-Bounce-High-Jump", FloorBounceHighJump,
+     R"([[0, "key_down", 32, 1], [521000, "suspend", 0, 0], [593000, "resume", 0, 0],
+        [665000, "suspend", 0, 0], [737000, "resume", 0, 0], [837000, "key_up", 32, 0]])"},
+    {"speedglitch", "Speedglitch", speedglitchHeld,
+     R"([[0, "mouse_move", 716, 0], [16000, "mouse_move", -716, 0], [33000, "mouse_move", 716, 0],
+        [49000, "mouse_move", -716, 0]])"},
+};
+
+// Press the trigger, run the macro, release the trigger and poll once more
+// (the freeze macro acts on release)
+static void runOnce(SimBackend& sim, const CatalogueEntry& entry) {
+    sim.reset();
+    sim.pressTrigger(Binds[entry.bind]);
+    entry.run();
+    sim.releaseTrigger(Binds[entry.bind]);
+    entry.run();
+}
+
+static std::string timelineJson(const std::vector<SimBackend::Event>& events) {
+    std::string json = "[";
+    char buffer[96];
+    for (size_t i = 0; i < events.size(); ++i) {
+        snprintf(buffer, sizeof(buffer), "%s[%lld, \"%s\", %d, %d]", i ? ", " : "",
+                 static_cast<long long>(events[i].time_us), SimBackend::typeName(events[i].type),
+                 events[i].code, events[i].value);
+        json += buffer;
+    }
+    return json + "]";
+}
+
+static const int64_t REAL_CLOCK_LATE_US = 25000;
+
+// Compare a run with the entry's expected timeline; events may be up to
+// `late_us` late
+static bool matchesExpected(const CatalogueEntry& entry, const std::vector<SimBackend::Event>& events,
+                            int64_t late_us) {
+    nlohmann::json expected = nlohmann::json::parse(entry.expected);
+    if (expected.size() != events.size()) {
+        bench::note("%s: %zu events, expected %zu", entry.name, events.size(), expected.size());
+        return false;
+    }
+    for (size_t i = 0; i < events.size(); ++i) {
+        const SimBackend::Event& event = events[i];
+        const nlohmann::json& want = expected[i];
+        if (want[1].get<std::string>() != SimBackend::typeName(event.type) ||
+            want[2].get<int>() != event.code || want[3].get<int>() != event.value) {
+            bench::note("%s: event %zu is %s %d %d, expected %s %d %d", entry.name, i,
+                        SimBackend::typeName(event.type), event.code, event.value,
+                        want[1].get<std::string>().c_str(), want[2].get<int>(), want[3].get<int>());
+            return false;
+        }
+        int64_t late = event.time_us - want[0].get<int64_t>();
+        if (late < 0 || late > late_us) {
+            bench::note("%s: event %zu (%s) at %lld us, expected %lld us", entry.name, i,
+                        SimBackend::typeName(event.type), static_cast<long long>(event.time_us),
+                        static_cast<long long>(want[0].get<int64_t>()));
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool sameTimeline(const std::vector<SimBackend::Event>& a, const std::vector<SimBackend::Event>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].time_us != b[i].time_us || a[i].type != b[i].type ||
+            a[i].code != b[i].code || a[i].value != b[i].value) return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bench::Report report("macros");
+    asynclog::set_min_level(asynclog::Level::Warn);
+
+    metrics::Histogram& step_error = metrics::get("Macro step error");
+    rebuildMacroProfiles();
+
+    // Virtual clock: timelines, determinism and per-step overhead
+    SimBackend sim(true);
+    macro_backend = &sim;
+    bool deterministic = true;
+    int mismatches = 0;
+    for (const CatalogueEntry& entry : CATALOGUE) {
+        uint64_t steps_before = step_error.count();
+        uint64_t start = metrics::now_ns();
+        runOnce(sim, entry);
+        uint64_t wall_ns = metrics::now_ns() - start;
+        uint64_t steps = step_error.count() - steps_before;
+        int64_t virtual_us = sim.elapsedUs();
+        std::vector<SimBackend::Event> first = sim.events();
+        if (!matchesExpected(entry, first, 0)) mismatches++;
+
+        runOnce(sim, entry);
+        if (!sameTimeline(first, sim.events())) deterministic = false;
+
+        char summary[256];
+        snprintf(summary, sizeof(summary),
+                 "{\"virtual_us\": %lld, \"wall_us\": %.1f, \"steps\": %llu, \"wall_ns_per_step\": %.1f, \"timeline\": ",
+                 static_cast<long long>(virtual_us), wall_ns / 1000.0, static_cast<unsigned long long>(steps),
+                 steps ? static_cast<double>(wall_ns) / steps : 0.0);
+        report.raw(entry.name, summary + timelineJson(first) + "}");
+    }
+    report.value("deterministic", deterministic ? 1 : 0, "bool");
+    if (!deterministic) mismatches++;
+
+    // Real clock: how late the steps wake up on this machine
+    bench::note("running the catalogue on the real clock");
+    SimBackend wall(false);
+    macro_backend = &wall;
+    step_error.reset();
+    uint64_t start = metrics::now_ns();
+    for (const CatalogueEntry& entry : CATALOGUE) {
+        runOnce(wall, entry);
+        if (!matchesExpected(entry, wall.events(), REAL_CLOCK_LATE_US)) mismatches++;
+    }
+    report.value("real_clock_total", (metrics::now_ns() - start) / 1e6, "ms");
+    report.latency("real_clock_step_error", step_error);
+
+    // Binds of every macro, once by name (as the macros did) and once from the table
+    const int LOOKUP_ROUNDS = 100000;
+    unsigned int sink = 0;
+    start = metrics::now_ns();
+    for (int i = 0; i < LOOKUP_ROUNDS; ++i) {
+        for (const char* name : bind_names) sink += static_cast<unsigned int>(Binds[name]);
+    }
+    report.value("bind_lookup_by_name", (metrics::now_ns() - start) / static_cast<double>(LOOKUP_ROUNDS), "ns/tick");
+    start = metrics::now_ns();
+    for (int i = 0; i < LOOKUP_ROUNDS; ++i) {
+        for (int bind = 0; bind < BIND_COUNT; ++bind) sink += static_cast<unsigned int>(macroProfile().binds[bind]);
+    }
+    report.value("bind_lookup_table", (metrics::now_ns() - start) / static_cast<double>(LOOKUP_ROUNDS), "ns/tick");
+    bench::note("lookup checksum %u", sink);
+
+    // Switching between a place profile and the global table
+    game_profiles["places"]["1818"] = {{"name", "bench"}, {"binds", {{"HHJ", 0x70}}}, {"hhj_delay1", 12}};
+    rebuildMacroProfiles();
+    metrics::Histogram profile_switch;
+    for (int i = 0; i < LOOKUP_ROUNDS; ++i) {
+        uint64_t switch_start = metrics::now_ns();
+        selectMacroProfile(i % 2 ? 1818 : 0, 0);
+        profile_switch.record(metrics::now_ns() - switch_start);
+    }
+    report.latency("profile_switch", profile_switch);
+
+    macro_backend = &real_backend;
+    report.value("timeline_mismatches", mismatches, "count");
+    int status = report.write(argc, argv);
+    if (mismatches > 0) {
+        bench::note("%d timeline mismatches", mismatches);
+        return 1;
+    }
+    return status;
+}
@@ -0,0 +1,117 @@
+// privhelper benchmark: a forked child plays the helper over a socketpair
+// and the channel is measured as the UI sees it:
+// - command round trip (submit + wait_result) with the helper asleep on its
+//   doorbell, and with back-to-back commands while it is still draining
+// - one-way device event latency, helper to client
+// - fire-and-forget submit cost (what a key injection costs the macro thread)
+//
+// Runs as any user; nothing privileged is touched.
+
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <thread>
+#include "privhelper.hpp"
+#include "bench.hpp"
+
+static const int ROUNDS = 20000;
+static const int EVENT_ROUNDS = 5000;
+
+// Helper side: answers every command with 0; OP_EMIT_INPUT also posts one
+// device event stamped when it was posted
+static void helperChild(int sock) {
+    privhelper::Channel channel;
+    if (!channel.create() || !channel.send(sock)) _exit(1);
+    privhelper::Command command;
+    while (channel.wait_command(command, 1000)) {
+        if (command.op == privhelper::OP_SHUTDOWN) break;
+        if (command.op == privhelper::OP_EMIT_INPUT) {
+            privhelper::DeviceEvent event = {};
+            event.time_ns = metrics::now_ns();
+            channel.post_event(event);
+        }
+        channel.complete(command.seq, 0);
+    }
+    _exit(0);
+}
+
+int main(int argc, char** argv) {
+    bench::Report report("privhelper");
+
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) != 0) return 1;
+    pid_t child = fork();
+    if (child == 0) {
+        close(sockets[0]);
+        helperChild(sockets[1]);
+    }
+    close(sockets[1]);
+
+    privhelper::Channel channel;
+    if (!channel.receive(sockets[0])) {
+        bench::note("could not receive the channel");
+        return 1;
+    }
+
+    // Round trips, helper asleep between them (doorbell path)
+    metrics::Histogram idle_round_trip;
+    for (int i = 0; i < ROUNDS / 10; ++i) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        privhelper::Command command = {};
+        command.op = privhelper::OP_NOP;
+        uint64_t start = metrics::now_ns();
+        uint32_t seq = channel.submit(command);
+        int32_t result;
+        channel.wait_result(seq, 1000, result);
+        idle_round_trip.record(metrics::now_ns() - start);
+    }
+    report.latency("round_trip_idle_helper", idle_round_trip);
+
+    // Back to back: the helper is often still awake, no doorbell
+    metrics::Histogram busy_round_trip;
+    for (int i = 0; i < ROUNDS; ++i) {
+        privhelper::Command command = {};
+        command.op = privhelper::OP_NOP;
+        uint64_t start = metrics::now_ns();
+        uint32_t seq = channel.submit(command);
+        int32_t result;
+        channel.wait_result(seq, 1000, result);
+        busy_round_trip.record(metrics::now_ns() - start);
+    }
+    report.latency("round_trip_back_to_back", busy_round_trip);
+
+    // Fire and forget, as a key injection is sent
+    metrics::Histogram submit_cost;
+    uint32_t last_seq = 0;
+    for (int i = 0; i < ROUNDS; ++i) {
+        privhelper::Command command = {};
+        command.op = privhelper::OP_NOP;
+        uint64_t start = metrics::now_ns();
+        last_seq = channel.submit(command);
+        submit_cost.record(metrics::now_ns() - start);
+        if (i % 128 == 127) {
+            int32_t result;
+            channel.wait_result(last_seq, 1000, result);   // stay within the ring
+        }
+    }
+    report.latency("submit_fire_and_forget", submit_cost);
+
+    // Device event back to the client (client asleep on its doorbell)
+    metrics::Histogram event_latency;
+    for (int i = 0; i < EVENT_ROUNDS; ++i) {
+        privhelper::Command command = {};
+        command.op = privhelper::OP_EMIT_INPUT;
+        channel.submit(command);
+        privhelper::DeviceEvent event;
+        if (channel.wait_event(event, 1000)) event_latency.record(metrics::now_ns() - event.time_ns);
+    }
+    report.latency("device_event_one_way", event_latency);
+    report.value("dropped_events", channel.shared()->dropped_events.load(), "events");
+
+    privhelper::Command command = {};
+    command.op = privhelper::OP_SHUTDOWN;
+    channel.submit(command);
+    waitpid(child, nullptr, 0);
+    return report.write(argc, argv);
+}
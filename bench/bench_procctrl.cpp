@@ -0,0 +1,380 @@
+// procctrl benchmark: suspend/resume latency against a spawned dummy child,
+// both through signals and through a dummy cgroup, and the cost of
+// find_all_processes_by_name() and ProcessSnapshot with a large number of
+// extra processes.
+//
+// The signal and scan parts run as any user. The cgroup part needs write
+// access to /sys/fs/cgroup (root) and is reported as skipped otherwise.
+
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "procctrl.hpp"
+#include "Monitor.hpp"
+#include "bench.hpp"
+
+static const int SUSPEND_ROUNDS = 500;
+static const int SCAN_PROCESSES = 1000;
+static const int SCAN_ROUNDS = 50;
+static const int INSTANCES = 4;
+
+// The cgroup name starts with "app-" so procctrl takes its cgroup.freeze path
+static const char* BENCH_CGROUP = "/sys/fs/cgroup/app-hypersuite-bench";
+
+static pid_t spawnDummy(const char* name) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        prctl(PR_SET_NAME, name);
+        while (true) pause();
+    }
+    return pid;
+}
+
+static void killDummy(pid_t pid) {
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+}
+
+static bool writeFile(const std::string& path, const std::string& value) {
+    std::ofstream file(path);
+    if (!file) return false;
+    file << value;
+    file.flush();
+    return !file.fail();
+}
+
+// "frozen 0/1" line of cgroup.events
+static bool cgroupFrozen(const std::string& cgroup) {
+    std::ifstream events(cgroup + "/cgroup.events");
+    std::string key;
+    int value = 0;
+    while (events >> key >> value) {
+        if (key == "frozen") return value == 1;
+    }
+    return false;
+}
+
+// Spin until cgroup.events reports the wanted state; false after one second.
+// Kept as a reference for procctrl::wait_cgroup_frozen(), which sleeps in epoll.
+static bool waitFrozen(const std::string& cgroup, bool frozen) {
+    uint64_t deadline = metrics::now_ns() + 1000000000ULL;
+    while (cgroupFrozen(cgroup) != frozen) {
+        if (metrics::now_ns() > deadline) return false;
+    }
+    return true;
+}
+
+static void benchSignals(bench::Report& report) {
+    pid_t child = spawnDummy("hs-bench-dummy");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    metrics::Histogram suspend_call, resume_call;
+    metrics::Histogram until_stopped, until_continued;
+    metrics::Histogram by_name;
+    metrics::Histogram confirmed;
+
+    for (int i = 0; i < SUSPEND_ROUNDS; ++i) {
+        uint64_t start = metrics::now_ns();
+        procctrl::set_process_suspended(child, true);
+        suspend_call.record(metrics::now_ns() - start);
+        // The parent is notified once the child has actually stopped
+        int status;
+        waitpid(child, &status, WUNTRACED);
+        until_stopped.record(metrics::now_ns() - start);
+
+        start = metrics::now_ns();
+        procctrl::set_process_suspended(child, false);
+        resume_call.record(metrics::now_ns() - start);
+        waitpid(child, &status, WCONTINUED);
+        until_continued.record(metrics::now_ns() - start);
+    }
+
+    for (int i = 0; i < SUSPEND_ROUNDS / 10; ++i) {
+        uint64_t start = metrics::now_ns();
+        procctrl::suspend_processes_by_name("hs-bench-dummy");
+        by_name.record(metrics::now_ns() - start);
+        int status;
+        waitpid(child, &status, WUNTRACED);
+        procctrl::resume_processes_by_name("hs-bench-dummy");
+        waitpid(child, &status, WCONTINUED);
+    }
+
+    // Same round trip, confirmed through /proc instead of waitpid
+    for (int i = 0; i < SUSPEND_ROUNDS / 10; ++i) {
+        uint64_t start = metrics::now_ns();
+        procctrl::set_process_suspended(child, true);
+        if (procctrl::wait_for_suspend_state(child, true, 1000)) confirmed.record(metrics::now_ns() - start);
+        procctrl::set_process_suspended(child, false);
+        procctrl::wait_for_suspend_state(child, false, 1000);
+    }
+
+    killDummy(child);
+
+    report.latency("signal_suspend_call", suspend_call);
+    report.latency("signal_suspend_until_stopped", until_stopped);
+    report.latency("signal_resume_call", resume_call);
+    report.latency("signal_resume_until_continued", until_continued);
+    report.latency("suspend_processes_by_name", by_name);
+    report.latency("signal_suspend_confirmed", confirmed);
+}
+
+static void benchCgroup(bench::Report& report) {
+    if (!procctrl::is_cgroup_v2_available()) {
+        report.skipped("cgroup", "cgroup v2 is not mounted");
+        return;
+    }
+    if (mkdir(BENCH_CGROUP, 0755) != 0 && errno != EEXIST) {
+        report.skipped("cgroup", std::string("cannot create ") + BENCH_CGROUP + ": " + strerror(errno));
+        return;
+    }
+
+    pid_t child = spawnDummy("hs-bench-cgroup");
+    if (!writeFile(std::string(BENCH_CGROUP) + "/cgroup.procs", std::to_string(child))) {
+        report.skipped("cgroup", "cannot move the dummy child into the bench cgroup");
+        killDummy(child);
+        rmdir(BENCH_CGROUP);
+        return;
+    }
+
+    metrics::Histogram freeze_call, until_frozen, thaw_call, until_frozen_epoll;
+    int timeouts = 0;
+    for (int i = 0; i < SUSPEND_ROUNDS; ++i) {
+        uint64_t start = metrics::now_ns();
+        procctrl::set_process_suspended(child, true);
+        freeze_call.record(metrics::now_ns() - start);
+        if (waitFrozen(BENCH_CGROUP, true)) {
+            until_frozen.record(metrics::now_ns() - start);
+        } else {
+            timeouts++;
+        }
+
+        start = metrics::now_ns();
+        procctrl::set_process_suspended(child, false);
+        thaw_call.record(metrics::now_ns() - start);
+        if (!waitFrozen(BENCH_CGROUP, false)) timeouts++;
+        if (timeouts > 3) break;
+    }
+
+    for (int i = 0; i < SUSPEND_ROUNDS / 10 && timeouts <= 3; ++i) {
+        uint64_t start = metrics::now_ns();
+        procctrl::set_process_suspended(child, true);
+        if (procctrl::wait_for_suspend_state(child, true, 1000)) {
+            until_frozen_epoll.record(metrics::now_ns() - start);
+        } else {
+            timeouts++;
+        }
+        procctrl::set_process_suspended(child, false);
+        if (!procctrl::wait_for_suspend_state(child, false, 1000)) timeouts++;
+    }
+
+    writeFile(std::string(BENCH_CGROUP) + "/cgroup.freeze", "0");
+    killDummy(child);
+    rmdir(BENCH_CGROUP);
+
+    report.latency("cgroup_freeze_call", freeze_call);
+    report.latency("cgroup_freeze_until_frozen", until_frozen);
+    report.latency("cgroup_freeze_until_frozen_epoll", until_frozen_epoll);
+    report.latency("cgroup_thaw_call", thaw_call);
+    report.value("cgroup_timeouts", timeouts, "rounds");
+}
+
+// Several client instances: one after another vs set_processes_suspended()
+static void benchInstances(bench::Report& report) {
+    std::vector<pid_t> instances;
+    for (int i = 0; i < INSTANCES; ++i) instances.push_back(spawnDummy("hs-bench-inst"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    metrics::Histogram serial, parallel;
+    for (int i = 0; i < SUSPEND_ROUNDS / 10; ++i) {
+        uint64_t start = metrics::now_ns();
+        for (pid_t pid : instances) procctrl::set_process_suspended(pid, true);
+        for (pid_t pid : instances) procctrl::wait_for_suspend_state(pid, true, 1000);
+        serial.record(metrics::now_ns() - start);
+        for (pid_t pid : instances) procctrl::set_process_suspended(pid, false);
+        for (pid_t pid : instances) procctrl::wait_for_suspend_state(pid, false, 1000);
+
+        start = metrics::now_ns();
+        procctrl::set_processes_suspended(instances, true);
+        for (pid_t pid : instances) procctrl::wait_for_suspend_state(pid, true, 1000);
+        parallel.record(metrics::now_ns() - start);
+        procctrl::set_processes_suspended(instances, false);
+        for (pid_t pid : instances) procctrl::wait_for_suspend_state(pid, false, 1000);
+    }
+
+    for (pid_t pid : instances) killDummy(pid);
+
+    report.latency("instances_suspend_serial", serial);
+    report.latency("instances_suspend_parallel", parallel);
+}
+
+// utime + stime of a process, in seconds
+static double cpuSeconds(pid_t pid) {
+    std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+    std::string line;
+    std::getline(stat, line);
+    size_t end = line.rfind(')');
+    if (end == std::string::npos) return 0.0;
+    std::istringstream fields(line.substr(end + 2));
+    std::string field;
+    unsigned long long utime = 0, stime = 0;
+    for (int i = 3; fields >> field; ++i) {
+        if (i == 14) utime = std::stoull(field);
+        if (i == 15) {
+            stime = std::stoull(field);
+            break;
+        }
+    }
+    return static_cast<double>(utime + stime) / sysconf(_SC_CLK_TCK);
+}
+
+// CPU share a busy background client keeps under the governor's duty cycle
+// (frozen DUTY_PERIOD_MS - DUTY_RUN_MS, thawed DUTY_RUN_MS)
+static void benchDutyCycle(bench::Report& report) {
+    const int DUTY_RUN_MS = 20;
+    const int DUTY_PERIOD_MS = 250;
+    const int DURATION_MS = 2000;
+
+    pid_t busy = fork();
+    if (busy == 0) {
+        prctl(PR_SET_NAME, "hs-bench-busy");
+        volatile unsigned long spin = 0;
+        while (true) spin = spin + 1;
+    }
+    std::vector<pid_t> targets = {busy};
+
+    double start_cpu = cpuSeconds(busy);
+    std::this_thread::sleep_for(std::chrono::milliseconds(DURATION_MS));
+    double free_share = (cpuSeconds(busy) - start_cpu) * 1000.0 / DURATION_MS;
+
+    metrics::Histogram cycle;
+    start_cpu = cpuSeconds(busy);
+    uint64_t start = metrics::now_ns();
+    while (metrics::now_ns() - start < DURATION_MS * 1000000ULL) {
+        uint64_t cycle_start = metrics::now_ns();
+        procctrl::set_processes_suspended(targets, true);
+        std::this_thread::sleep_for(std::chrono::milliseconds(DUTY_PERIOD_MS - DUTY_RUN_MS));
+        procctrl::set_processes_suspended(targets, false);
+        std::this_thread::sleep_for(std::chrono::milliseconds(DUTY_RUN_MS));
+        cycle.record(metrics::now_ns() - cycle_start);
+    }
+    double elapsed_ms = (metrics::now_ns() - start) / 1e6;
+    double duty_share = (cpuSeconds(busy) - start_cpu) * 1000.0 / elapsed_ms;
+
+    killDummy(busy);
+
+    report.value("duty_cycle_cpu_share_free", free_share * 100.0, "% of one CPU");
+    report.value("duty_cycle_cpu_share", duty_share * 100.0, "% of one CPU");
+    report.value("duty_cycle_cpu_share_target", 100.0 * DUTY_RUN_MS / DUTY_PERIOD_MS, "% of one CPU");
+    report.latency("duty_cycle_period", cycle);
+}
+
+// Cost of one Monitor tab sample of a small process tree (kept-open fds + pread)
+static void benchMonitor(bench::Report& report) {
+    pid_t root = fork();
+    if (root == 0) {
+        setpgid(0, 0);
+        prctl(PR_SET_NAME, "hs-bench-root");
+        for (int i = 0; i < 3; ++i) {
+            if (fork() == 0) break;
+        }
+        while (true) pause();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    TreeSampler sampler;
+    sampler.reset(root);
+    TreeSampler::Sample first;
+    sampler.sample(first);  // opens the files
+
+    metrics::Histogram sample;
+    long threads = 0;
+    for (int i = 0; i < SUSPEND_ROUNDS; ++i) {
+        TreeSampler::Sample current;
+        uint64_t start = metrics::now_ns();
+        sampler.sample(current);
+        sample.record(metrics::now_ns() - start);
+        threads = current.threads;
+    }
+
+    kill(-root, SIGKILL);
+    killDummy(root);
+
+    report.value("monitor_tree_threads", static_cast<double>(threads), "threads");
+    report.latency("monitor_sample", sample);
+}
+
+static void benchScan(bench::Report& report) {
+    std::vector<pid_t> dummies;
+    dummies.reserve(SCAN_PROCESSES);
+    for (int i = 0; i < SCAN_PROCESSES; ++i) {
+        pid_t pid = spawnDummy("hs-bench-scan");
+        if (pid < 0) break;
+        dummies.push_back(pid);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    size_t proc_entries = 0;
+    if (DIR* dir = opendir("/proc")) {
+        while (struct dirent* ent = readdir(dir)) {
+            if (ent->d_name[0] >= '0' && ent->d_name[0] <= '9') proc_entries++;
+        }
+        closedir(dir);
+    }
+
+    metrics::Histogram scan, snapshot_take, snapshot_cgroups, snapshot_queries;
+    size_t found = 0;
+    for (int i = 0; i < SCAN_ROUNDS; ++i) {
+        uint64_t start = metrics::now_ns();
+        found = procctrl::find_all_processes_by_name("hs-bench-scan").size();
+        scan.record(metrics::now_ns() - start);
+
+        start = metrics::now_ns();
+        procctrl::ProcessSnapshot snapshot = procctrl::ProcessSnapshot::take();
+        snapshot_take.record(metrics::now_ns() - start);
+
+        // Name lookup plus a full tree walk, answered from the snapshot alone
+        start = metrics::now_ns();
+        snapshot.find_by_name("hs-bench-scan");
+        snapshot.tree(getpid());
+        snapshot_queries.record(metrics::now_ns() - start);
+
+        start = metrics::now_ns();
+        procctrl::ProcessSnapshot::take(procctrl::ProcessSnapshot::Parents | procctrl::ProcessSnapshot::Cgroups);
+        snapshot_cgroups.record(metrics::now_ns() - start);
+    }
+
+    for (pid_t pid : dummies) killDummy(pid);
+
+    report.value("scan_process_count", static_cast<double>(proc_entries), "processes");
+    report.value("scan_matches", static_cast<double>(found), "processes");
+    report.latency("find_all_processes_by_name", scan);
+    report.latency("snapshot_take", snapshot_take);
+    report.latency("snapshot_take_with_cgroups", snapshot_cgroups);
+    report.latency("snapshot_name_and_tree_query", snapshot_queries);
+}
+
+int main(int argc, char** argv) {
+    bench::Report report("procctrl");
+
+    bench::note("signal suspend/resume, %d rounds", SUSPEND_ROUNDS);
+    benchSignals(report);
+    bench::note("cgroup freeze/thaw, %d rounds", SUSPEND_ROUNDS);
+    benchCgroup(report);
+    bench::note("%d instances, serial and concurrent", INSTANCES);
+    benchInstances(report);
+    bench::note("governor duty cycle on a busy child");
+    benchDutyCycle(report);
+    bench::note("monitor sample of a 4 process tree, %d rounds", SUSPEND_ROUNDS);
+    benchMonitor(report);
+    bench::note("process scan with %d extra processes", SCAN_PROCESSES);
+    benchScan(report);
+
+    return report.write(argc, argv);
+}
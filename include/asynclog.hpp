@@ -0,0 +1,309 @@
+/*
+===============================================================================
+asynclog - Lock-free asynchronous logger (Header-Only)
+===============================================================================
+
+Logging from timing-critical code must not block on a terminal or a file.
+asynclog formats the message into a slot of a fixed-size ring buffer and
+returns; a background thread drains the ring to the configured sinks.
+
+Features:
+- Multi-producer, lock-free bounded ring (no allocation on the hot path)
+- Levels (debug/info/warn/error) filtered before any formatting happens
+- Sinks: stdout/stderr, a size-rotated log file, and an in-memory history
+  that a UI can show as a log panel
+- Messages that do not fit in the ring are dropped and counted, never waited on
+- Falls back to a direct write when the drain thread is not running
+
+Usage example:
+(C++)
+
+----------------------------------------------------------------------
+#include "asynclog.hpp"
+
+int main() {
+    asynclog::set_file("app.log", 1 << 20, 3);
+    asynclog::start();
+
+    asynclog::write(asynclog::Level::Info, "[app] started with %d workers", 4);
+
+    asynclog::stop(); // flushes everything still queued
+}
+----------------------------------------------------------------------
+
+===============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace asynclog {
+
+enum class Level : unsigned char { Debug = 0, Info = 1, Warn = 2, Error = 3 };
+
+inline const char* level_name(Level level) {
+    switch (level) {
+        case Level::Debug: return "debug";
+        case Level::Info:  return "info";
+        case Level::Warn:  return "warn";
+        default:           return "error";
+    }
+}
+
+/// A drained log line, as kept in the in-memory history
+struct Entry {
+    uint64_t timestamp_ns;
+    Level level;
+    std::string text;
+};
+
+constexpr size_t RING_SLOTS = 1024;          // must be a power of two
+constexpr size_t MESSAGE_SIZE = 240;
+constexpr size_t HISTORY_LINES = 500;
+
+namespace detail {
+
+struct Slot {
+    std::atomic<size_t> sequence;
+    uint64_t timestamp_ns;
+    Level level;
+    char text[MESSAGE_SIZE];
+};
+
+struct State {
+    Slot slots[RING_SLOTS];
+    alignas(64) std::atomic<size_t> enqueue_pos{0};
+    alignas(64) size_t dequeue_pos = 0;
+
+    std::atomic<int> min_level{static_cast<int>(Level::Info)};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> running{false};
+    std::thread drain_thread;
+
+    // Sinks (only touched by the drain thread once it runs)
+    bool stdout_enabled = true;
+    std::string file_path;
+    size_t file_max_bytes = 1 << 20;
+    int file_keep = 3;
+    FILE* file = nullptr;
+    size_t file_bytes = 0;
+
+    std::mutex history_mutex;
+    std::deque<Entry> history;
+    std::atomic<uint64_t> history_version{0};
+
+    State() {
+        for (size_t i = 0; i < RING_SLOTS; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+};
+
+inline State& state() {
+    static State s;
+    return s;
+}
+
+inline uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline void rotate_file(State& s) {
+    if (s.file) {
+        fclose(s.file);
+        s.file = nullptr;
+    }
+    for (int i = s.file_keep - 1; i >= 1; --i) {
+        std::string from = s.file_path + "." + std::to_string(i);
+        std::string to = s.file_path + "." + std::to_string(i + 1);
+        std::rename(from.c_str(), to.c_str());
+    }
+    if (s.file_keep > 0) {
+        std::rename(s.file_path.c_str(), (s.file_path + ".1").c_str());
+    }
+    s.file = fopen(s.file_path.c_str(), "w");
+    s.file_bytes = 0;
+}
+
+inline void emit(State& s, uint64_t timestamp_ns, Level level, const char* text, size_t length) {
+    if (s.stdout_enabled) {
+        FILE* out = level >= Level::Warn ? stderr : stdout;
+        fwrite(text, 1, length, out);
+        fputc('\n', out);
+    }
+
+    if (!s.file_path.empty()) {
+        if (!s.file) {
+            s.file = fopen(s.file_path.c_str(), "a");
+            s.file_bytes = 0;
+        }
+        if (s.file) {
+            int written = fprintf(s.file, "%llu.%06llu [%s] %.*s\n",
+                                  static_cast<unsigned long long>(timestamp_ns / 1000000000ULL),
+                                  static_cast<unsigned long long>((timestamp_ns / 1000ULL) % 1000000ULL),
+                                  level_name(level), static_cast<int>(length), text);
+            if (written > 0) s.file_bytes += static_cast<size_t>(written);
+            if (s.file_bytes >= s.file_max_bytes) rotate_file(s);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(s.history_mutex);
+    s.history.push_back({timestamp_ns, level, std::string(text, length)});
+    if (s.history.size() > HISTORY_LINES) s.history.pop_front();
+    s.history_version.fetch_add(1, std::memory_order_release);
+}
+
+/// Drain everything currently queued (single consumer)
+/// @return number of messages drained
+inline size_t drain(State& s) {
+    size_t count = 0;
+    while (true) {
+        Slot& slot = s.slots[s.dequeue_pos & (RING_SLOTS - 1)];
+        size_t seq = slot.sequence.load(std::memory_order_acquire);
+        if (seq != s.dequeue_pos + 1) break;
+
+        emit(s, slot.timestamp_ns, slot.level, slot.text, strnlen(slot.text, MESSAGE_SIZE));
+
+        slot.sequence.store(s.dequeue_pos + RING_SLOTS, std::memory_order_release);
+        ++s.dequeue_pos;
+        ++count;
+    }
+    if (count > 0) {
+        fflush(stdout);
+        if (s.file) fflush(s.file);
+    }
+    return count;
+}
+
+inline void drain_loop() {
+    State& s = state();
+    while (s.running.load(std::memory_order_acquire)) {
+        if (drain(s) == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+    drain(s);
+}
+
+} // namespace detail
+
+/// Minimum level that is formatted and queued
+inline void set_min_level(Level level) {
+    detail::state().min_level.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+inline Level min_level() {
+    return static_cast<Level>(detail::state().min_level.load(std::memory_order_relaxed));
+}
+
+/// Enable or disable the stdout/stderr sink (call before start())
+inline void set_stdout(bool enabled) {
+    detail::state().stdout_enabled = enabled;
+}
+
+/// Log to a file, rotated to path.1 .. path.<keep> once it reaches max_bytes (call before start())
+inline void set_file(const std::string& path, size_t max_bytes, int keep) {
+    detail::State& s = detail::state();
+    s.file_path = path;
+    s.file_max_bytes = max_bytes;
+    s.file_keep = keep;
+}
+
+/// Start the background drain thread
+inline void start() {
+    detail::State& s = detail::state();
+    if (s.running.exchange(true)) return;
+    s.drain_thread = std::thread(detail::drain_loop);
+}
+
+/// Stop the drain thread after flushing every queued message
+inline void stop() {
+    detail::State& s = detail::state();
+    if (!s.running.exchange(false)) return;
+    if (s.drain_thread.joinable()) s.drain_thread.join();
+    if (s.file) {
+        fclose(s.file);
+        s.file = nullptr;
+    }
+}
+
+/// Number of messages dropped because the ring was full
+inline uint64_t dropped() {
+    return detail::state().dropped.load(std::memory_order_relaxed);
+}
+
+/// Copy the in-memory history (for a log panel)
+inline void copy_history(std::vector<Entry>& out) {
+    detail::State& s = detail::state();
+    std::lock_guard<std::mutex> lock(s.history_mutex);
+    out.assign(s.history.begin(), s.history.end());
+}
+
+inline void clear_history() {
+    detail::State& s = detail::state();
+    std::lock_guard<std::mutex> lock(s.history_mutex);
+    s.history.clear();
+    s.history_version.fetch_add(1, std::memory_order_release);
+}
+
+/// Changes whenever the history does, so a panel only copies when needed
+inline uint64_t history_version() {
+    return detail::state().history_version.load(std::memory_order_acquire);
+}
+
+/// Format and queue a message; never blocks
+inline void vwrite(Level level, const char* fmt, va_list args) {
+    detail::State& s = detail::state();
+    if (static_cast<int>(level) < s.min_level.load(std::memory_order_relaxed)) return;
+
+    if (!s.running.load(std::memory_order_acquire)) {
+        // No drain thread: behave like a plain synchronous logger
+        FILE* out = level >= Level::Warn ? stderr : stdout;
+        vfprintf(out, fmt, args);
+        fputc('\n', out);
+        return;
+    }
+
+    size_t pos = s.enqueue_pos.load(std::memory_order_relaxed);
+    detail::Slot* slot;
+    while (true) {
+        slot = &s.slots[pos & (RING_SLOTS - 1)];
+        size_t seq = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (s.enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            s.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = s.enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->timestamp_ns = detail::now_ns();
+    slot->level = level;
+    vsnprintf(slot->text, MESSAGE_SIZE, fmt, args);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+}
+
+#if defined(__GNUC__)
+__attribute__((format(printf, 2, 3)))
+#endif
+inline void write(Level level, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vwrite(level, fmt, args);
+    va_end(args);
+}
+
+} // namespace asynclog
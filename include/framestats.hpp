@@ -0,0 +1,205 @@
+/*
+===============================================================================
+framestats - Per-frame CPU time and heap allocations by subsystem (Header-Only)
+===============================================================================
+
+Accounts what each frame of a main loop costs, split by subsystem: the
+thread CPU time spent inside FRAME_SCOPE(subsystem) blocks, and the number
+and size of heap allocations made while they run. Time between scopes on
+the same thread counts as OTHER; nested scopes don't count twice.
+
+Allocations are only counted when HYPERSUITE_ALLOC_STATS is defined
+(`make alloc-stats`): that build replaces the global operator new (see
+src/AllocHook.cpp) with one calling count_allocation(). Allocations of
+threads without a scope count as OTHER. CPU time is measured in every build;
+it costs two thread-CPU clock reads per scope.
+
+Features:
+- FRAME_SCOPE(subsystem) around each part of the loop
+- end_frame() once per frame, keeps the last HISTORY frames
+- summary(): average and worst frame per subsystem
+
+Usage example:
+(C++)
+
+----------------------------------------------------------------------
+#include "framestats.hpp"
+
+while (running) {
+    { FRAME_SCOPE(framestats::MACROS); updateMacros(); }
+    { FRAME_SCOPE(framestats::UI); drawUI(); }
+    framestats::end_frame();
+}
+framestats::Summary s = framestats::summary();
+printf("UI %.1f us, %.1f allocations per frame\n",
+       s.average.cpu_ns[framestats::UI] / 1000.0, s.average.allocations[framestats::UI]);
+----------------------------------------------------------------------
+
+===============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace framestats {
+
+enum Subsystem : unsigned { OTHER = 0, UI, RENDER, MACROS, LOGZZ, SUBSYSTEM_COUNT };
+
+inline const char* subsystem_name(unsigned subsystem) {
+    static const char* names[SUBSYSTEM_COUNT] = {"Other", "UI", "Render", "Macros", "Log watcher"};
+    return subsystem < SUBSYSTEM_COUNT ? names[subsystem] : "?";
+}
+
+/// True in builds that count allocations (HYPERSUITE_ALLOC_STATS)
+inline constexpr bool counts_allocations() {
+#ifdef HYPERSUITE_ALLOC_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+/// Running totals since start. Constant-initialized, so operator new can use
+/// them before any constructor ran.
+struct Totals {
+    std::atomic<uint64_t> allocations[SUBSYSTEM_COUNT] = {};
+    std::atomic<uint64_t> bytes[SUBSYSTEM_COUNT] = {};
+    std::atomic<uint64_t> cpu_ns[SUBSYSTEM_COUNT] = {};
+};
+inline Totals totals;
+
+inline thread_local unsigned current_subsystem = OTHER;
+inline thread_local uint64_t segment_start_ns = 0;   // thread CPU time the running segment started at
+
+/// Called by the replaced operator new
+inline void count_allocation(size_t bytes) {
+    unsigned subsystem = current_subsystem;
+    totals.allocations[subsystem].fetch_add(1, std::memory_order_relaxed);
+    totals.bytes[subsystem].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+/// CPU time consumed by the calling thread
+inline uint64_t thread_cpu_ns() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) return 0;
+    uint64_t k = (static_cast<uint64_t>(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+    uint64_t u = (static_cast<uint64_t>(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+    return (k + u) * 100;
+#else
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+#endif
+}
+
+/// Charge the CPU time since the last switch to the running subsystem and
+/// make `next` the running one
+inline unsigned switch_to(unsigned next) {
+    uint64_t now = thread_cpu_ns();
+    unsigned previous = current_subsystem;
+    if (segment_start_ns != 0 && now > segment_start_ns) {
+        totals.cpu_ns[previous].fetch_add(now - segment_start_ns, std::memory_order_relaxed);
+    }
+    segment_start_ns = now;
+    current_subsystem = next;
+    return previous;
+}
+
+/// RAII subsystem scope
+class Scope {
+public:
+    explicit Scope(Subsystem subsystem) : m_previous(switch_to(subsystem)) {}
+    ~Scope() { switch_to(m_previous); }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    unsigned m_previous;
+};
+
+/// Cost of one frame (or the average/worst of several)
+struct Frame {
+    double allocations[SUBSYSTEM_COUNT] = {};
+    double bytes[SUBSYSTEM_COUNT] = {};
+    double cpu_ns[SUBSYSTEM_COUNT] = {};
+
+    double total_cpu_ns() const {
+        double sum = 0.0;
+        for (double ns : cpu_ns) sum += ns;
+        return sum;
+    }
+};
+
+struct Summary {
+    size_t frames = 0;
+    Frame average;
+    Frame worst;    // per column, not one frame
+};
+
+static constexpr size_t HISTORY = 120;
+
+struct History {
+    Frame frames[HISTORY];
+    size_t count = 0;
+    size_t next = 0;
+    uint64_t last_allocations[SUBSYSTEM_COUNT] = {};
+    uint64_t last_bytes[SUBSYSTEM_COUNT] = {};
+    uint64_t last_cpu_ns[SUBSYSTEM_COUNT] = {};
+};
+inline History history;   // main thread only
+
+/// Close the frame: its cost is the change of the totals since the last call
+inline void end_frame() {
+    switch_to(current_subsystem);
+    Frame& frame = history.frames[history.next];
+    for (unsigned i = 0; i < SUBSYSTEM_COUNT; ++i) {
+        uint64_t allocations = totals.allocations[i].load(std::memory_order_relaxed);
+        uint64_t bytes = totals.bytes[i].load(std::memory_order_relaxed);
+        uint64_t cpu_ns = totals.cpu_ns[i].load(std::memory_order_relaxed);
+        frame.allocations[i] = static_cast<double>(allocations - history.last_allocations[i]);
+        frame.bytes[i] = static_cast<double>(bytes - history.last_bytes[i]);
+        frame.cpu_ns[i] = static_cast<double>(cpu_ns - history.last_cpu_ns[i]);
+        history.last_allocations[i] = allocations;
+        history.last_bytes[i] = bytes;
+        history.last_cpu_ns[i] = cpu_ns;
+    }
+    history.next = (history.next + 1) % HISTORY;
+    if (history.count < HISTORY) history.count++;
+}
+
+/// Average and worst of the recorded frames
+inline Summary summary() {
+    Summary s;
+    s.frames = history.count;
+    if (s.frames == 0) return s;
+    for (size_t f = 0; f < history.count; ++f) {
+        const Frame& frame = history.frames[f];
+        for (unsigned i = 0; i < SUBSYSTEM_COUNT; ++i) {
+            s.average.allocations[i] += frame.allocations[i] / s.frames;
+            s.average.bytes[i] += frame.bytes[i] / s.frames;
+            s.average.cpu_ns[i] += frame.cpu_ns[i] / s.frames;
+            if (frame.allocations[i] > s.worst.allocations[i]) s.worst.allocations[i] = frame.allocations[i];
+            if (frame.bytes[i] > s.worst.bytes[i]) s.worst.bytes[i] = frame.bytes[i];
+            if (frame.cpu_ns[i] > s.worst.cpu_ns[i]) s.worst.cpu_ns[i] = frame.cpu_ns[i];
+        }
+    }
+    return s;
+}
+
+} // namespace framestats
+
+#define FRAME_SCOPE_CONCAT_INNER(a, b) a##b
+#define FRAME_SCOPE_CONCAT(a, b) FRAME_SCOPE_CONCAT_INNER(a, b)
+#define FRAME_SCOPE(subsystem) ::framestats::Scope FRAME_SCOPE_CONCAT(frame_scope_, __LINE__)(subsystem)
@@ -25,9 +25,13 @@ Features:
 - Check if a key is currently pressed.
 - Press, hold, and release keyboard keys.
 - Type text strings with automatic character mapping.
+- Precompile text for a keyboard layout (US, FR, DE, UK) into batched key
+  frames and inject it at a chosen rate.
 - Move the mouse relative to its current position.
 - Map between human-readable keys and system key codes.
 - Thread-safe key state tracking.
+- Linux: output sink and raw event listener, to split device access and
+  macros across a privileged and an unprivileged process.
 - Header-only, cross-platform, no external dependencies (besides standard 
   C++ and system headers).
 - Designed for simplicity and quick integration into macros or automation 
@@ -52,6 +56,11 @@ int main() {
     // Type a string
     input.typeText("Hello World!");
 
+    // Compile once for the AZERTY layout, then inject with 2ms between frames
+    CrossInput::CompiledText seq;
+    if (CrossInput::compileText("/e laugh\n", CrossInput::Layout::FR, seq))
+        input.typeCompiled(seq, 2000);
+
     // Move mouse 100 pixels right and 50 pixels down
     input.moveMouse(100, 50);
 
@@ -82,6 +91,11 @@ Notes:
 #include <atomic>
 #include <cstring>
 #include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include "trace.hpp"
 
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN 
@@ -93,7 +107,7 @@ Notes:
     #include <unistd.h>
     #include <dirent.h>
     #include <sys/ioctl.h>
-    #include <vector>
+    #include <time.h>
 #endif
 
 class CrossInput {
@@ -243,8 +257,82 @@ public:
 #endif
     }
 
+    // Time of the last physical press of a key, in steady_clock nanoseconds
+    // (the kernel event timestamp on Linux). 0 if it was never seen pressed.
+    uint64_t keyPressTimeNs(Key key) {
+        std::lock_guard<std::mutex> lock(m_keyMutex);
+        auto it = m_keyPressNs.find(static_cast<unsigned int>(key));
+        return it == m_keyPressNs.end() ? 0 : it->second;
+    }
+
+#ifndef _WIN32
+    // Split the Linux backend across two processes (a privileged one owning
+    // the devices and an unprivileged one running the macros):
+    //
+    // Output: with a sink set, injected events go to the sink instead of
+    // /dev/uinput (each batch ends with its SYN_REPORT).
+    using OutputSink = std::function<void(const struct input_event* events, size_t count)>;
+    void setOutputSink(OutputSink sink) {
+        std::lock_guard<std::mutex> lock(m_sinkMutex);
+        m_outputSink = std::move(sink);
+    }
+
+    // Input: every event read from a device is also handed to the listener
+    // (on the listener thread), and events forwarded from another process are
+    // fed back in with feedEvent() to update the key states and the recorder.
+    using RawListener = std::function<void(size_t device, const struct input_event& event, bool recordable)>;
+    void setRawListener(RawListener listener) { m_rawListener = std::move(listener); }
+
+    void feedEvent(size_t device, const struct input_event& event, bool recordable) {
+        handleDeviceEvent(device, event, recordable);
+    }
+
+    // Write events to our own uinput device (used by the process owning it)
+    void writeEvents(const struct input_event* events, size_t count) {
+        if (m_uinputFd < 0 || count == 0) return;
+        ssize_t written = write(m_uinputFd, events, sizeof(struct input_event) * count);
+        (void)written;
+    }
+#endif
+
+    // A physical input captured by the recorder
+    struct RecordedEvent {
+        enum class Type : unsigned char { KeyDown, KeyUp, MouseMove };
+        uint64_t offset_us;     // since the first recorded event
+        Type type;
+        Key key;                // KeyDown / KeyUp
+        int dx;                 // MouseMove
+        int dy;
+    };
+
+    // Start capturing the user's keys, mouse buttons and mouse motion.
+    // Linux stamps every event with the kernel's input_event time; Windows
+    // records the keyboard only, stamped in the hook. Events of `ignore`
+    // (the key that toggles recording) and injected events are skipped.
+    void startRecording(Key ignore) {
+        std::lock_guard<std::mutex> lock(m_recordMutex);
+        m_recorded.clear();
+        m_recordIgnore = static_cast<unsigned int>(ignore);
+        m_recordStartNs = 0;
+        m_recording = true;
+    }
+
+    std::vector<RecordedEvent> stopRecording() {
+        std::lock_guard<std::mutex> lock(m_recordMutex);
+        m_recording = false;
+        return std::move(m_recorded);
+    }
+
+    bool isRecording() const { return m_recording; }
+
+    size_t recordedCount() {
+        std::lock_guard<std::mutex> lock(m_recordMutex);
+        return m_recorded.size();
+    }
+
     // Press and hold a key
     void holdKey(Key key) {
+        TRACE_SCOPE("input", "holdKey");
         unsigned int code = static_cast<unsigned int>(key);
 #ifdef _WIN32
         holdKeyWindows(code);
@@ -255,6 +343,7 @@ public:
 
     // Release a key
     void releaseKey(Key key) {
+        TRACE_SCOPE("input", "releaseKey");
         unsigned int code = static_cast<unsigned int>(key);
 #ifdef _WIN32
         releaseKeyWindows(code);
@@ -277,8 +366,108 @@ public:
         }
     }
 
+    // Keyboard layouts understood by the text compiler.
+    // Values match the layout combo in the settings tab.
+    enum class Layout : unsigned short { US = 0, FR = 1, DE = 2, UK = 3 };
+
+    // A single key transition inside a compiled text sequence
+    struct KeyEvent {
+        Key key;
+        bool down;
+    };
+
+    // Key transitions emitted together and closed by a single sync.
+    // At most: previous key up, shift change, altgr change, next key down.
+    struct TextFrame {
+        KeyEvent events[4];
+        unsigned char count = 0;
+
+        void add(Key key, bool down) { events[count++] = {key, down}; }
+    };
+
+    // Text compiled for one layout, ready for typeCompiled()
+    struct CompiledText {
+        std::vector<TextFrame> frames;
+        Layout layout = Layout::US;
+    };
+
+    // Compile text into the minimal frame sequence for a layout.
+    // Modifiers stay held across consecutive characters that need them and the
+    // release of one key shares a frame with the press of the next.
+    // Returns false (and leaves out empty) if a character has no mapping.
+    static bool compileText(const std::string& text, Layout layout, CompiledText& out) {
+        out.frames.clear();
+        out.layout = layout;
+        const KeyStroke* keymap = keymapFor(layout);
+
+        unsigned char heldMods = 0;
+        bool pending = false;
+        Key pendingKey = Key::Space;
+
+        for (char c : text) {
+            unsigned char uc = static_cast<unsigned char>(c);
+            if (uc >= 128 || !keymap[uc].valid) {
+                std::cerr << "Character '" << c << "' not mapped for layout "
+                          << static_cast<unsigned short>(layout) << std::endl;
+                out.frames.clear();
+                return false;
+            }
+            const KeyStroke& stroke = keymap[uc];
+
+            TextFrame frame;
+            if (pending) {
+                if (pendingKey == stroke.key) {
+                    // Same key twice in a row needs its own release frame
+                    TextFrame release;
+                    release.add(pendingKey, false);
+                    out.frames.push_back(release);
+                } else {
+                    frame.add(pendingKey, false);
+                }
+            }
+
+            unsigned char changed = heldMods ^ stroke.mods;
+            if (changed & MOD_SHIFT) frame.add(Key::LShift, (stroke.mods & MOD_SHIFT) != 0);
+            if (changed & MOD_ALTGR) frame.add(Key::RAlt, (stroke.mods & MOD_ALTGR) != 0);
+            heldMods = stroke.mods;
+
+            frame.add(stroke.key, true);
+            out.frames.push_back(frame);
+            pending = true;
+            pendingKey = stroke.key;
+        }
+
+        if (pending) {
+            TextFrame last;
+            last.add(pendingKey, false);
+            if (heldMods & MOD_SHIFT) last.add(Key::LShift, false);
+            if (heldMods & MOD_ALTGR) last.add(Key::RAlt, false);
+            out.frames.push_back(last);
+        }
+        return true;
+    }
+
+    // Inject a compiled sequence, one write per frame, frameDelayUs between frames
+    void typeCompiled(const CompiledText& text, int frameDelayUs) {
+        for (size_t i = 0; i < text.frames.size(); ++i) {
+            emitFrame(text.frames[i]);
+            if (i + 1 < text.frames.size() && frameDelayUs > 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(frameDelayUs));
+            }
+        }
+    }
+
+    // Compile and inject in one go (prefer caching compileText() for repeated text)
+    bool typeTextLayout(const std::string& text, Layout layout, int frameDelayUs) {
+        CompiledText compiled;
+        if (!compileText(text, layout, compiled)) return false;
+        typeCompiled(compiled, frameDelayUs);
+        return true;
+    }
+
     // Move mouse relative to current position
     void moveMouse(int dx, int dy) {
+        TRACE_SCOPE("input", "moveMouse");
 #ifdef _WIN32
         moveMouseWindows(dx, dy);
 #else
@@ -347,8 +536,146 @@ public:
     }
 
 private:
+    enum : unsigned char { MOD_SHIFT = 1, MOD_ALTGR = 2 };
+
+    // Physical key (named after its US position) and modifiers producing a character
+    struct KeyStroke {
+        Key key = Key::Space;
+        unsigned char mods = 0;
+        bool valid = false;
+    };
+
+    // ASCII -> keystroke tables, one per layout
+    static const KeyStroke* keymapFor(Layout layout) {
+        struct Keymaps {
+            KeyStroke us[128], fr[128], de[128], uk[128];
+        };
+        static const Keymaps maps = [] {
+            Keymaps m;
+            auto set = [](KeyStroke* map, char c, Key key, unsigned char mods = 0) {
+                map[static_cast<unsigned char>(c)] = {key, mods, true};
+            };
+
+            // Layout independent keys
+            for (KeyStroke* map : {m.us, m.fr, m.de, m.uk}) {
+                set(map, ' ', Key::Space);
+                set(map, '\n', Key::Enter);
+                set(map, '\t', Key::Tab);
+            }
+
+            // ---- US (QWERTY) ----
+            for (char c = 'a'; c <= 'z'; ++c) {
+                Key key = static_cast<Key>('A' + (c - 'a'));
+                set(m.us, c, key);
+                set(m.us, static_cast<char>(c - 'a' + 'A'), key, MOD_SHIFT);
+            }
+            for (char c = '0'; c <= '9'; ++c) set(m.us, c, static_cast<Key>(c));
+            const char* usShiftedDigits = ")!@#$%^&*(";
+            for (int i = 0; i < 10; ++i) set(m.us, usShiftedDigits[i], static_cast<Key>('0' + i), MOD_SHIFT);
+            set(m.us, '-', Key::Minus);        set(m.us, '_', Key::Minus, MOD_SHIFT);
+            set(m.us, '=', Key::Equal);        set(m.us, '+', Key::Equal, MOD_SHIFT);
+            set(m.us, '[', Key::LeftBracket);  set(m.us, '{', Key::LeftBracket, MOD_SHIFT);
+            set(m.us, ']', Key::RightBracket); set(m.us, '}', Key::RightBracket, MOD_SHIFT);
+            set(m.us, '\\', Key::Backslash);   set(m.us, '|', Key::Backslash, MOD_SHIFT);
+            set(m.us, ';', Key::Semicolon);    set(m.us, ':', Key::Semicolon, MOD_SHIFT);
+            set(m.us, '\'', Key::Quote);       set(m.us, '"', Key::Quote, MOD_SHIFT);
+            set(m.us, ',', Key::Comma);        set(m.us, '<', Key::Comma, MOD_SHIFT);
+            set(m.us, '.', Key::Dot);          set(m.us, '>', Key::Dot, MOD_SHIFT);
+            set(m.us, '/', Key::Slash);        set(m.us, '?', Key::Slash, MOD_SHIFT);
+            set(m.us, '`', Key::Grave);        set(m.us, '~', Key::Grave, MOD_SHIFT);
+
+            // ---- UK (QWERTY, ISO) ----
+            for (int i = 0; i < 128; ++i) m.uk[i] = m.us[i];
+            set(m.uk, '"', Key::Num2, MOD_SHIFT);
+            set(m.uk, '@', Key::Quote, MOD_SHIFT);
+            set(m.uk, '#', Key::Backslash);    // ISO key left of Enter
+            set(m.uk, '~', Key::Backslash, MOD_SHIFT);
+            m.uk[static_cast<unsigned char>('\\')] = KeyStroke();  // lives on the 102nd key
+            m.uk[static_cast<unsigned char>('|')] = KeyStroke();
+
+            // ---- FR (AZERTY) ----
+            for (char c = 'a'; c <= 'z'; ++c) {
+                Key key = static_cast<Key>('A' + (c - 'a'));
+                if (c == 'a') key = Key::Q;
+                else if (c == 'q') key = Key::A;
+                else if (c == 'z') key = Key::W;
+                else if (c == 'w') key = Key::Z;
+                else if (c == 'm') key = Key::Semicolon;
+                set(m.fr, c, key);
+                set(m.fr, static_cast<char>(c - 'a' + 'A'), key, MOD_SHIFT);
+            }
+            for (char c = '0'; c <= '9'; ++c) set(m.fr, c, static_cast<Key>(c), MOD_SHIFT);
+            set(m.fr, '&', Key::Num1);  set(m.fr, '"', Key::Num3);  set(m.fr, '\'', Key::Num4);
+            set(m.fr, '(', Key::Num5);  set(m.fr, '-', Key::Num6);  set(m.fr, '_', Key::Num8);
+            set(m.fr, ')', Key::Minus); set(m.fr, '=', Key::Equal); set(m.fr, '+', Key::Equal, MOD_SHIFT);
+            set(m.fr, '~', Key::Num2, MOD_ALTGR);  set(m.fr, '#', Key::Num3, MOD_ALTGR);
+            set(m.fr, '{', Key::Num4, MOD_ALTGR);  set(m.fr, '[', Key::Num5, MOD_ALTGR);
+            set(m.fr, '|', Key::Num6, MOD_ALTGR);  set(m.fr, '`', Key::Num7, MOD_ALTGR);
+            set(m.fr, '\\', Key::Num8, MOD_ALTGR); set(m.fr, '^', Key::Num9, MOD_ALTGR);
+            set(m.fr, '@', Key::Num0, MOD_ALTGR);  set(m.fr, ']', Key::Minus, MOD_ALTGR);
+            set(m.fr, '}', Key::Equal, MOD_ALTGR);
+            set(m.fr, '$', Key::RightBracket);
+            set(m.fr, '*', Key::Backslash);
+            set(m.fr, '%', Key::Quote, MOD_SHIFT);
+            set(m.fr, ',', Key::M);     set(m.fr, '?', Key::M, MOD_SHIFT);
+            set(m.fr, ';', Key::Comma); set(m.fr, '.', Key::Comma, MOD_SHIFT);
+            set(m.fr, ':', Key::Dot);   set(m.fr, '/', Key::Dot, MOD_SHIFT);
+            set(m.fr, '!', Key::Slash);
+
+            // ---- DE (QWERTZ) ----
+            for (char c = 'a'; c <= 'z'; ++c) {
+                Key key = static_cast<Key>('A' + (c - 'a'));
+                if (c == 'y') key = Key::Z;
+                else if (c == 'z') key = Key::Y;
+                set(m.de, c, key);
+                set(m.de, static_cast<char>(c - 'a' + 'A'), key, MOD_SHIFT);
+            }
+            for (char c = '0'; c <= '9'; ++c) set(m.de, c, static_cast<Key>(c));
+            const char* deShiftedDigits = "=!\"\0$%&/()";
+            for (int i = 0; i < 10; ++i) {
+                if (deShiftedDigits[i]) set(m.de, deShiftedDigits[i], static_cast<Key>('0' + i), MOD_SHIFT);
+            }
+            set(m.de, '{', Key::Num7, MOD_ALTGR);  set(m.de, '[', Key::Num8, MOD_ALTGR);
+            set(m.de, ']', Key::Num9, MOD_ALTGR);  set(m.de, '}', Key::Num0, MOD_ALTGR);
+            set(m.de, '?', Key::Minus, MOD_SHIFT); set(m.de, '\\', Key::Minus, MOD_ALTGR);
+            set(m.de, '+', Key::RightBracket);     set(m.de, '*', Key::RightBracket, MOD_SHIFT);
+            set(m.de, '~', Key::RightBracket, MOD_ALTGR);
+            set(m.de, '#', Key::Backslash);        set(m.de, '\'', Key::Backslash, MOD_SHIFT);
+            set(m.de, ',', Key::Comma);            set(m.de, ';', Key::Comma, MOD_SHIFT);
+            set(m.de, '.', Key::Dot);              set(m.de, ':', Key::Dot, MOD_SHIFT);
+            set(m.de, '-', Key::Slash);            set(m.de, '_', Key::Slash, MOD_SHIFT);
+            set(m.de, '@', Key::Q, MOD_ALTGR);
+            return m;
+        }();
+
+        switch (layout) {
+            case Layout::FR: return maps.fr;
+            case Layout::DE: return maps.de;
+            case Layout::UK: return maps.uk;
+            default: return maps.us;
+        }
+    }
+
     std::unordered_map<unsigned int, bool> m_keyStates;
+    std::unordered_map<unsigned int, uint64_t> m_keyPressNs;
     std::mutex m_keyMutex;
+
+    std::mutex m_recordMutex;
+    std::atomic<bool> m_recording{false};
+    unsigned int m_recordIgnore = 0;
+    uint64_t m_recordStartNs = 0;
+    std::vector<RecordedEvent> m_recorded;
+
+    void recordEvent(uint64_t time_ns, RecordedEvent::Type type, unsigned int code, int dx, int dy) {
+        if (!m_recording) return;
+        if (type != RecordedEvent::Type::MouseMove && code == m_recordIgnore) return;
+
+        std::lock_guard<std::mutex> lock(m_recordMutex);
+        if (!m_recording) return;
+        if (m_recordStartNs == 0) m_recordStartNs = time_ns;
+        uint64_t offset_us = time_ns > m_recordStartNs ? (time_ns - m_recordStartNs) / 1000 : 0;
+        m_recorded.push_back({offset_us, type, static_cast<Key>(code), dx, dy});
+    }
     std::thread m_listenerThread;
     std::atomic<bool> m_running;
     bool m_initialized;
@@ -362,6 +689,16 @@ private:
 #endif
     }
 
+    // Send every transition of a frame in one batch
+    void emitFrame(const TextFrame& frame) {
+        TRACE_SCOPE("input", "emitFrame");
+#ifdef _WIN32
+        emitFrameWindows(frame);
+#else
+        emitFrameLinux(frame);
+#endif
+    }
+
 #ifdef _WIN32
     // ==================== WINDOWS IMPLEMENTATION ====================
     HHOOK m_hookHandle;
@@ -376,8 +713,23 @@ private:
             if ((pkbhs->flags & LLKHF_INJECTED) == 0) {
                 bool isDown = (wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN);
                 
-                std::lock_guard<std::mutex> lock(s_instance->m_keyMutex);
-                s_instance->m_keyStates[pkbhs->vkCode] = isDown;
+                uint64_t now_ns = static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch()).count());
+                bool changed;
+                {
+                    std::lock_guard<std::mutex> lock(s_instance->m_keyMutex);
+                    bool& state = s_instance->m_keyStates[pkbhs->vkCode];
+                    changed = (state != isDown);
+                    if (isDown && !state) s_instance->m_keyPressNs[pkbhs->vkCode] = now_ns;
+                    state = isDown;
+                }
+                // Auto-repeat keydowns are not transitions
+                if (changed) {
+                    s_instance->recordEvent(now_ns, isDown ? RecordedEvent::Type::KeyDown : RecordedEvent::Type::KeyUp,
+                                            pkbhs->vkCode, 0, 0);
+                }
+                TRACE_INSTANT("input", "key_event");
             }
         }
         return CallNextHookEx(s_instance->m_hookHandle, nCode, wParam, lParam);
@@ -420,6 +772,7 @@ private:
     }
     
     void windowsEventLoop() {
+        TRACE_THREAD_NAME("input listener");
         MSG msg;
         // Process messages to keep hook alive
         while (m_running) {
@@ -431,10 +784,9 @@ private:
         }
     }
     
-    void holdKeyWindows(unsigned int vkCode) {
-        INPUT input = {0};
+    void fillKeyInputWindows(INPUT& input, unsigned int vkCode, bool keyUp) {
         input.type = INPUT_KEYBOARD;
-        
+
         // For the slash key (and other OEM keys), use scan code
         if (vkCode == 0xBF) {  // VK_OEM_2 (slash key)
             input.ki.wScan = 0x35;  // Hardware scan code for /
@@ -444,26 +796,30 @@ private:
             input.ki.wScan = MapVirtualKey(vkCode, MAPVK_VK_TO_VSC);
             input.ki.dwFlags = 0;
         }
-        
+        if (keyUp) input.ki.dwFlags |= KEYEVENTF_KEYUP;
+    }
+
+    void holdKeyWindows(unsigned int vkCode) {
+        INPUT input = {0};
+        fillKeyInputWindows(input, vkCode, false);
         SendInput(1, &input, sizeof(INPUT));
     }
 
     void releaseKeyWindows(unsigned int vkCode) {
         INPUT input = {0};
-        input.type = INPUT_KEYBOARD;
-        
-        // For the slash key (and other OEM keys), use scan code
-        if (vkCode == 0xBF) {  // VK_OEM_2 (slash key)
-            input.ki.wScan = 0x35;  // Hardware scan code for /
-            input.ki.dwFlags = KEYEVENTF_SCANCODE | KEYEVENTF_KEYUP;
-        } else {
-            input.ki.wVk = vkCode;
-            input.ki.wScan = MapVirtualKey(vkCode, MAPVK_VK_TO_VSC);
-            input.ki.dwFlags = KEYEVENTF_KEYUP;
-        }
-        
+        fillKeyInputWindows(input, vkCode, true);
         SendInput(1, &input, sizeof(INPUT));
     }
+
+    void emitFrameWindows(const TextFrame& frame) {
+        INPUT inputs[4];
+        memset(inputs, 0, sizeof(inputs));
+        for (unsigned char i = 0; i < frame.count; ++i) {
+            fillKeyInputWindows(inputs[i], static_cast<unsigned int>(frame.events[i].key),
+                                !frame.events[i].down);
+        }
+        SendInput(frame.count, inputs, sizeof(INPUT));
+    }
     
     void moveMouseWindows(int dx, int dy) {
         INPUT input = {0};
@@ -545,6 +901,12 @@ private:
     // ==================== LINUX IMPLEMENTATION ====================
     int m_uinputFd;
     std::vector<int> m_inputFds;
+    std::vector<bool> m_inputFdRecordable;
+    std::mutex m_pendingMutex;
+    std::vector<std::pair<int, int>> m_pendingMotion;     // REL_X/REL_Y per device until SYN_REPORT
+    std::mutex m_sinkMutex;
+    OutputSink m_outputSink;
+    RawListener m_rawListener;
     
     bool initLinux() {
         // Initialize uinput for output
@@ -604,9 +966,12 @@ private:
             close(fd);
         }
         m_inputFds.clear();
+        m_inputFdRecordable.clear();
     }
     
     void linuxEventLoop() {
+        TRACE_THREAD_NAME("input listener");
+
         // Open all input devices
         DIR* dir = opendir("/dev/input");
         if (!dir) return;
@@ -617,44 +982,110 @@ private:
                 std::string path = "/dev/input/" + std::string(ent->d_name);
                 int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK);
                 if (fd >= 0) {
+                    // Stamp events with CLOCK_MONOTONIC (steady_clock) instead of wall time
+                    int clock_id = CLOCK_MONOTONIC;
+                    ioctl(fd, EVIOCSCLOCKID, &clock_id);
+
+                    // Our own uinput device only carries injected input, never record it
+                    char name[256] = {0};
+                    ioctl(fd, EVIOCGNAME(sizeof(name)), name);
                     m_inputFds.push_back(fd);
+                    m_inputFdRecordable.push_back(strcmp(name, "CrossInput Virtual Device") != 0);
                 }
             }
         }
         closedir(dir);
         
-        struct input_event ev;
+        struct input_event events[64];
         while (m_running) {
-            for (int fd : m_inputFds) {
-                ssize_t n = read(fd, &ev, sizeof(ev));
-                if (n == sizeof(ev)) {
-                    // Handle keyboard events
-                    if (ev.type == EV_KEY && ev.code < 256) {
-                        unsigned int winCode = fromEvdevCode(ev.code);
-                        std::lock_guard<std::mutex> lock(m_keyMutex);
-                        m_keyStates[winCode] = (ev.value != 0);
-                    }
-                    // Handle mouse button events
-                    else if (ev.type == EV_KEY) {
-                        unsigned int winCode = 0;
-                        if (ev.code == BTN_LEFT) winCode = 0x01;       // LMB
-                        else if (ev.code == BTN_RIGHT) winCode = 0x02; // RMB
-                        else if (ev.code == BTN_MIDDLE) winCode = 0x04; // MMB
-                        else if (ev.code == BTN_SIDE) winCode = 0x05;   // Mouse4
-                        else if (ev.code == BTN_EXTRA) winCode = 0x06;  // Mouse5
-                        
-                        if (winCode != 0) {
-                            std::lock_guard<std::mutex> lock(m_keyMutex);
-                            m_keyStates[winCode] = (ev.value != 0);
-                        }
+            for (size_t d = 0; d < m_inputFds.size(); ++d) {
+                bool recordable = m_inputFdRecordable[d];
+                ssize_t n;
+                // Drain everything queued on this device, not one event per poll
+                while ((n = read(m_inputFds[d], events, sizeof(events))) > 0) {
+                    size_t count = static_cast<size_t>(n) / sizeof(struct input_event);
+                    for (size_t i = 0; i < count; ++i) {
+                        handleDeviceEvent(d, events[i], recordable);
+                        if (m_rawListener) m_rawListener(d, events[i], recordable);
                     }
                 }
             }
             std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
     }
+
+    // Key state and recorder update for one event of device `d`
+    void handleDeviceEvent(size_t d, const struct input_event& ev, bool recordable) {
+        // Handle keyboard events
+        if (ev.type == EV_KEY && ev.code < 256) {
+            unsigned int winCode = fromEvdevCode(ev.code);
+            {
+                std::lock_guard<std::mutex> lock(m_keyMutex);
+                m_keyStates[winCode] = (ev.value != 0);
+                if (ev.value == 1) m_keyPressNs[winCode] = eventTimeNs(ev);
+            }
+            TRACE_INSTANT("input", "key_event");
+            if (recordable && ev.value != 2) {
+                recordEvent(eventTimeNs(ev), ev.value ? RecordedEvent::Type::KeyDown
+                                                      : RecordedEvent::Type::KeyUp, winCode, 0, 0);
+            }
+        }
+        // Handle mouse button events
+        else if (ev.type == EV_KEY) {
+            unsigned int winCode = 0;
+            if (ev.code == BTN_LEFT) winCode = 0x01;       // LMB
+            else if (ev.code == BTN_RIGHT) winCode = 0x02; // RMB
+            else if (ev.code == BTN_MIDDLE) winCode = 0x04; // MMB
+            else if (ev.code == BTN_SIDE) winCode = 0x05;   // Mouse4
+            else if (ev.code == BTN_EXTRA) winCode = 0x06;  // Mouse5
+
+            if (winCode != 0) {
+                {
+                    std::lock_guard<std::mutex> lock(m_keyMutex);
+                    m_keyStates[winCode] = (ev.value != 0);
+                    if (ev.value == 1) m_keyPressNs[winCode] = eventTimeNs(ev);
+                }
+                if (recordable) {
+                    recordEvent(eventTimeNs(ev), ev.value ? RecordedEvent::Type::KeyDown
+                                                          : RecordedEvent::Type::KeyUp, winCode, 0, 0);
+                }
+            }
+        }
+        // Handle mouse motion (recorder only)
+        // Mouse motion arrives as separate REL_X/REL_Y events closed by a SYN_REPORT
+        else if (recordable && (ev.type == EV_REL || (ev.type == EV_SYN && ev.code == SYN_REPORT))) {
+            std::lock_guard<std::mutex> lock(m_pendingMutex);
+            if (d >= m_pendingMotion.size()) m_pendingMotion.resize(d + 1, {0, 0});
+            std::pair<int, int>& pending = m_pendingMotion[d];
+            if (ev.type == EV_REL && ev.code == REL_X) pending.first += ev.value;
+            else if (ev.type == EV_REL && ev.code == REL_Y) pending.second += ev.value;
+            else if (ev.type == EV_SYN && (pending.first != 0 || pending.second != 0)) {
+                recordEvent(eventTimeNs(ev), RecordedEvent::Type::MouseMove, 0, pending.first, pending.second);
+                pending = {0, 0};
+            }
+        }
+    }
     
+    static uint64_t eventTimeNs(const struct input_event& ev) {
+        return static_cast<uint64_t>(ev.input_event_sec) * 1000000000ULL +
+               static_cast<uint64_t>(ev.input_event_usec) * 1000ULL;
+    }
+
     void emitEvent(int type, int code, int val) {
+        {
+            std::lock_guard<std::mutex> lock(m_sinkMutex);
+            if (m_outputSink) {
+                struct input_event events[2];
+                memset(events, 0, sizeof(events));
+                events[0].type = type;
+                events[0].code = code;
+                events[0].value = val;
+                events[1].type = EV_SYN;
+                events[1].code = SYN_REPORT;
+                m_outputSink(events, 2);
+                return;
+            }
+        }
         if (m_uinputFd < 0) return;
         
         struct input_event ie;
@@ -672,6 +1103,28 @@ private:
         write(m_uinputFd, &ie, sizeof(ie));
     }
     
+    void emitFrameLinux(const TextFrame& frame) {
+        // All transitions plus one SYN_REPORT in a single write
+        struct input_event events[5];
+        memset(events, 0, sizeof(events));
+        for (unsigned char i = 0; i < frame.count; ++i) {
+            events[i].type = EV_KEY;
+            events[i].code = toEvdevCode(static_cast<unsigned int>(frame.events[i].key));
+            events[i].value = frame.events[i].down ? 1 : 0;
+        }
+        events[frame.count].type = EV_SYN;
+        events[frame.count].code = SYN_REPORT;
+        {
+            std::lock_guard<std::mutex> lock(m_sinkMutex);
+            if (m_outputSink) {
+                m_outputSink(events, frame.count + 1);
+                return;
+            }
+        }
+        if (m_uinputFd < 0) return;
+        write(m_uinputFd, events, sizeof(struct input_event) * (frame.count + 1));
+    }
+
     void holdKeyLinux(unsigned int evdevCode) {
         emitEvent(EV_KEY, evdevCode, 1);
     }
@@ -835,6 +1288,9 @@ private:
             {0x25, KEY_LEFT}, {0x26, KEY_UP}, {0x27, KEY_RIGHT}, {0x28, KEY_DOWN},
             // Backspace, Delete, Insert (if not already there)
             {0x08, KEY_BACKSPACE}, {0x2E, KEY_DELETE}, {0x2D, KEY_INSERT},
+            // Mouse buttons
+            {0x01, BTN_LEFT}, {0x02, BTN_RIGHT}, {0x04, BTN_MIDDLE},
+            {0x05, BTN_SIDE}, {0x06, BTN_EXTRA},
 
         };
         
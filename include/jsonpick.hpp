@@ -0,0 +1,223 @@
+/*
+===============================================================================
+jsonpick - Streaming extraction of a few keys from a JSON document (Header-Only)
+===============================================================================
+
+Reads only the values asked for out of a JSON document through the SAX
+interface of nlohmann::json: no DOM is built, values outside the requested
+paths are tokenized and dropped, and parsing stops as soon as every field
+has been found. The cost of a lookup then depends on where the keys sit in
+the document, not on how large it is, and apart from the returned values it
+allocates nothing.
+
+Features:
+- Fields addressed by a path of object keys from the root
+- Strings, numbers, booleans and null; a number keeps its text as written
+- Early stop once all fields are found
+- Any nlohmann input: std::istream, std::string, iterator pair, FILE*
+
+Arrays are stepped over; fields inside them can't be addressed. Up to 64
+fields are looked up per call.
+
+Usage example:
+(C++)
+
+----------------------------------------------------------------------
+#include "jsonpick.hpp"
+
+std::vector<jsonpick::Field> fields = {{"UserId"}, {"Profile", "Name"}};
+std::ifstream f("appStorage.json");
+if (jsonpick::extract(f, fields) && fields[1].kind == jsonpick::Kind::String) {
+    printf("%s\n", fields[1].value.c_str());
+}
+----------------------------------------------------------------------
+
+===============================================================================
+*/
+
+#pragma once
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+#include "json.hpp"
+
+namespace jsonpick {
+
+enum class Kind { Missing, String, Number, Boolean, Null, Container };
+
+struct Field {
+    Field() = default;
+    Field(std::initializer_list<std::string> keys) : path(keys) {}
+
+    std::vector<std::string> path;  // object keys from the root
+    Kind kind = Kind::Missing;
+    std::string value;              // string contents, or the number/boolean as written
+};
+
+namespace detail {
+
+/// SAX handler matching keys against the fields' paths. Fields still on the
+/// path of the current container are kept as a bitmask per depth, so keys
+/// off every path are dismissed with one test.
+class Picker : public nlohmann::json_sax<nlohmann::json> {
+public:
+    static constexpr size_t MAX_FIELDS = 64;
+    static constexpr size_t MAX_DEPTH = 64;   // deeper containers match nothing
+
+    explicit Picker(std::vector<Field>& fields) : m_fields(fields) {
+        for (size_t i = 0; i < fields.size() && i < MAX_FIELDS; ++i) {
+            fields[i].kind = Kind::Missing;
+            fields[i].value.clear();
+            m_pending |= 1ULL << i;
+        }
+        m_missing = m_pending;
+    }
+
+    bool all_found() const { return m_missing == 0; }
+
+    bool null() override {
+        return scalar(Kind::Null, nullptr, 0);
+    }
+
+    bool boolean(bool val) override {
+        return val ? scalar(Kind::Boolean, "true", 4) : scalar(Kind::Boolean, "false", 5);
+    }
+
+    bool number_integer(number_integer_t val) override {
+        if (m_pending == 0) return true;
+        std::string text = std::to_string(val);
+        return scalar(Kind::Number, text.data(), text.size());
+    }
+
+    bool number_unsigned(number_unsigned_t val) override {
+        if (m_pending == 0) return true;
+        std::string text = std::to_string(val);
+        return scalar(Kind::Number, text.data(), text.size());
+    }
+
+    bool number_float(number_float_t, const string_t& s) override {
+        return scalar(Kind::Number, s.data(), s.size());
+    }
+
+    bool string(string_t& val) override {
+        return scalar(Kind::String, val.data(), val.size());
+    }
+
+    bool binary(binary_t&) override {
+        return scalar(Kind::Null, nullptr, 0);
+    }
+
+    bool start_object(std::size_t) override {
+        return open(true);
+    }
+
+    bool key(string_t& val) override {
+        // The object's own mask holds the fields whose path led here
+        uint64_t candidates = m_depth <= MAX_DEPTH ? m_masks[m_depth - 1] : 0;
+        m_pending = 0;
+        size_t index = m_depth - 1;
+        while (candidates) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctzll(candidates));
+            candidates &= candidates - 1;
+            if (m_fields[bit].path[index] == val) m_pending |= 1ULL << bit;
+        }
+        return true;
+    }
+
+    bool end_object() override {
+        return close();
+    }
+
+    bool start_array(std::size_t) override {
+        return open(false);
+    }
+
+    bool end_array() override {
+        return close();
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override {
+        return false;
+    }
+
+private:
+    // Fields ending at the value that follows; those going deeper descend into it
+    bool open(bool object) {
+        uint64_t ending = 0, deeper = 0;
+        split(ending, deeper);
+        for (uint64_t bits = ending; bits; bits &= bits - 1) {
+            m_fields[__builtin_ctzll(bits)].kind = Kind::Container;
+        }
+        m_missing &= ~ending;
+
+        ++m_depth;
+        if (m_depth <= MAX_DEPTH) m_masks[m_depth - 1] = object ? deeper : 0;
+        m_pending = 0;
+        return m_missing != 0;
+    }
+
+    bool close() {
+        --m_depth;
+        m_pending = 0;
+        return true;
+    }
+
+    bool scalar(Kind kind, const char* text, size_t length) {
+        if (m_pending == 0) return true;
+        uint64_t ending = 0, deeper = 0;
+        split(ending, deeper);
+        m_pending = 0;
+        if (ending == 0) return true;
+
+        for (uint64_t bits = ending; bits; bits &= bits - 1) {
+            Field& field = m_fields[__builtin_ctzll(bits)];
+            field.kind = kind;
+            if (text) field.value.assign(text, length);
+        }
+        m_missing &= ~ending;
+        return m_missing != 0;   // false stops the parser
+    }
+
+    void split(uint64_t& ending, uint64_t& deeper) const {
+        for (uint64_t bits = m_pending; bits; bits &= bits - 1) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctzll(bits));
+            if (m_fields[bit].path.size() == m_depth) {
+                ending |= 1ULL << bit;
+            } else {
+                deeper |= 1ULL << bit;
+            }
+        }
+    }
+
+    std::vector<Field>& m_fields;
+    uint64_t m_masks[MAX_DEPTH] = {};
+    uint64_t m_pending = 0;     // fields matched by the last key (the root before the first value)
+    uint64_t m_missing = 0;
+    size_t m_depth = 0;         // containers currently open
+};
+
+} // namespace detail
+
+/// Fill `fields` from the document. Stops reading once all of them are found.
+/// @return false if the document is malformed before that point; fields
+///         found up to the error are still filled in
+template <typename Input>
+inline bool extract(Input&& input, std::vector<Field>& fields) {
+    detail::Picker picker(fields);
+    if (fields.empty()) return true;
+    bool parsed = nlohmann::json::sax_parse(std::forward<Input>(input), &picker);
+    return parsed || picker.all_found();
+}
+
+/// Single string field, empty when it is missing or not a string
+template <typename Input>
+inline std::string extract_string(Input&& input, std::vector<std::string> path) {
+    std::vector<Field> fields(1);
+    fields[0].path = std::move(path);
+    extract(std::forward<Input>(input), fields);
+    return fields[0].kind == Kind::String ? std::move(fields[0].value) : std::string();
+}
+
+} // namespace jsonpick
@@ -9,8 +9,15 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <functional>
+#include <cctype>
+#include <cstdlib>
 
 #include "json.hpp"
+#include "jsonpick.hpp"
+#include "asynclog.hpp"
+#include "trace.hpp"
+#include "metrics.hpp"
 using json = nlohmann::json;
 
 #ifdef _WIN32
@@ -93,7 +100,80 @@ inline namespace logzz {
     inline int game_uses_camfix_percentage;
     inline std::map<unsigned long long, int> calculated_placeIDs;
 
+    // Timing fields of one "Report game_join_loadtime" line
+    struct JoinTiming {
+        unsigned long long place_ID = 0;
+        unsigned long long universe_ID = 0;
+        long long timestamp_ms = 0;     // log line timestamp, ms since the Unix epoch
+        double join_time = -1.0;        // as reported by the client, -1 if missing
+        double load_time = -1.0;
+    };
+
+    // Called for every join timing line loop_handle() reads. The whole log is
+    // re-read when it grows, so lines already seen come again.
+    inline std::function<void(const JoinTiming&)> on_join_timing;
+
+    // "2025-01-06T12:00:03.250Z" at the start of a log line, in ms since the Unix epoch (0 if malformed)
+    inline long long parse_log_timestamp(const std::string& line) {
+        int year, month, day, hour, minute, second, millis = 0;
+        if (sscanf(line.c_str(), "%4d-%2d-%2dT%2d:%2d:%2d.%3d", &year, &month, &day, &hour, &minute, &second, &millis) < 6) {
+            return 0;
+        }
+        // Days since 1970-01-01 in the proleptic Gregorian calendar
+        year -= month <= 2;
+        long long era = (year >= 0 ? year : year - 399) / 400;
+        long long year_of_era = year - era * 400;
+        long long day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        long long day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+        long long days = era * 146097 + day_of_era - 719468;
+        return ((days * 24 + hour) * 60 + minute) * 60000LL + second * 1000LL + millis;
+    }
+
+    // Reads the "key:value" pairs after "game_join_loadtime:". Keys with "join" in
+    // them give the join time, keys with "load" (or a bare "time") the load time.
+    // @return false if the line is not a join timing report or carries no timing
+    inline bool parse_join_timing(const std::string& line, JoinTiming& out) {
+        size_t pos = line.find("game_join_loadtime:");
+        if (pos == std::string::npos || line.find("FLog::GameJoinLoadTime") == std::string::npos) return false;
+        pos += strlen("game_join_loadtime:");
+
+        out = JoinTiming();
+        out.timestamp_ms = parse_log_timestamp(line);
+        while (pos < line.size()) {
+            size_t colon = line.find(':', pos);
+            if (colon == std::string::npos) break;
+            size_t end = line.find(',', colon);
+            if (end == std::string::npos) end = line.size();
+
+            std::string key;
+            for (size_t i = pos; i < colon; ++i) {
+                if (!isspace(static_cast<unsigned char>(line[i]))) key += static_cast<char>(tolower(static_cast<unsigned char>(line[i])));
+            }
+            const char* value = line.c_str() + colon + 1;
+            char* value_end;
+            double number = strtod(value, &value_end);
+            if (value_end != value) {
+                bool is_join = key.find("join") != std::string::npos;
+                bool is_load = key.find("load") != std::string::npos || key == "time";
+                if (key == "placeid") {
+                    out.place_ID = strtoull(value, nullptr, 10);
+                } else if (key == "universeid") {
+                    out.universe_ID = strtoull(value, nullptr, 10);
+                } else if (key.find("id") != std::string::npos) {
+                    // userid, visitid, ...
+                } else if (is_join && out.join_time < 0) {
+                    out.join_time = number;
+                } else if (is_load && !is_join && out.load_time < 0) {
+                    out.load_time = number;
+                }
+            }
+            pos = end + 1;
+        }
+        return out.place_ID != 0 && (out.join_time >= 0 || out.load_time >= 0);
+    }
+
     inline state loop_handle() {
+        TRACE_SCOPE("logzz", "loop_handle");
         logzz::last_state = logzz::current_state;
 
         // Validate logs folder path
@@ -154,11 +234,11 @@ inline namespace logzz {
                 return OFFLINE;
             }
         } catch (const fs::filesystem_error& e) {
-            printf("[logzz] Filesystem error: %s\n", e.what());
+            asynclog::write(asynclog::Level::Warn, "[logzz] Filesystem error: %s", e.what());
             current_state = INVALID;
             return INVALID;
         } catch (const std::exception& e) {
-            printf("[logzz] Unexpected error: %s\n", e.what());
+            asynclog::write(asynclog::Level::Warn, "[logzz] Unexpected error: %s", e.what());
             current_state = INVALID;
             return INVALID;
         }
@@ -177,6 +257,9 @@ inline namespace logzz {
         last_file_size = current_file_size;
 
         // Open and read log file
+        TRACE_SCOPE("logzz", "parse");
+        static metrics::Histogram& parse_time = metrics::get("Log parse");
+        metrics::ScopedTimer parse_timer(parse_time);
         std::ifstream log_file(most_recent_log_file);
         if (!log_file.is_open()) {
             current_state = INVALID;
@@ -239,6 +322,11 @@ inline namespace logzz {
                         }
                         last_universe_id_line = line;
                     }
+
+                    JoinTiming timing;
+                    if (on_join_timing && parse_join_timing(current_line, timing)) {
+                        on_join_timing(timing);
+                    }
                 }
 
                 // Parse state changes
@@ -276,7 +364,7 @@ inline namespace logzz {
                 }
             }
         } catch (const std::exception& e) {
-            printf("[logzz] Error reading log file: %s\n", e.what());
+            asynclog::write(asynclog::Level::Warn, "[logzz] Error reading log file: %s", e.what());
             log_file.close();
             current_state = INVALID;
             return INVALID;
@@ -295,7 +383,7 @@ inline namespace logzz {
                 try {
                     current_place_ID = std::stoull(last_place_id_string);
                 } catch (const std::exception& e) {
-                    printf("[logzz] Error parsing place ID: %s\n", e.what());
+                    asynclog::write(asynclog::Level::Warn, "[logzz] Error parsing place ID: %s", e.what());
                     current_place_ID = 0;
                 }
             } else {
@@ -328,6 +416,85 @@ inline namespace logzz {
         return current_state;
     }
 
+    // What one client log says about its instance
+    struct LogSummary {
+        state status = OFFLINE;
+        unsigned long long place_ID = 0;
+        unsigned long long universe_ID = 0;
+        unsigned long long user_ID = 0;
+    };
+
+    // Parses a single log file (e.g. the one a specific client instance has open)
+    // with the same markers as loop_handle(), without touching the globals above.
+    inline LogSummary summarize_log(const std::string& path) {
+        TRACE_SCOPE("logzz", "summarize");
+        LogSummary summary;
+        std::ifstream log_file(path);
+        if (!log_file.is_open()) {
+            summary.status = INVALID;
+            return summary;
+        }
+
+        auto parse_id = [](const std::string& line, const char* key) -> unsigned long long {
+            size_t pos = line.find(key);
+            if (pos == std::string::npos) return 0;
+            pos += strlen(key);
+            size_t end = line.find_first_of(", ", pos);
+            try {
+                return std::stoull(line.substr(pos, end == std::string::npos ? std::string::npos : end - pos));
+            } catch (...) {
+                return 0;
+            }
+        };
+
+        int last_place_id_line = 0;
+        int in_lua_app_line = 0;
+        int left_roblox_line = 0;
+        std::string current_line;
+        int line = 0;
+        while (std::getline(log_file, current_line)) {
+            line++;
+
+            size_t join_pos = current_line.find("Joining");
+            if (join_pos != std::string::npos) {
+                size_t placeid_index = join_pos + 58;
+                if (placeid_index < current_line.size()) {
+                    size_t place_id_end = current_line.find(' ', placeid_index);
+                    if (place_id_end != std::string::npos) {
+                        try {
+                            summary.place_ID = std::stoull(current_line.substr(placeid_index, place_id_end - placeid_index));
+                            last_place_id_line = line;
+                        } catch (...) {}
+                    }
+                }
+            }
+
+            if (current_line.find("FLog::GameJoinLoadTime") != std::string::npos &&
+                current_line.find("Report game_join_loadtime") != std::string::npos) {
+                summary.universe_ID = parse_id(current_line, "universeid:");
+                if (unsigned long long user_ID = parse_id(current_line, "userid:")) summary.user_ID = user_ID;
+            }
+
+            if (current_line.find("returnToLuaApp") != std::string::npos) {
+                in_lua_app_line = line;
+            }
+            if (current_line.find("setStage: (stage:None)") != std::string::npos) {
+                left_roblox_line = line;
+            }
+        }
+
+        if (left_roblox_line > last_place_id_line && left_roblox_line > in_lua_app_line) {
+            summary.status = OFFLINE;
+        } else if (in_lua_app_line > last_place_id_line) {
+            summary.status = IN_LUA_APP;
+        } else if (in_lua_app_line < last_place_id_line) {
+            summary.status = IN_GAME;
+        } else {
+            summary.status = OFFLINE;
+        }
+        return summary;
+    }
+
     // Returns the place name associated with a universe ID.
     // Cross-platform. Reads local_storage_folder_path/appStorage.json.
     inline std::string find_name_for_universe(uint64_t target_universe_id)
@@ -338,42 +505,12 @@ inline namespace logzz {
             return "";
         }
 
-        json root;
-        try {
-            f >> root;
-        } catch (...) {
-            return "";
-        }
-
-        if (!root.contains("DiscoveryClientFallbackCache")) return "";
-
-        // Get the string value
-        std::string cache_str = root["DiscoveryClientFallbackCache"].get<std::string>();
-
-        // Parse the string as JSON
-        json cache_json;
-        try {
-            cache_json = json::parse(cache_str);
-        } catch (...) {
-            return "";
-        }
-
-        // Navigate into "data" -> "contentMetadata" -> "Game"
-        if (!cache_json.contains("data")) return "";
-        const auto& data = cache_json["data"];
-        if (!data.contains("contentMetadata")) return "";
-        const auto& contentMetadata = data["contentMetadata"];
-        if (!contentMetadata.contains("Game")) return "";
-        const auto& games = contentMetadata["Game"];
-
-        // Keys are universe IDs as strings
-        std::string key = std::to_string(target_universe_id);
-        if (!games.contains(key)) return "";
+        // The cache is a JSON document stored as a string
+        std::string cache_str = jsonpick::extract_string(f, {"DiscoveryClientFallbackCache"});
+        if (cache_str.empty()) return "";
 
-        const auto& entry = games[key];
-        if (!entry.contains("name") || !entry["name"].is_string()) return "";
-
-        return entry["name"].get<std::string>();
+        // "data" -> "contentMetadata" -> "Game" -> universe ID (as a string) -> "name"
+        return jsonpick::extract_string(cache_str, {"data", "contentMetadata", "Game", std::to_string(target_universe_id), "name"});
     }
 
     // Loads user information from appStorage.json
@@ -383,40 +520,36 @@ inline namespace logzz {
         std::string file_path = local_storage_folder_path + get_path_separator() + "appStorage.json";
         std::ifstream f(file_path);
         if (!f.is_open()) {
-            printf("[logzz] Could not open appStorage.json\n");
+            asynclog::write(asynclog::Level::Warn, "[logzz] Could not open appStorage.json");
             return false;
         }
 
-        json root;
-        try {
-            f >> root;
-        } catch (...) {
-            printf("[logzz] Failed to parse appStorage.json\n");
+        // Streamed: stops reading as soon as the three keys are found
+        std::vector<jsonpick::Field> fields = {{"UserId"}, {"Username"}, {"DisplayName"}};
+        if (!jsonpick::extract(f, fields)) {
+            asynclog::write(asynclog::Level::Warn, "[logzz] Failed to parse appStorage.json");
             return false;
         }
 
-        // Extract UserId
-        if (root.contains("UserId")) {
+        // Extract UserId (stored as a string or a number)
+        const jsonpick::Field& user_id = fields[0];
+        if (user_id.kind == jsonpick::Kind::String || user_id.kind == jsonpick::Kind::Number) {
             try {
-                if (root["UserId"].is_string()) {
-                    current_user_ID = std::stoull(root["UserId"].get<std::string>());
-                } else if (root["UserId"].is_number()) {
-                    current_user_ID = root["UserId"].get<uint64_t>();
-                }
+                current_user_ID = std::stoull(user_id.value);
             } catch (...) {
-                printf("[logzz] Failed to parse UserId\n");
+                asynclog::write(asynclog::Level::Warn, "[logzz] Failed to parse UserId");
                 current_user_ID = 0;
             }
         }
 
         // Extract Username
-        if (root.contains("Username") && root["Username"].is_string()) {
-            current_username = root["Username"].get<std::string>();
+        if (fields[1].kind == jsonpick::Kind::String) {
+            current_username = fields[1].value;
         }
 
         // Extract DisplayName
-        if (root.contains("DisplayName") && root["DisplayName"].is_string()) {
-            current_display_name = root["DisplayName"].get<std::string>();
+        if (fields[2].kind == jsonpick::Kind::String) {
+            current_display_name = fields[2].value;
         }
 
         return true;
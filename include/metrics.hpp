@@ -0,0 +1,246 @@
+/*
+===============================================================================
+metrics - Latency histograms for live diagnostics (Header-Only)
+===============================================================================
+
+A registry of named histograms in the spirit of HdrHistogram: values are
+counted into log-linear buckets (32 linear steps per power of two), so any
+recorded latency is kept with ~3% precision from 1 ns up to hours while the
+memory per histogram stays fixed.
+
+Features:
+- Lock-free record() (relaxed atomic counters), safe from any thread
+- Percentiles, mean and exact max on demand
+- ScopedTimer for timing a block
+- Registry lookup by name, reset, and JSON export
+
+Values are nanoseconds. Look histograms up once and keep the reference, the
+registry lookup takes a lock.
+
+Usage example:
+(C++)
+
+----------------------------------------------------------------------
+#include "metrics.hpp"
+
+void tick() {
+    static metrics::Histogram& tick_time = metrics::get("tick");
+    metrics::ScopedTimer timer(tick_time);
+    // ... work ...
+}
+
+int main() {
+    for (int i = 0; i < 1000; ++i) tick();
+    metrics::Summary s = metrics::get("tick").summary();
+    printf("p99 %.1f us\n", s.p99_ns / 1000.0);
+    metrics::write_json("metrics.json");
+}
+----------------------------------------------------------------------
+
+===============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace metrics {
+
+inline uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/// Point-in-time view of a histogram (all values in nanoseconds)
+struct Summary {
+    uint64_t count = 0;
+    double mean_ns = 0.0;
+    uint64_t p50_ns = 0;
+    uint64_t p90_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t max_ns = 0;
+};
+
+class Histogram {
+public:
+    static constexpr int SUB_BITS = 5;
+    static constexpr uint64_t SUB_COUNT = 1ULL << SUB_BITS;
+    static constexpr int MAX_SHIFT = 40;                       // top bucket starts at ~9.7 hours
+    static constexpr size_t BUCKETS = (MAX_SHIFT + 2) * SUB_COUNT;
+
+    Histogram() {
+        for (auto& bucket : m_buckets) bucket.store(0, std::memory_order_relaxed);
+    }
+
+    Histogram(const Histogram&) = delete;
+    Histogram& operator=(const Histogram&) = delete;
+
+    void record(uint64_t value_ns) {
+        m_buckets[bucket_index(value_ns)].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(value_ns, std::memory_order_relaxed);
+
+        uint64_t current = m_max.load(std::memory_order_relaxed);
+        while (value_ns > current &&
+               !m_max.compare_exchange_weak(current, value_ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    /// Record a signed value, clamping negatives to zero
+    void record_signed(int64_t value_ns) {
+        record(value_ns > 0 ? static_cast<uint64_t>(value_ns) : 0);
+    }
+
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+
+    /// Value at the given percentile (0-100), as the midpoint of its bucket
+    uint64_t percentile(double p) const {
+        uint64_t total = count();
+        if (total == 0) return 0;
+
+        uint64_t target = static_cast<uint64_t>(p / 100.0 * static_cast<double>(total) + 0.5);
+        if (target < 1) target = 1;
+        if (target > total) target = total;
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += m_buckets[i].load(std::memory_order_relaxed);
+            if (seen >= target) {
+                uint64_t mid = bucket_low(i) + bucket_width(i) / 2;
+                uint64_t max = m_max.load(std::memory_order_relaxed);
+                return mid < max ? mid : max;
+            }
+        }
+        return m_max.load(std::memory_order_relaxed);
+    }
+
+    Summary summary() const {
+        Summary s;
+        s.count = count();
+        if (s.count == 0) return s;
+        s.mean_ns = static_cast<double>(m_sum.load(std::memory_order_relaxed)) / static_cast<double>(s.count);
+        s.p50_ns = percentile(50.0);
+        s.p90_ns = percentile(90.0);
+        s.p99_ns = percentile(99.0);
+        s.max_ns = m_max.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    void reset() {
+        for (auto& bucket : m_buckets) bucket.store(0, std::memory_order_relaxed);
+        m_count.store(0, std::memory_order_relaxed);
+        m_sum.store(0, std::memory_order_relaxed);
+        m_max.store(0, std::memory_order_relaxed);
+    }
+
+    static size_t bucket_index(uint64_t value) {
+        if (value < 2 * SUB_COUNT) return static_cast<size_t>(value);
+
+        int top = 63 - __builtin_clzll(value);
+        int shift = top - SUB_BITS;
+        if (shift > MAX_SHIFT) return BUCKETS - 1;
+        uint64_t sub = (value >> shift) - SUB_COUNT;
+        return static_cast<size_t>((shift + 1) * SUB_COUNT + sub);
+    }
+
+    static uint64_t bucket_low(size_t index) {
+        if (index < 2 * SUB_COUNT) return index;
+        int shift = static_cast<int>(index / SUB_COUNT) - 1;
+        return (SUB_COUNT + index % SUB_COUNT) << shift;
+    }
+
+    static uint64_t bucket_width(size_t index) {
+        if (index < 2 * SUB_COUNT) return 1;
+        return 1ULL << (index / SUB_COUNT - 1);
+    }
+
+private:
+    std::atomic<uint64_t> m_buckets[BUCKETS];
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_max{0};
+};
+
+/// Records the lifetime of the scope into a histogram
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& histogram) : m_histogram(histogram), m_start(now_ns()) {}
+    ~ScopedTimer() { m_histogram.record(now_ns() - m_start); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram& m_histogram;
+    uint64_t m_start;
+};
+
+namespace detail {
+
+struct Registry {
+    std::mutex mutex;
+    std::deque<std::pair<std::string, std::unique_ptr<Histogram>>> entries;
+};
+
+inline Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+} // namespace detail
+
+/// Find or create the histogram with this name (the reference stays valid)
+inline Histogram& get(const std::string& name) {
+    detail::Registry& r = detail::registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (auto& entry : r.entries) {
+        if (entry.first == name) return *entry.second;
+    }
+    r.entries.emplace_back(name, std::unique_ptr<Histogram>(new Histogram()));
+    return *r.entries.back().second;
+}
+
+/// All histograms in registration order
+inline std::vector<std::pair<std::string, Histogram*>> list() {
+    detail::Registry& r = detail::registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::vector<std::pair<std::string, Histogram*>> out;
+    out.reserve(r.entries.size());
+    for (auto& entry : r.entries) out.emplace_back(entry.first, entry.second.get());
+    return out;
+}
+
+inline void reset_all() {
+    for (auto& entry : list()) entry.second->reset();
+}
+
+/// Write every histogram's summary as JSON
+/// @return true if the file was written
+inline bool write_json(const std::string& path) {
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) return false;
+
+    fprintf(f, "{\n  \"unit\": \"ns\",\n  \"histograms\": {");
+    bool first = true;
+    for (auto& entry : list()) {
+        Summary s = entry.second->summary();
+        fprintf(f, "%s\n    \"%s\": {\"count\": %llu, \"mean\": %.1f, \"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"max\": %llu}",
+                first ? "" : ",", entry.first.c_str(),
+                static_cast<unsigned long long>(s.count), s.mean_ns,
+                static_cast<unsigned long long>(s.p50_ns), static_cast<unsigned long long>(s.p90_ns),
+                static_cast<unsigned long long>(s.p99_ns), static_cast<unsigned long long>(s.max_ns));
+        first = false;
+    }
+    fprintf(f, "\n  }\n}\n");
+    fclose(f);
+    return true;
+}
+
+} // namespace metrics
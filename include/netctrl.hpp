@@ -126,7 +126,8 @@ public:
     }
 
     ~NetCtrl() {
-        disable();
+        // Only undo what this process applied: tc/iptables rules of others stay
+        if (is_active_) disable();
 #ifdef _WIN32
         cleanupFumble();
 #endif
@@ -0,0 +1,533 @@
+/*
+===============================================================================
+PrivHelper - Shared-Memory Command Channel to a Privileged Helper (Header-Only)
+===============================================================================
+
+Author: 3443
+Date: [18/10/2026]
+License: MIT
+
+Description:
+-------------
+PrivHelper is the transport between an unprivileged program and a small
+privileged helper process that owns what needs root (input devices, cgroup
+files, other users' processes). Commands and events travel through lock-free
+single-producer/single-consumer rings in a shared memfd mapping; an eventfd
+per direction wakes the other side only when it is actually asleep, so a
+command costs one ring write and at most one syscall. Linux only.
+
+Features:
+----------
+- Fixed-size 256-byte commands (input events, PID lists or short strings)
+  in a 256-slot ring, device events back in a 1024-slot ring.
+- eventfd doorbells, skipped while the consumer is busy draining.
+- Completion per command (sequence number + result), waited on with a
+  futex on the shared counter; fire-and-forget commands don't wait at all.
+- Connection over a Unix socket: the helper checks the peer's uid and executable
+  (SO_PEERCRED) and hands over the memfd and eventfds with SCM_RIGHTS.
+- Header-only, no dependencies beyond the C++ standard library and Linux.
+
+Usage Example (C++):
+---------------------
+// Helper (root)
+int listener = privhelper::listen_socket("/run/user/1000/helper.sock", 1000, 1000);
+int sock = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+privhelper::Channel channel;
+if (privhelper::peer_uid(sock) == 1000 && privhelper::peer_runs_same_executable(sock) &&
+    channel.create() && channel.send(sock)) {
+    privhelper::Command command;
+    while (channel.wait_command(command, -1)) {
+        channel.complete(command.seq, handle(command));
+    }
+}
+
+// Client (user)
+privhelper::Channel channel;
+int sock = privhelper::connect_socket("/run/user/1000/helper.sock");
+if (channel.receive(sock)) {
+    privhelper::Command command = {};
+    command.op = privhelper::OP_NOP;
+    uint32_t seq = channel.submit(command);
+    int32_t result;
+    channel.wait_result(seq, 100, result);
+}
+
+Notes:
+------
+- Each ring has exactly one producer and one consumer. A client with
+  several submitting threads serializes them itself (Channel::submit takes
+  a mutex for that).
+- The helper validates every command; the channel only moves bytes.
+
+===============================================================================
+*/
+
+#pragma once
+
+#if defined(__linux__)
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/fsuid.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace privhelper {
+
+inline constexpr uint32_t MAGIC = 0x48505348;      // "HSPH"
+inline constexpr uint32_t VERSION = 1;
+
+enum Op : uint32_t {
+    OP_NOP = 0,
+    OP_EMIT_INPUT,          // events[count] to the virtual input device
+    OP_SUSPEND,             // pids[count]
+    OP_RESUME,
+    OP_SUSPEND_BY_NAME,     // text: executable name
+    OP_RESUME_BY_NAME,
+    OP_CALIBRATE,           // text: executable name; measures in the background, 1 if started
+    OP_CGROUP_WRITE,        // text: "<cgroup>\0<file>\0<value>"
+    OP_SHUTDOWN,            // stop the helper
+    OP_SET_PRIORITY,        // pids[0]: root of a process tree; arg: nice and I/O class, set on every member
+    OP_SET_AFFINITY,        // values[0]: CPU mask for the helper's own threads (0 = leave)
+};
+
+/// One input_event without its timestamp
+struct RawEvent {
+    uint16_t type;
+    uint16_t code;
+    int32_t value;
+};
+
+inline constexpr size_t COMMAND_PAYLOAD = 240;
+inline constexpr size_t MAX_EVENTS = COMMAND_PAYLOAD / sizeof(RawEvent);
+inline constexpr size_t MAX_PIDS = COMMAND_PAYLOAD / sizeof(int32_t);
+
+struct Command {
+    uint32_t op;
+    uint32_t seq;           // set by submit()
+    uint32_t count;         // events/pids used, or text length
+    uint32_t arg;           // op-specific option
+    union {
+        RawEvent events[MAX_EVENTS];
+        int32_t pids[MAX_PIDS];
+        uint64_t values[COMMAND_PAYLOAD / sizeof(uint64_t)];
+        char text[COMMAND_PAYLOAD];
+    };
+};
+static_assert(sizeof(Command) == 256, "command slot layout");
+
+/// An event read from an input device, helper to client
+struct DeviceEvent {
+    uint64_t time_ns;       // kernel timestamp (CLOCK_MONOTONIC)
+    uint32_t device;        // index of the device in the helper
+    uint16_t type;
+    uint16_t code;
+    int32_t value;
+    uint32_t recordable;    // not our own virtual device
+};
+static_assert(sizeof(DeviceEvent) == 24, "event slot layout");
+
+/// Lock-free single-producer/single-consumer ring, placed in shared memory.
+/// head and tail only ever grow; their difference is the fill level.
+template <typename T, uint32_t N>
+struct Ring {
+    static_assert((N & (N - 1)) == 0, "ring size must be a power of two");
+
+    alignas(64) std::atomic<uint32_t> head;     // written by the producer
+    alignas(64) std::atomic<uint32_t> tail;     // written by the consumer
+    alignas(64) T slots[N];
+
+    /// @return false if the ring is full
+    bool push(const T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == N) return false;
+        slots[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @return false if the ring is empty
+    bool pop(T& item) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        item = slots[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+    }
+};
+
+inline constexpr uint32_t COMMAND_SLOTS = 256;
+inline constexpr uint32_t EVENT_SLOTS = 1024;
+
+/// Layout of the shared mapping
+struct Shared {
+    uint32_t magic;
+    uint32_t version;
+    Ring<Command, COMMAND_SLOTS> commands;      // client -> helper
+    Ring<DeviceEvent, EVENT_SLOTS> events;      // helper -> client
+
+    // Doorbells are only rung while the consumer is (about to be) asleep
+    alignas(64) std::atomic<uint32_t> helper_sleeping;
+    alignas(64) std::atomic<uint32_t> client_sleeping;
+
+    // Completion: seq of the last finished command (futex word) and the
+    // results by seq % COMMAND_SLOTS
+    alignas(64) std::atomic<uint32_t> completed;
+    std::atomic<uint32_t> completion_waiters;
+    std::atomic<int32_t> results[COMMAND_SLOTS];
+    std::atomic<uint32_t> dropped_events;       // event ring was full
+};
+
+inline long futex(std::atomic<uint32_t>* word, int op, uint32_t value, const timespec* timeout) {
+    // Not FUTEX_PRIVATE: the word is shared between processes
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), op, value, timeout, nullptr, 0);
+}
+
+inline void ring_bell(int fd) {
+    uint64_t one = 1;
+    ssize_t written = write(fd, &one, sizeof(one));
+    (void)written;
+}
+
+inline void drain_bell(int fd) {
+    uint64_t count;
+    ssize_t n = read(fd, &count, sizeof(count));
+    (void)n;
+}
+
+/// Both ends of the shared mapping and its doorbells
+class Channel {
+public:
+    Channel() = default;
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+    ~Channel() { close_all(); }
+
+    bool valid() const { return m_shared != nullptr; }
+    void reset() { close_all(); }
+    Shared* shared() const { return m_shared; }
+    int command_bell() const { return m_command_bell; }
+    int event_bell() const { return m_event_bell; }
+
+    /// Helper side: allocate the mapping and the eventfds
+    bool create() {
+        close_all();
+        m_memfd = static_cast<int>(syscall(SYS_memfd_create, "privhelper", MFD_CLOEXEC));
+        if (m_memfd < 0 || ftruncate(m_memfd, sizeof(Shared)) != 0) {
+            close_all();
+            return false;
+        }
+        if (!map() || (m_command_bell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0 ||
+            (m_event_bell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0) {
+            close_all();
+            return false;
+        }
+        new (m_shared) Shared();
+        m_shared->magic = MAGIC;
+        m_shared->version = VERSION;
+        return true;
+    }
+
+    /// Helper side: hand the memfd and both eventfds to the client
+    bool send(int sock) const {
+        int fds[3] = {m_memfd, m_command_bell, m_event_bell};
+        char tag[4] = {'H', 'S', 'P', 'H'};
+        iovec io = {tag, sizeof(tag)};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))] = {};
+        msghdr message = {};
+        message.msg_iov = &io;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        cmsghdr* header = CMSG_FIRSTHDR(&message);
+        header->cmsg_level = SOL_SOCKET;
+        header->cmsg_type = SCM_RIGHTS;
+        header->cmsg_len = CMSG_LEN(sizeof(fds));
+        memcpy(CMSG_DATA(header), fds, sizeof(fds));
+        return sendmsg(sock, &message, MSG_NOSIGNAL) == static_cast<ssize_t>(sizeof(tag));
+    }
+
+    /// Client side: receive the descriptors from the helper and map them
+    bool receive(int sock) {
+        close_all();
+        char tag[4];
+        iovec io = {tag, sizeof(tag)};
+        alignas(cmsghdr) char control[CMSG_SPACE(3 * sizeof(int))] = {};
+        msghdr message = {};
+        message.msg_iov = &io;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        if (recvmsg(sock, &message, MSG_CMSG_CLOEXEC) != static_cast<ssize_t>(sizeof(tag))) return false;
+
+        cmsghdr* header = CMSG_FIRSTHDR(&message);
+        if (!header || header->cmsg_type != SCM_RIGHTS || header->cmsg_len != CMSG_LEN(3 * sizeof(int))) return false;
+        int fds[3];
+        memcpy(fds, CMSG_DATA(header), sizeof(fds));
+        m_memfd = fds[0];
+        m_command_bell = fds[1];
+        m_event_bell = fds[2];
+
+        struct stat info;
+        if (memcmp(tag, "HSPH", 4) != 0 || fstat(m_memfd, &info) != 0 ||
+            info.st_size != static_cast<off_t>(sizeof(Shared)) || !map() ||
+            m_shared->magic != MAGIC || m_shared->version != VERSION) {
+            close_all();
+            return false;
+        }
+        return true;
+    }
+
+    // ---------------------------------------------------------------- client
+
+    /// Queue a command and wake the helper if it sleeps. Thread-safe.
+    /// Waits up to timeout_ms for a free slot while the helper is a whole ring
+    /// behind, so a dead helper can't block the submitting threads forever.
+    /// @return its sequence number, for wait_result(), or 0 if the ring stayed full
+    uint32_t submit(Command& command, int timeout_ms = 1000) {
+        std::lock_guard<std::mutex> lock(m_submit_mutex);
+        if (++m_next_seq == 0) ++m_next_seq;
+        command.seq = m_next_seq;
+        uint64_t deadline = 0;
+        while (!m_shared->commands.push(command)) {
+            uint64_t now = now_ns();
+            if (deadline == 0) deadline = now + static_cast<uint64_t>(timeout_ms) * 1000000ULL;
+            if (now >= deadline) {
+                if (--m_next_seq == 0) --m_next_seq;
+                return 0;
+            }
+            std::this_thread::yield();
+        }
+        // Pairs with the fence in wait_command(): either the helper sees the
+        // command before sleeping, or we see it asleep and ring
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_shared->helper_sleeping.load(std::memory_order_relaxed)) ring_bell(m_command_bell);
+        return command.seq;
+    }
+
+    /// Wait until command `seq` finished.
+    /// @return false on timeout
+    bool wait_result(uint32_t seq, int timeout_ms, int32_t& result) {
+        uint64_t deadline = now_ns() + static_cast<uint64_t>(timeout_ms) * 1000000ULL;
+        while (true) {
+            uint32_t done = m_shared->completed.load(std::memory_order_acquire);
+            if (static_cast<int32_t>(done - seq) >= 0) {
+                result = m_shared->results[seq % COMMAND_SLOTS].load(std::memory_order_relaxed);
+                return true;
+            }
+            uint64_t now = now_ns();
+            if (now >= deadline) return false;
+            uint64_t left = deadline - now;
+            timespec timeout = {static_cast<time_t>(left / 1000000000ULL), static_cast<long>(left % 1000000000ULL)};
+            m_shared->completion_waiters.fetch_add(1, std::memory_order_seq_cst);
+            futex(&m_shared->completed, FUTEX_WAIT, done, &timeout);
+            m_shared->completion_waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    /// Next device event, sleeping up to timeout_ms (-1 = forever) for one.
+    /// Only one thread may call this.
+    bool wait_event(DeviceEvent& event, int timeout_ms) {
+        return wait_item(m_shared->events, m_shared->client_sleeping, m_event_bell, event, timeout_ms);
+    }
+
+    // ---------------------------------------------------------------- helper
+
+    /// Next command, sleeping up to timeout_ms (-1 = forever) for one
+    bool wait_command(Command& command, int timeout_ms) {
+        return wait_item(m_shared->commands, m_shared->helper_sleeping, m_command_bell, command, timeout_ms);
+    }
+
+    void complete(uint32_t seq, int32_t result) {
+        m_shared->results[seq % COMMAND_SLOTS].store(result, std::memory_order_relaxed);
+        m_shared->completed.store(seq, std::memory_order_seq_cst);
+        if (m_shared->completion_waiters.load(std::memory_order_seq_cst)) {
+            futex(&m_shared->completed, FUTEX_WAKE, INT_MAX, nullptr);
+        }
+    }
+
+    /// Forward a device event; dropped (and counted) if the client is a whole ring behind
+    void post_event(const DeviceEvent& event) {
+        if (!m_shared->events.push(event)) {
+            m_shared->dropped_events.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_shared->client_sleeping.load(std::memory_order_relaxed)) ring_bell(m_event_bell);
+    }
+
+private:
+    static uint64_t now_ns() {
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + static_cast<uint64_t>(now.tv_nsec);
+    }
+
+    template <typename T, uint32_t N>
+    static bool wait_item(Ring<T, N>& ring, std::atomic<uint32_t>& sleeping, int bell, T& item, int timeout_ms) {
+        if (ring.pop(item)) return true;
+        uint64_t deadline = timeout_ms < 0 ? UINT64_MAX : now_ns() + static_cast<uint64_t>(timeout_ms) * 1000000ULL;
+        while (true) {
+            sleeping.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (ring.pop(item)) {
+                sleeping.store(0, std::memory_order_relaxed);
+                return true;
+            }
+
+            int wait_ms = -1;
+            if (deadline != UINT64_MAX) {
+                uint64_t now = now_ns();
+                if (now >= deadline) {
+                    sleeping.store(0, std::memory_order_relaxed);
+                    return false;
+                }
+                wait_ms = static_cast<int>((deadline - now + 999999ULL) / 1000000ULL);
+            }
+            pollfd fd = {bell, POLLIN, 0};
+            int ready = poll(&fd, 1, wait_ms);
+            sleeping.store(0, std::memory_order_relaxed);
+            if (ready > 0) drain_bell(bell);
+            else if (ready < 0 && errno != EINTR) return false;
+            if (ring.pop(item)) return true;
+        }
+    }
+
+    bool map() {
+        void* address = mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED, m_memfd, 0);
+        if (address == MAP_FAILED) return false;
+        m_shared = static_cast<Shared*>(address);
+        return true;
+    }
+
+    void close_all() {
+        if (m_shared) munmap(m_shared, sizeof(Shared));
+        m_shared = nullptr;
+        for (int* fd : {&m_memfd, &m_command_bell, &m_event_bell}) {
+            if (*fd >= 0) close(*fd);
+            *fd = -1;
+        }
+    }
+
+    Shared* m_shared = nullptr;
+    int m_memfd = -1;
+    int m_command_bell = -1;
+    int m_event_bell = -1;
+    std::mutex m_submit_mutex;
+    uint32_t m_next_seq = 0;
+};
+
+/// Filesystem access of this thread with the rights of uid/gid while in scope,
+/// when running as root (nothing otherwise). Paths in directories the user
+/// controls are then resolved as the user, never as root.
+class FilesystemIds {
+public:
+    FilesystemIds(uid_t uid, gid_t gid) : m_active(geteuid() == 0) {
+        if (!m_active) return;
+        m_old_gid = static_cast<gid_t>(setfsgid(gid));
+        m_old_uid = static_cast<uid_t>(setfsuid(uid));
+    }
+    ~FilesystemIds() {
+        if (!m_active) return;
+        int error = errno;
+        setfsuid(m_old_uid);
+        setfsgid(m_old_gid);
+        errno = error;
+    }
+    FilesystemIds(const FilesystemIds&) = delete;
+    FilesystemIds& operator=(const FilesystemIds&) = delete;
+
+private:
+    bool m_active;
+    uid_t m_old_uid = 0;
+    gid_t m_old_gid = 0;
+};
+
+/// Listening socket at `path`, mode 0600, owned by uid/gid (under sudo: the user).
+/// Created with their filesystem ids instead of chown'ed afterwards, so a link
+/// swapped in meanwhile can't make root hand over another file.
+inline int listen_socket(const std::string& path, uid_t owner, gid_t group) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) return -1;
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    bool bound;
+    {
+        FilesystemIds ids(owner, group);
+        unlink(path.c_str());
+        mode_t old_mask = umask(0177);
+        bound = bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        umask(old_mask);
+    }
+    if (!bound || listen(fd, 2) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/// Remove a socket made by listen_socket(), with the same filesystem ids
+inline void remove_socket(const std::string& path, uid_t owner, gid_t group) {
+    FilesystemIds ids(owner, group);
+    unlink(path.c_str());
+}
+
+inline int connect_socket(const std::string& path) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) return -1;
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/// uid of the process at the other end of a Unix socket, -1 if unknown
+inline long peer_uid(int sock) {
+    ucred credentials;
+    socklen_t size = sizeof(credentials);
+    if (getsockopt(sock, SOL_SOCKET, SO_PEERCRED, &credentials, &size) != 0) return -1;
+    return credentials.uid;
+}
+
+/// true if the process at the other end of a connected socket runs the same
+/// executable as this one (same file, compared by device and inode)
+inline bool peer_runs_same_executable(int sock) {
+    ucred credentials;
+    socklen_t size = sizeof(credentials);
+    if (getsockopt(sock, SOL_SOCKET, SO_PEERCRED, &credentials, &size) != 0) return false;
+    struct stat peer_exe, own_exe;
+    std::string peer_path = "/proc/" + std::to_string(credentials.pid) + "/exe";
+    if (stat(peer_path.c_str(), &peer_exe) != 0 || stat("/proc/self/exe", &own_exe) != 0) return false;
+    return peer_exe.st_dev == own_exe.st_dev && peer_exe.st_ino == own_exe.st_ino;
+}
+
+} // namespace privhelper
+#endif
@@ -6,11 +6,15 @@ It currently supports Windows and Linux (fuck macos, never touching that shit).
 Features:
 - Suspend/resume a single process by PID
 - Suspend/resume all processes by executable name
+- Suspend/resume a list of processes concurrently (`set_processes_suspended`)
 - Query if a process exists and can be controlled
 - Find the parent PID or all descendants (process tree)
+- `ProcessSnapshot`: reads the process table once and answers name/parent/tree queries from it
 - Works on sandboxed applications on Linux (e.g., Snap/Flatpak)
 - Automatically handles cgroups on Linux when possible
-- Pure header-only: just include `procctrl.hpp` and use
+- Set CPU affinity, nice/priority class and I/O priority of a process and all its threads
+- Pure header-only: just include `procctrl.hpp` (and its `asynclog.hpp` logger) and use
+- Diagnostics go through asynclog, so suspend/resume never waits on a terminal write
 
 How it works:
 
@@ -20,10 +24,13 @@ How it works:
 - Falls back gracefully if permissions are insufficient
 
 -- Linux:
-- Non-sandboxed apps: sends `SIGSTOP` to suspend and `SIGCONT` to resume
-- Sandboxed apps in cgroup v2: writes `1` or `0` to `cgroup.freeze` for freezing/thawing
-- Traverses `/proc` to find processes and parent/child relationships
+- Freezes with `cgroup.freeze` (cgroup v2), `SIGSTOP`/`SIGCONT` to the process tree, or one
+  signal to the process group. The fastest method that really stops every thread is measured
+  once per app cgroup (`calibrate_freeze_method`) and can be forced with `freeze_method_override`
+- Reads `/proc` once per query (raw `openat`/`read`) to find processes and parent/child relationships
 - Supports cgroup-aware suspension to prevent partial freezes for multi-process applications
+- Optionally waits until the freeze has really happened (`confirm_timeout_ms`): epoll on
+  `cgroup.events` for frozen cgroups, the thread states in `/proc/<pid>/task` for SIGSTOP
 
 Huge thanks to the original inspirations:
 - https://github.com/craftwar/suspend
@@ -52,13 +59,23 @@ int main() {
 #pragma once
 #include <string>
 #include <vector>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
 #include <unordered_set>
 #include <fstream>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
 #include <sstream>
+#include <thread>
 #include <algorithm>
 #include <cstdio>
 #include <cerrno>
 #include <cstring>
+#include "asynclog.hpp"
+#include "trace.hpp"
+#include "metrics.hpp"
 
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN // Reduces Windows header bloat
@@ -76,7 +93,12 @@ int main() {
     #include <csignal>
     #include <unistd.h>
     #include <dirent.h>
+    #include <fcntl.h>
+    #include <sched.h>
+    #include <sys/epoll.h>
+    #include <sys/resource.h>
     #include <sys/stat.h>
+    #include <sys/syscall.h>
 #endif
 
 namespace procctrl {
@@ -148,20 +170,14 @@ inline int get_max_pid() {
     return max_pid;
 }
 
-/// Get the cgroup v2 filesystem path of a process (Linux only)
-/// @param pid Process ID to query
-/// @return Cgroup path (empty string if not found or on cgroup v1)
-inline std::string get_cgroup_v2_path(pid_t pid) {
-    std::ifstream cgroup_file("/proc/" + std::to_string(pid) + "/cgroup");
-    if (!cgroup_file) return "";
-    
-    std::string line;
-    while (std::getline(cgroup_file, line)) {
-        if (line.rfind("0::/", 0) == 0) {
-            return "/sys/fs/cgroup" + line.substr(3);
-        }
-    }
-    return "";
+/// Whether procctrl freezes this cgroup through cgroup.freeze instead of signals
+/// (Flatpak/Snap style app scopes)
+/// @param cgroup_path Path returned by get_cgroup_v2_path()
+inline bool uses_cgroup_freeze(const std::string& cgroup_path) {
+    return !cgroup_path.empty() &&
+           (cgroup_path.find("app-") != std::string::npos ||
+            cgroup_path.find("snap.") != std::string::npos) &&
+           is_cgroup_v2_available();
 }
 #endif
 
@@ -200,374 +216,1139 @@ inline bool can_control_process(pid_t pid) {
 #endif
 }
 
-/// Find the first process ID by executable name
-/// @param exe_name Name of the executable (e.g., "notepad.exe" on Windows, "firefox" on Linux)
-/// @return PID if found, -1 otherwise
-inline pid_t find_process_by_name(const std::string& exe_name) {
+/// Flat, indexed copy of the process table, read in a single pass.
+/// Name and tree queries on the same snapshot don't touch /proc (or the
+/// toolhelp snapshot) again. The snapshot is not updated; take a new one when
+/// processes may have started or exited.
+class ProcessSnapshot {
+public:
+    struct Entry {
+        pid_t pid;
+        pid_t ppid;
+        pid_t pgid;             // process group, only with Parents (Linux only, -1 otherwise)
+        std::string name;       // comm on Linux (max. 15 chars), executable name on Windows
+        std::string cgroup;     // cgroup v2 path, only with the Cgroups field (Linux only)
+    };
+
+    /// What to read besides the names. On Linux every field costs one read per
+    /// process (/proc/<pid>/stat is about twice as expensive as comm), on
+    /// Windows the toolhelp snapshot always has names and parents.
+    enum Field : unsigned {
+        Names = 0,
+        Parents = 1 << 0,
+        Cgroups = 1 << 1,
+    };
+
+    /// Read the process table
+    /// @param fields Combination of Field values (ppid is -1 without Parents)
+    static ProcessSnapshot take(unsigned fields = Parents) {
+        ProcessSnapshot snapshot;
 #ifdef _WIN32
-    HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-    if (hSnapshot == INVALID_HANDLE_VALUE) {
-        return static_cast<pid_t>(-1);
-    }
-    
-    PROCESSENTRY32W pe32;
-    pe32.dwSize = sizeof(PROCESSENTRY32W);
-    
-    if (Process32FirstW(hSnapshot, &pe32)) {
-        do {
-            // Convert wide string to narrow string for comparison
-            char szProcessName[MAX_PATH];
-            WideCharToMultiByte(CP_UTF8, 0, pe32.szExeFile, -1, 
-                              szProcessName, MAX_PATH, nullptr, nullptr);
-            
-            if (exe_name == szProcessName) {
-                CloseHandle(hSnapshot);
-                return pe32.th32ProcessID;
-            }
-        } while (Process32NextW(hSnapshot, &pe32));
-    }
-    
-    CloseHandle(hSnapshot);
-    return static_cast<pid_t>(-1);
+        (void)fields;
+        HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+        if (hSnapshot == INVALID_HANDLE_VALUE) {
+            return snapshot;
+        }
+
+        PROCESSENTRY32W pe32;
+        pe32.dwSize = sizeof(PROCESSENTRY32W);
+
+        if (Process32FirstW(hSnapshot, &pe32)) {
+            do {
+                char szProcessName[MAX_PATH];
+                WideCharToMultiByte(CP_UTF8, 0, pe32.szExeFile, -1,
+                                  szProcessName, MAX_PATH, nullptr, nullptr);
+                snapshot.m_entries.push_back({static_cast<pid_t>(pe32.th32ProcessID),
+                                              static_cast<pid_t>(pe32.th32ParentProcessID),
+                                              static_cast<pid_t>(-1), szProcessName, std::string()});
+            } while (Process32NextW(hSnapshot, &pe32));
+        }
+
+        CloseHandle(hSnapshot);
 #else
-    DIR* proc_dir = opendir("/proc");
-    if (!proc_dir) {
-        perror("[procctrl] Failed to open /proc");
-        return -1;
-    }
-    
-    struct dirent* entry;
-    pid_t result = -1;
-    
-    while ((entry = readdir(proc_dir)) != nullptr) {
-        // Skip non-directories
-        if (entry->d_type != DT_UNKNOWN && entry->d_type != DT_DIR) continue;
-        
-        char* endptr;
-        pid_t pid = strtol(entry->d_name, &endptr, 10);
-        if (*endptr != '\0') continue;
-        
-        std::ifstream comm("/proc/" + std::string(entry->d_name) + "/comm");
-        if (!comm) continue;
-        
-        std::string pname;
-        std::getline(comm, pname);
-        if (pname == exe_name) {
-            result = pid;
-            break;
+        DIR* proc_dir = opendir("/proc");
+        if (!proc_dir) {
+            asynclog::write(asynclog::Level::Error, "[procctrl] Failed to open /proc: %s", strerror(errno));
+            return snapshot;
         }
-    }
-    
-    closedir(proc_dir);
-    return result;
+        int proc_fd = dirfd(proc_dir);
+
+        struct dirent* entry;
+        while ((entry = readdir(proc_dir)) != nullptr) {
+            if (entry->d_type != DT_UNKNOWN && entry->d_type != DT_DIR) continue;
+
+            char* endptr;
+            pid_t pid = strtol(entry->d_name, &endptr, 10);
+            if (*endptr != '\0' || endptr == entry->d_name) continue;
+
+            Entry info;
+            if (!read_entry(proc_fd, entry->d_name, pid, fields, info)) continue;  // exited meanwhile
+            snapshot.m_entries.push_back(std::move(info));
+        }
+
+        closedir(proc_dir);
 #endif
-}
+        snapshot.build_index();
+        return snapshot;
+    }
 
-/// Find all process IDs by executable name
-/// @param exe_name Name of the executable
-/// @return Vector of PIDs (empty if none found)
-inline std::vector<pid_t> find_all_processes_by_name(const std::string& exe_name) {
-    std::vector<pid_t> pids;
-    
+    /// Read a single process, with the same fields as take() but without
+    /// walking /proc (on Windows it still takes a toolhelp snapshot)
+    /// @return false if the process doesn't exist (anymore)
+    static bool read_one(pid_t pid, unsigned fields, Entry& entry) {
 #ifdef _WIN32
-    HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-    if (hSnapshot == INVALID_HANDLE_VALUE) {
+        ProcessSnapshot snapshot = take(fields);
+        const Entry* found = snapshot.find(pid);
+        if (!found) return false;
+        entry = *found;
+        return true;
+#else
+        char pid_dir[32];
+        snprintf(pid_dir, sizeof(pid_dir), "/proc/%d", static_cast<int>(pid));
+        return read_entry(AT_FDCWD, pid_dir, pid, fields, entry);
+#endif
+    }
+
+    const std::vector<Entry>& entries() const { return m_entries; }
+
+    /// @return Entry for a PID, nullptr if it was not running when the snapshot was taken
+    const Entry* find(pid_t pid) const {
+        auto it = m_by_pid.find(pid);
+        return it == m_by_pid.end() ? nullptr : &m_entries[it->second];
+    }
+
+    /// @return All PIDs with this executable name, in /proc order
+    std::vector<pid_t> find_by_name(const std::string& exe_name) const {
+        std::vector<size_t> indices;
+        auto range = m_by_name.equal_range(exe_name);
+        for (auto it = range.first; it != range.second; ++it) {
+            indices.push_back(it->second);
+        }
+        std::sort(indices.begin(), indices.end());
+
+        std::vector<pid_t> pids;
+        pids.reserve(indices.size());
+        for (size_t index : indices) {
+            pids.push_back(m_entries[index].pid);
+        }
         return pids;
     }
-    
-    PROCESSENTRY32W pe32;
-    pe32.dwSize = sizeof(PROCESSENTRY32W);
-    
-    if (Process32FirstW(hSnapshot, &pe32)) {
-        do {
-            char szProcessName[MAX_PATH];
-            WideCharToMultiByte(CP_UTF8, 0, pe32.szExeFile, -1, 
-                              szProcessName, MAX_PATH, nullptr, nullptr);
-            
-            if (exe_name == szProcessName) {
-                pids.push_back(pe32.th32ProcessID);
+
+    /// @return Parent PID, -1 if unknown
+    pid_t parent_of(pid_t pid) const {
+        const Entry* entry = find(pid);
+        return entry ? entry->ppid : static_cast<pid_t>(-1);
+    }
+
+    /// @return Direct children of a process
+    std::vector<pid_t> children_of(pid_t pid) const {
+        std::vector<pid_t> children;
+        auto range = m_by_parent.equal_range(pid);
+        for (auto it = range.first; it != range.second; ++it) {
+            children.push_back(m_entries[it->second].pid);
+        }
+        return children;
+    }
+
+    /// @return root_pid and all of its descendants
+    std::vector<pid_t> tree(pid_t root_pid) const {
+        std::vector<pid_t> tree = {root_pid};
+        for (size_t i = 0; i < tree.size(); ++i) {
+            auto range = m_by_parent.equal_range(tree[i]);
+            for (auto it = range.first; it != range.second; ++it) {
+                pid_t child = m_entries[it->second].pid;
+                if (child != tree[i]) tree.push_back(child);  // pid 0 is its own parent on Windows
             }
-        } while (Process32NextW(hSnapshot, &pe32));
+        }
+        return tree;
     }
-    
-    CloseHandle(hSnapshot);
-#else
-    DIR* proc_dir = opendir("/proc");
-    if (!proc_dir) {
-        perror("[procctrl] Failed to open /proc");
-        return pids;
+
+private:
+#ifndef _WIN32
+    /// Fill one entry from <pid_dir>/{stat,comm,cgroup}, relative to dir_fd
+    static bool read_entry(int dir_fd, const char* pid_dir, pid_t pid, unsigned fields, Entry& info) {
+        char path[sizeof(dirent::d_name) + 16];
+        char buffer[1024];
+
+        info.pid = pid;
+        info.ppid = -1;
+        info.pgid = -1;
+        info.name.clear();
+        info.cgroup.clear();
+
+        if (fields & Parents) {
+            // "pid (comm) S ppid pgrp ..." gives the name, parent and group in one read
+            snprintf(path, sizeof(path), "%s/stat", pid_dir);
+            ssize_t n = read_small_file(dir_fd, path, buffer, sizeof(buffer));
+            if (n <= 0) return false;
+
+            const char* open_paren = static_cast<const char*>(memchr(buffer, '(', n));
+            const char* close_paren = static_cast<const char*>(memrchr(buffer, ')', n));
+            if (!open_paren || !close_paren || close_paren < open_paren) return false;
+
+            info.name.assign(open_paren + 1, close_paren);
+            char state;
+            if (sscanf(close_paren + 1, " %c %d %d", &state, &info.ppid, &info.pgid) != 3) return false;
+        } else {
+            snprintf(path, sizeof(path), "%s/comm", pid_dir);
+            ssize_t n = read_small_file(dir_fd, path, buffer, sizeof(buffer));
+            if (n <= 0) return false;
+            if (buffer[n - 1] == '\n') n--;
+            info.name.assign(buffer, n);
+        }
+
+        if (fields & Cgroups) {
+            snprintf(path, sizeof(path), "%s/cgroup", pid_dir);
+            if (read_small_file(dir_fd, path, buffer, sizeof(buffer)) > 0) info.cgroup = parse_cgroup_v2_line(buffer);
+        }
+        return true;
     }
-    
-    struct dirent* entry;
-    while ((entry = readdir(proc_dir)) != nullptr) {
-        // Skip non-directories
-        if (entry->d_type != DT_UNKNOWN && entry->d_type != DT_DIR) continue;
-        
-        char* endptr;
-        pid_t pid = strtol(entry->d_name, &endptr, 10);
-        if (*endptr != '\0') continue;
-        
-        std::ifstream comm("/proc/" + std::string(entry->d_name) + "/comm");
-        if (!comm) continue;
-        
-        std::string pname;
-        std::getline(comm, pname);
-        if (pname == exe_name) {
-            pids.push_back(pid);
+
+    /// open/read/close relative to the /proc directory fd, NUL-terminated
+    static ssize_t read_small_file(int dir_fd, const char* path, char* buffer, size_t size) {
+        int fd = openat(dir_fd, path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return -1;
+        ssize_t n = read(fd, buffer, size - 1);
+        close(fd);
+        if (n >= 0) buffer[n] = '\0';
+        return n;
+    }
+
+    /// "0::/path" line of /proc/<pid>/cgroup as a /sys/fs/cgroup path
+    static std::string parse_cgroup_v2_line(const char* content) {
+        const char* line = content;
+        while (line && *line) {
+            if (strncmp(line, "0::/", 4) == 0) {
+                const char* end = strchr(line, '\n');
+                return "/sys/fs/cgroup" + std::string(line + 3, end ? end : line + strlen(line));
+            }
+            line = strchr(line, '\n');
+            if (line) line++;
         }
+        return "";
     }
-    
-    closedir(proc_dir);
 #endif
-    
-    return pids;
+
+    void build_index() {
+        m_by_pid.reserve(m_entries.size());
+        m_by_name.reserve(m_entries.size());
+        m_by_parent.reserve(m_entries.size());
+        for (size_t i = 0; i < m_entries.size(); ++i) {
+            m_by_pid.emplace(m_entries[i].pid, i);
+            m_by_name.emplace(m_entries[i].name, i);
+            m_by_parent.emplace(m_entries[i].ppid, i);
+        }
+    }
+
+    std::vector<Entry> m_entries;
+    std::unordered_map<pid_t, size_t> m_by_pid;
+    std::unordered_multimap<std::string, size_t> m_by_name;
+    std::unordered_multimap<pid_t, size_t> m_by_parent;
+};
+
+/// Find the first process ID by executable name
+/// @param exe_name Name of the executable (e.g., "notepad.exe" on Windows, "firefox" on Linux)
+/// @return PID if found, -1 otherwise
+inline pid_t find_process_by_name(const std::string& exe_name) {
+    std::vector<pid_t> pids = ProcessSnapshot::take(ProcessSnapshot::Names).find_by_name(exe_name);
+    return pids.empty() ? static_cast<pid_t>(-1) : pids.front();
+}
+
+/// Find all process IDs by executable name
+/// @param exe_name Name of the executable
+/// @return Vector of PIDs (empty if none found)
+inline std::vector<pid_t> find_all_processes_by_name(const std::string& exe_name) {
+    return ProcessSnapshot::take(ProcessSnapshot::Names).find_by_name(exe_name);
 }
 
 /// Get the parent process ID (PPID) of a given process
 /// @param pid Process ID to query
 /// @return Parent PID if successful, -1 on error
 inline pid_t get_parent_pid(pid_t pid) {
-#ifdef _WIN32
-    HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-    if (hSnapshot == INVALID_HANDLE_VALUE) {
-        return static_cast<pid_t>(-1);
+    ProcessSnapshot::Entry entry;
+    return ProcessSnapshot::read_one(pid, ProcessSnapshot::Parents, entry) ? entry.ppid : static_cast<pid_t>(-1);
+}
+
+#ifndef _WIN32
+/// Get the cgroup v2 filesystem path of a process (Linux only)
+/// @param pid Process ID to query
+/// @return Cgroup path (empty string if not found or on cgroup v1)
+inline std::string get_cgroup_v2_path(pid_t pid) {
+    ProcessSnapshot::Entry entry;
+    return ProcessSnapshot::read_one(pid, ProcessSnapshot::Cgroups, entry) ? entry.cgroup : std::string();
+}
+#endif
+
+/// Latency of the freeze/thaw call itself (NtSuspendProcess, cgroup.freeze write or kill)
+inline metrics::Histogram& syscall_histogram(bool suspend) {
+    static metrics::Histogram& suspend_latency = metrics::get("Suspend syscall");
+    static metrics::Histogram& resume_latency = metrics::get("Resume syscall");
+    return suspend ? suspend_latency : resume_latency;
+}
+
+/// How long suspend/resume_processes_by_name() wait for the kernel to confirm
+/// the new state before returning (0 = return right after the syscall).
+/// The freeze is asynchronous, so with this set a macro's freeze window
+/// starts when the client has actually stopped.
+inline int confirm_timeout_ms = 0;
+
+/// Latency from the freeze/thaw call until the new state was confirmed
+inline metrics::Histogram& confirm_histogram(bool suspend) {
+    static metrics::Histogram& suspend_latency = metrics::get("Suspend confirmed");
+    static metrics::Histogram& resume_latency = metrics::get("Resume confirmed");
+    return suspend ? suspend_latency : resume_latency;
+}
+
+#ifndef _WIN32
+/// Read the "frozen" value of an open cgroup.events file (Linux only)
+/// @return 0 or 1, -1 on error
+inline int read_cgroup_frozen(int fd) {
+    char buffer[256];
+    if (lseek(fd, 0, SEEK_SET) != 0) return -1;
+    ssize_t n = read(fd, buffer, sizeof(buffer) - 1);
+    if (n <= 0) return -1;
+    buffer[n] = '\0';
+
+    const char* frozen = strstr(buffer, "frozen ");
+    return frozen ? frozen[7] - '0' : -1;
+}
+
+/// Wait for a cgroup to report `frozen 1` (or `frozen 0`) in cgroup.events (Linux only).
+/// The kernel signals changes to cgroup.events with POLLPRI, so this sleeps in
+/// epoll instead of re-reading the file.
+/// @return true once the state matches, false on timeout or error
+inline bool wait_cgroup_frozen(const std::string& cgroup_path, bool frozen, int timeout_ms) {
+    int fd = open((cgroup_path + "/cgroup.events").c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+        close(fd);
+        return false;
     }
-    
-    PROCESSENTRY32W pe32;
-    pe32.dwSize = sizeof(PROCESSENTRY32W);
-    
-    pid_t ppid = static_cast<pid_t>(-1);
-    if (Process32FirstW(hSnapshot, &pe32)) {
-        do {
-            if (pe32.th32ProcessID == pid) {
-                ppid = pe32.th32ParentProcessID;
-                break;
-            }
-        } while (Process32NextW(hSnapshot, &pe32));
+    struct epoll_event ev = {};
+    ev.events = EPOLLPRI;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+
+    uint64_t deadline = metrics::now_ns() + static_cast<uint64_t>(timeout_ms) * 1000000;
+    bool reached = false;
+    while (true) {
+        // Reading re-arms the notification, so a change after this read wakes the epoll_wait
+        int state = read_cgroup_frozen(fd);
+        if (state < 0) break;
+        if (state == (frozen ? 1 : 0)) {
+            reached = true;
+            break;
+        }
+        uint64_t now = metrics::now_ns();
+        if (now >= deadline) break;
+        int wait_ms = static_cast<int>((deadline - now + 999999) / 1000000);
+        if (epoll_wait(epfd, &ev, 1, wait_ms) < 0 && errno != EINTR) break;
     }
-    
-    CloseHandle(hSnapshot);
-    return ppid;
-#else
-    std::ifstream stat_file("/proc/" + std::to_string(pid) + "/stat");
-    if (!stat_file) return -1;
-    
-    std::string line;
-    std::getline(stat_file, line);
-    
-    size_t pos = line.rfind(')');
-    if (pos == std::string::npos) return -1;
-    
-    std::istringstream iss(line.substr(pos + 1));
-    char state;
-    pid_t ppid;
-    if (iss >> state >> ppid) {
-        return ppid;
+
+    close(epfd);
+    close(fd);
+    return reached;
+}
+
+/// Check whether every thread of a process is stopped (or none is) (Linux only)
+/// @param stopped true to test for all threads in state T, false for none
+/// @return true if the process matches, false otherwise or if it is gone
+inline bool process_threads_stopped(pid_t pid, bool stopped) {
+    std::string task_dir = "/proc/" + std::to_string(pid) + "/task";
+    DIR* dir = opendir(task_dir.c_str());
+    if (!dir) return false;
+
+    bool matches = true;
+    struct dirent* entry;
+    while (matches && (entry = readdir(dir)) != nullptr) {
+        if (entry->d_name[0] < '0' || entry->d_name[0] > '9') continue;
+
+        std::ifstream stat_file(task_dir + "/" + entry->d_name + "/stat");
+        std::string line;
+        if (!std::getline(stat_file, line)) continue;  // thread exited meanwhile
+        size_t pos = line.rfind(')');
+        if (pos == std::string::npos || pos + 2 >= line.size()) continue;
+
+        char state = line[pos + 2];
+        bool is_stopped = state == 'T' || state == 'Z' || state == 'X';
+        if (is_stopped != stopped) matches = false;
     }
-    
-    return -1;
+
+    closedir(dir);
+    return matches;
+}
 #endif
+
+/// Ways to stop a process on Linux. Which one is cheapest depends on the
+/// setup (native client, Sober in a Flatpak scope, systemd user slices...),
+/// so by default it is measured once per cgroup by calibrate_freeze_method(),
+/// in the background (calibrate_processes_by_name_async()).
+enum class FreezeMethod : int {
+    Auto = 0,           // measured per cgroup
+    CgroupFreeze = 1,   // write cgroup.freeze of the process' cgroup
+    SignalTree = 2,     // SIGSTOP/SIGCONT to the process and every descendant
+    ProcessGroup = 3,   // one SIGSTOP/SIGCONT to the whole process group
+};
+
+inline const char* freeze_method_name(FreezeMethod method) {
+    switch (method) {
+        case FreezeMethod::CgroupFreeze: return "cgroup.freeze";
+        case FreezeMethod::SignalTree:   return "SIGSTOP process tree";
+        case FreezeMethod::ProcessGroup: return "SIGSTOP process group";
+        default:                         return "Auto";
+    }
 }
 
-/// Suspend or resume a process
-/// @param pid Process ID to control
-/// @param suspend true to suspend, false to resume
-/// @return true if successful, false on error
-inline bool set_process_suspended(pid_t pid, bool suspend) {
-    if (!process_exists(pid)) {
-#ifdef _WIN32
-        fprintf(stderr, "[procctrl] PID %lu no longer exists\n", static_cast<unsigned long>(pid));
-#else
-        fprintf(stderr, "[procctrl] PID %d no longer exists\n", static_cast<int>(pid));
-#endif
-        return false;
+/// Forced freeze method (settings override). Falls back to Auto for targets
+/// it can't be used on. Ignored on Windows.
+inline FreezeMethod freeze_method_override = FreezeMethod::Auto;
+
+#ifndef _WIN32
+namespace detail {
+    inline std::mutex freeze_mutex;
+    // Measured method per app cgroup, or per process ("pid:<n>") in shared cgroups
+    inline std::map<std::string, FreezeMethod> freeze_methods;
+    // Method of the currently active suspend, so resume undoes the same thing
+    inline std::map<std::string, FreezeMethod> active_freezes;
+
+    inline std::string freeze_key(pid_t pid, const std::string& cgroup_path) {
+        return uses_cgroup_freeze(cgroup_path) ? cgroup_path : "pid:" + std::to_string(pid);
     }
-    
-#ifdef _WIN32
-    init_nt_functions();
-    
-    if (!g_pfnNtSuspendProcess || !g_pfnNtResumeProcess) {
-        fprintf(stderr, "[procctrl] Failed to load NT functions\n");
-        return false;
+
+    // Process tree per signalled root. Walking /proc costs milliseconds, so
+    // suspends use this copy and refresh it afterwards (see apply()).
+    struct CachedTree {
+        std::vector<pid_t> pids;
+        uint64_t taken_ns;
+    };
+    inline std::map<pid_t, CachedTree> trees;
+    // Override checked per target: {override it was checked for, usable}
+    inline std::map<std::string, std::pair<FreezeMethod, bool>> override_usable;
+
+    // Held exclusively for each freeze/thaw round of a calibration and shared
+    // by real suspends/resumes, so a measurement never thaws a real freeze
+    inline std::shared_mutex calibration_round;
+    inline std::atomic<bool> calibration_running(false);
+    inline std::atomic<bool> calibration_cancelled(false);
+
+    inline std::vector<pid_t> refresh_targets(pid_t pid) {
+        std::vector<pid_t> tree = ProcessSnapshot::take().tree(pid);
+        std::lock_guard<std::mutex> lock(freeze_mutex);
+        trees[pid] = {tree, metrics::now_ns()};
+        return tree;
     }
-    
-    HANDLE hProcess = OpenProcess(PROCESS_SUSPEND_RESUME, FALSE, pid);
-    if (!hProcess) {
-        fprintf(stderr, "[procctrl] Failed to open process %lu: error %lu\n", 
-                static_cast<unsigned long>(pid), GetLastError());
-        return false;
+
+    /// Processes a signal method has to stop: the process tree of pid
+    inline std::vector<pid_t> freeze_targets(pid_t pid) {
+        {
+            std::lock_guard<std::mutex> lock(freeze_mutex);
+            auto it = trees.find(pid);
+            if (it != trees.end()) return it->second.pids;
+        }
+        return refresh_targets(pid);
     }
-    
-    LONG status;
-    if (suspend) {
-        status = g_pfnNtSuspendProcess(hProcess);
-        printf("[procctrl] Suspended PID %lu\n", static_cast<unsigned long>(pid));
-    } else {
-        status = g_pfnNtResumeProcess(hProcess);
-        printf("[procctrl] Resumed PID %lu\n", static_cast<unsigned long>(pid));
+
+    /// Every process a freeze/thaw of pid with this method reaches: the members of
+    /// the cgroup, of the process group or of the process tree
+    inline std::vector<pid_t> reached_by(pid_t pid, FreezeMethod method, const std::string& cgroup_path) {
+        std::vector<pid_t> pids;
+        switch (method) {
+            case FreezeMethod::CgroupFreeze: {
+                std::ifstream procs(cgroup_path + "/cgroup.procs");
+                pid_t member;
+                while (procs >> member) pids.push_back(member);
+                return pids;
+            }
+            case FreezeMethod::ProcessGroup: {
+                pid_t pgid = getpgid(pid);
+                if (pgid <= 1) return pids;
+                ProcessSnapshot snapshot = ProcessSnapshot::take();
+                for (const auto& entry : snapshot.entries()) {
+                    if (entry.pgid == pgid) pids.push_back(entry.pid);
+                }
+                return pids;
+            }
+            default:
+                return freeze_targets(pid);
+        }
     }
-    
-    CloseHandle(hProcess);
-    return status == 0;
-#else
+
+    inline bool can_use(pid_t pid, FreezeMethod method, const std::string& cgroup_path) {
+        switch (method) {
+            case FreezeMethod::CgroupFreeze: {
+                // Never freeze a cgroup shared with us or one that doesn't hold the whole tree
+                if (cgroup_path.empty() || cgroup_path == "/sys/fs/cgroup/" || !is_cgroup_v2_available()) return false;
+                if (cgroup_path == get_cgroup_v2_path(getpid())) return false;
+                if (access((cgroup_path + "/cgroup.freeze").c_str(), W_OK) != 0) return false;
+                for (pid_t member : freeze_targets(pid)) {
+                    if (get_cgroup_v2_path(member) != cgroup_path) return false;
+                }
+                return true;
+            }
+            case FreezeMethod::ProcessGroup: {
+                // The group must only contain the tree (or processes of the same app cgroup)
+                ProcessSnapshot snapshot = ProcessSnapshot::take();
+                const ProcessSnapshot::Entry* entry = snapshot.find(pid);
+                if (!entry || entry->pgid <= 1 || entry->pgid == getpgrp()) return false;
+                std::vector<pid_t> tree = snapshot.tree(pid);
+                for (const auto& other : snapshot.entries()) {
+                    if (other.pgid != entry->pgid) continue;
+                    if (std::find(tree.begin(), tree.end(), other.pid) != tree.end()) continue;
+                    if (!uses_cgroup_freeze(cgroup_path) || get_cgroup_v2_path(other.pid) != cgroup_path) return false;
+                }
+                return true;
+            }
+            case FreezeMethod::SignalTree:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    inline bool apply(pid_t pid, FreezeMethod method, bool suspend, const std::string& cgroup_path) {
+        int signal_to_send = suspend ? SIGSTOP : SIGCONT;
+        const char* action_signal = suspend ? "SIGSTOP" : "SIGCONT";
+
+        switch (method) {
+            case FreezeMethod::CgroupFreeze: {
+                std::string freeze_file_path = cgroup_path + "/cgroup.freeze";
+                TRACE_SCOPE("procctrl", "syscall");
+                metrics::ScopedTimer syscall_timer(syscall_histogram(suspend));
+                std::ofstream freeze_file(freeze_file_path);
+
+                if (freeze_file) {
+                    freeze_file << (suspend ? "1" : "0");
+                    freeze_file.flush();
+                    if (freeze_file.fail()) {
+                        asynclog::write(asynclog::Level::Error, "[procctrl] Failed to write to %s: %s",
+                                freeze_file_path.c_str(), strerror(errno));
+                        return false;
+                    }
+                    return true;
+                } else {
+                    asynclog::write(asynclog::Level::Error, "[procctrl] Failed to open %s: %s",
+                            freeze_file_path.c_str(), strerror(errno));
+                    return false;
+                }
+            }
+            case FreezeMethod::ProcessGroup: {
+                pid_t pgid = getpgid(pid);
+                TRACE_SCOPE("procctrl", "syscall");
+                metrics::ScopedTimer syscall_timer(syscall_histogram(suspend));
+                if (pgid <= 1 || kill(-pgid, signal_to_send) != 0) {
+                    asynclog::write(asynclog::Level::Error, "[procctrl] Error sending %s to group %d: %s",
+                            action_signal, static_cast<int>(pgid), strerror(errno));
+                    return false;
+                }
+                return true;
+            }
+            default: {
+                std::vector<pid_t> targets = freeze_targets(pid);
+                bool success = true;
+                {
+                    TRACE_SCOPE("procctrl", "syscall");
+                    metrics::ScopedTimer syscall_timer(syscall_histogram(suspend));
+                    for (pid_t target : targets) {
+                        if (kill(target, signal_to_send) != 0 && errno != ESRCH) {
+                            asynclog::write(asynclog::Level::Error, "[procctrl] Error sending %s to PID %d: %s",
+                                    action_signal, static_cast<int>(target), strerror(errno));
+                            success = false;
+                        }
+                    }
+                }
+
+                // A stopped tree can't fork, so walking it now is exact for the resume.
+                // Children that appeared since the last walk are stopped here, a bit late.
+                uint64_t age_ns;
+                {
+                    std::lock_guard<std::mutex> lock(freeze_mutex);
+                    age_ns = metrics::now_ns() - trees[pid].taken_ns;
+                }
+                if (suspend && age_ns > 1000000000ULL) {
+                    for (pid_t target : refresh_targets(pid)) {
+                        if (std::find(targets.begin(), targets.end(), target) == targets.end()) {
+                            kill(target, signal_to_send);
+                        }
+                    }
+                }
+                return success;
+            }
+        }
+    }
+
+    /// Wait until every thread the method targets has (un)stopped
+    inline bool confirmed(pid_t pid, FreezeMethod method, bool suspend, const std::string& cgroup_path, int timeout_ms) {
+        if (method == FreezeMethod::CgroupFreeze) {
+            return wait_cgroup_frozen(cgroup_path, suspend, timeout_ms);
+        }
+
+        std::vector<pid_t> targets = freeze_targets(pid);
+        uint64_t deadline = metrics::now_ns() + static_cast<uint64_t>(timeout_ms) * 1000000;
+        for (pid_t target : targets) {
+            while (!process_threads_stopped(target, suspend)) {
+                if (!process_exists(target)) break;
+                if (metrics::now_ns() >= deadline) return false;
+                usleep(50);
+            }
+        }
+        return true;
+    }
+
+    inline bool cgroup_frozen(const std::string& cgroup_path) {
+        int fd = open((cgroup_path + "/cgroup.events").c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        bool frozen = read_cgroup_frozen(fd) == 1;
+        close(fd);
+        return frozen;
+    }
+
+    /// Method used before calibration existed
+    inline FreezeMethod heuristic(const std::string& cgroup_path) {
+        return uses_cgroup_freeze(cgroup_path) ? FreezeMethod::CgroupFreeze : FreezeMethod::SignalTree;
+    }
+} // namespace detail
+
+/// Measure every usable freeze method on a running process and cache the fastest one
+/// that stops all of its threads (Linux only). Each method is tried a few times, so the
+/// process is briefly frozen and thawed during the measurement. Takes up to a second:
+/// run it on a worker (calibrate_processes_by_name_async()), never on a macro thread.
+/// A suspend of the process meanwhile waits for the current round at most and then
+/// stops the measurement, which is not cached then.
+/// @param pid Process to measure on (must not be suspended)
+/// @return Chosen method
+inline FreezeMethod calibrate_freeze_method(pid_t pid) {
+    static const int ROUNDS = 3;
+    static const int TIMEOUT_MS = 100;
+    static const FreezeMethod candidates[] = {
+        FreezeMethod::CgroupFreeze, FreezeMethod::ProcessGroup, FreezeMethod::SignalTree
+    };
+    TRACE_SCOPE("procctrl", "calibrate");
+
     std::string cgroup_path = get_cgroup_v2_path(pid);
-    const char* action_signal = suspend ? "SIGSTOP" : "SIGCONT";
-    const char* action_cgroup = suspend ? "Freezing" : "Thawing";
-    int signal_to_send = suspend ? SIGSTOP : SIGCONT;
+    std::string key = detail::freeze_key(pid, cgroup_path);
+    detail::refresh_targets(pid);
 
-    bool is_sandboxed_app = !cgroup_path.empty() &&
-                            (cgroup_path.find("app-") != std::string::npos ||
-                             cgroup_path.find("snap.") != std::string::npos);
+    // Already stopped by someone else: measuring would thaw it
+    if (process_threads_stopped(pid, true) ||
+        (!cgroup_path.empty() && detail::cgroup_frozen(cgroup_path))) {
+        return detail::heuristic(cgroup_path);
+    }
 
-    if (is_sandboxed_app && is_cgroup_v2_available()) {
-        printf("[procctrl] PID %d belongs to sandboxed app. %s cgroup: %s\n",
-               static_cast<int>(pid), action_cgroup, cgroup_path.c_str());
-        
-        std::string freeze_file_path = cgroup_path + "/cgroup.freeze";
-        std::ofstream freeze_file(freeze_file_path);
-        
-        if (freeze_file) {
-            freeze_file << (suspend ? "1" : "0");
-            if (freeze_file.fail()) {
-                fprintf(stderr, "[procctrl] Failed to write to %s: %s\n",
-                        freeze_file_path.c_str(), strerror(errno));
-                return false;
+    FreezeMethod best = FreezeMethod::Auto;
+    uint64_t best_ns = UINT64_MAX;
+    bool interrupted = false;
+    for (FreezeMethod method : candidates) {
+        if (interrupted) break;
+        if (!detail::can_use(pid, method, cgroup_path)) continue;
+
+        uint64_t fastest_ns = UINT64_MAX;
+        for (int round = 0; round < ROUNDS; ++round) {
+            std::unique_lock<std::shared_mutex> round_lock(detail::calibration_round);
+            {
+                std::lock_guard<std::mutex> lock(detail::freeze_mutex);
+                interrupted = detail::calibration_cancelled || detail::active_freezes.count(key) != 0;
             }
-            return true;
-        } else {
-            fprintf(stderr, "[procctrl] Failed to open %s: %s\n",
-                    freeze_file_path.c_str(), strerror(errno));
-            return false;
+            if (interrupted) break;
+
+            uint64_t start_ns = metrics::now_ns();
+            bool stopped = detail::apply(pid, method, true, cgroup_path) &&
+                           detail::confirmed(pid, method, true, cgroup_path, TIMEOUT_MS);
+            uint64_t elapsed_ns = metrics::now_ns() - start_ns;
+
+            detail::apply(pid, method, false, cgroup_path);
+            bool running = detail::confirmed(pid, method, false, cgroup_path, TIMEOUT_MS);
+            if (!stopped || !running) {
+                fastest_ns = UINT64_MAX;
+                break;
+            }
+            fastest_ns = std::min(fastest_ns, elapsed_ns);
+        }
+
+        if (interrupted) break;
+        asynclog::write(asynclog::Level::Debug, "[procctrl] %s on %s: %s",
+                freeze_method_name(method), key.c_str(),
+                fastest_ns == UINT64_MAX ? "incomplete" : (std::to_string(fastest_ns / 1000) + " us").c_str());
+        if (fastest_ns < best_ns) {
+            best = method;
+            best_ns = fastest_ns;
         }
+    }
+
+    if (interrupted) {
+        asynclog::write(asynclog::Level::Debug, "[procctrl] Measuring %s interrupted, not cached", key.c_str());
+        return detail::heuristic(cgroup_path);
+    }
+    if (best == FreezeMethod::Auto) {
+        best = detail::heuristic(cgroup_path);
+        asynclog::write(asynclog::Level::Warn, "[procctrl] No freeze method fully stopped %s, using %s",
+                key.c_str(), freeze_method_name(best));
     } else {
-        printf("[procctrl] PID %d not sandboxed. Sending %s.\n",
-               static_cast<int>(pid), action_signal);
-        
-        if (kill(pid, signal_to_send) != 0) {
-            fprintf(stderr, "[procctrl] Error sending %s to PID %d: %s\n",
-                    action_signal, static_cast<int>(pid), strerror(errno));
-            return false;
+        asynclog::write(asynclog::Level::Info, "[procctrl] Freeze method for %s: %s (%.2f ms)",
+                key.c_str(), freeze_method_name(best), best_ns / 1e6);
+    }
+
+    std::lock_guard<std::mutex> lock(detail::freeze_mutex);
+    detail::freeze_methods[key] = best;
+    return best;
+}
+
+/// Freeze method for a process: the override if it applies, otherwise the
+/// cached measurement, or the heuristic until one exists (Linux only).
+/// Never measures; that is left to calibrate_processes_by_name_async().
+inline FreezeMethod freeze_method_for(pid_t pid, const std::string& cgroup_path) {
+    std::string key = detail::freeze_key(pid, cgroup_path);
+    FreezeMethod forced = freeze_method_override;
+    if (forced != FreezeMethod::Auto) {
+        std::unique_lock<std::mutex> lock(detail::freeze_mutex);
+        auto checked = detail::override_usable.find(key);
+        if (checked == detail::override_usable.end() || checked->second.first != forced) {
+            lock.unlock();
+            bool usable = detail::can_use(pid, forced, cgroup_path);
+            lock.lock();
+            checked = detail::override_usable.insert_or_assign(key, std::make_pair(forced, usable)).first;
         }
-        return true;
+        if (checked->second.second) return forced;
     }
-#endif
+    {
+        std::lock_guard<std::mutex> lock(detail::freeze_mutex);
+        auto it = detail::freeze_methods.find(key);
+        if (it != detail::freeze_methods.end()) return it->second;
+    }
+    return detail::heuristic(cgroup_path);
 }
 
-/// Suspend all processes by executable name (each cgroup only once on Linux)
-/// @param exe_name Name of the executable
-/// @return Number of processes/cgroups successfully suspended
-inline int suspend_processes_by_name(const std::string& exe_name) {
-#ifdef _WIN32
-    int success_count = 0;
+/// Like freeze_method_for(), but a resume uses whatever the matching suspend
+/// used, even if the choice changed since (Linux only)
+inline FreezeMethod freeze_method_in_use(pid_t pid, const std::string& cgroup_path, bool suspend) {
+    if (!suspend) {
+        std::lock_guard<std::mutex> lock(detail::freeze_mutex);
+        auto active = detail::active_freezes.find(detail::freeze_key(pid, cgroup_path));
+        if (active != detail::active_freezes.end()) return active->second;
+    }
+    return freeze_method_for(pid, cgroup_path);
+}
+
+/// Measured methods by cgroup, e.g. for display (Linux only)
+inline std::map<std::string, FreezeMethod> cached_freeze_methods() {
+    std::lock_guard<std::mutex> lock(detail::freeze_mutex);
+    return detail::freeze_methods;
+}
+
+/// Forget all measurements; the next suspend measures again (Linux only)
+inline void clear_freeze_methods() {
+    std::lock_guard<std::mutex> lock(detail::freeze_mutex);
+    detail::freeze_methods.clear();
+    detail::override_usable.clear();
+    detail::trees.clear();
+}
+
+/// Measure the methods for all processes with this name that aren't cached yet (Linux only)
+/// @return Number of processes measured
+inline int calibrate_processes_by_name(const std::string& exe_name) {
+    int measured = 0;
     for (auto pid : find_all_processes_by_name(exe_name)) {
-        if (set_process_suspended(pid, true)) {
-            success_count++;
+        if (detail::calibration_cancelled) break;
+        std::string key = detail::freeze_key(pid, get_cgroup_v2_path(pid));
+        {
+            std::lock_guard<std::mutex> lock(detail::freeze_mutex);
+            if (detail::freeze_methods.count(key)) continue;
         }
+        calibrate_freeze_method(pid);
+        measured++;
     }
-    return success_count;
+    return measured;
+}
+
+/// calibrate_processes_by_name() on a worker thread, one at a time (Linux only).
+/// Suspends meanwhile use the cached method or the heuristic.
+/// @return false if a calibration is still running
+inline bool calibrate_processes_by_name_async(const std::string& exe_name) {
+    if (detail::calibration_running.exchange(true)) return false;
+    detail::calibration_cancelled = false;
+    std::thread([exe_name]() {
+        calibrate_processes_by_name(exe_name);
+        detail::calibration_running = false;
+    }).detach();
+    return true;
+}
+
+/// Stop a background calibration after its current round and wait for it,
+/// so nothing is left frozen at exit (Linux only)
+inline void stop_calibration() {
+    detail::calibration_cancelled = true;
+    while (detail::calibration_running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+#endif
+
+namespace detail {
+    /// A process to suspend or resume, with its cgroup and freeze method
+    /// looked up once per call (both Linux only)
+    struct FreezeTarget {
+        pid_t pid = 0;
+        std::string cgroup_path;
+        FreezeMethod method = FreezeMethod::Auto;
+    };
+
+    /// Look up everything a suspend/resume of pid needs
+    /// @return false if the process no longer exists
+    inline bool resolve(pid_t pid, bool suspend, FreezeTarget& target) {
+        target.pid = pid;
+#ifdef _WIN32
+        (void)suspend;
+        if (process_exists(pid)) return true;
+        asynclog::write(asynclog::Level::Error, "[procctrl] PID %lu no longer exists", static_cast<unsigned long>(pid));
+        return false;
 #else
-    std::unordered_set<std::string> handled_cgroups;
-    int success_count = 0;
-    
-    for (auto pid : find_all_processes_by_name(exe_name)) {
-        std::string cgroup_path = get_cgroup_v2_path(pid);
-        if (!cgroup_path.empty()) {
-            if (handled_cgroups.count(cgroup_path)) continue;
-            handled_cgroups.insert(cgroup_path);
+        ProcessSnapshot::Entry entry;
+        if (!ProcessSnapshot::read_one(pid, ProcessSnapshot::Cgroups, entry)) {
+            asynclog::write(asynclog::Level::Error, "[procctrl] PID %d no longer exists", static_cast<int>(pid));
+            return false;
+        }
+        target.cgroup_path = std::move(entry.cgroup);
+        target.method = freeze_method_in_use(pid, target.cgroup_path, suspend);
+        return true;
+#endif
+    }
+
+    /// Suspend or resume a resolved target, nothing looked up again
+    inline bool set_target_suspended(const FreezeTarget& target, bool suspend) {
+#ifdef _WIN32
+        pid_t pid = target.pid;
+        init_nt_functions();
+        
+        if (!g_pfnNtSuspendProcess || !g_pfnNtResumeProcess) {
+            asynclog::write(asynclog::Level::Error, "[procctrl] Failed to load NT functions");
+            return false;
         }
         
-        if (set_process_suspended(pid, true)) {
-            success_count++;
+        HANDLE hProcess = OpenProcess(PROCESS_SUSPEND_RESUME, FALSE, pid);
+        if (!hProcess) {
+            asynclog::write(asynclog::Level::Error, "[procctrl] Failed to open process %lu: error %lu", 
+                    static_cast<unsigned long>(pid), GetLastError());
+            return false;
         }
-    }
-    
-    return success_count;
+        
+        LONG status;
+        TRACE_SCOPE("procctrl", "syscall");
+        metrics::ScopedTimer syscall_timer(syscall_histogram(suspend));
+        if (suspend) {
+            status = g_pfnNtSuspendProcess(hProcess);
+            asynclog::write(asynclog::Level::Debug, "[procctrl] Suspended PID %lu", static_cast<unsigned long>(pid));
+        } else {
+            status = g_pfnNtResumeProcess(hProcess);
+            asynclog::write(asynclog::Level::Debug, "[procctrl] Resumed PID %lu", static_cast<unsigned long>(pid));
+        }
+        
+        CloseHandle(hProcess);
+        return status == 0;
+#else
+        std::string key = freeze_key(target.pid, target.cgroup_path);
+
+        asynclog::write(asynclog::Level::Debug, "[procctrl] %s PID %d with %s (cgroup: %s)",
+               suspend ? "Suspending" : "Resuming", static_cast<int>(target.pid), freeze_method_name(target.method),
+               target.cgroup_path.empty() ? "none" : target.cgroup_path.c_str());
+
+        std::shared_lock<std::shared_mutex> round_lock(calibration_round);
+        bool success = apply(target.pid, target.method, suspend, target.cgroup_path);
+        std::lock_guard<std::mutex> lock(freeze_mutex);
+        if (suspend && success) {
+            active_freezes[key] = target.method;
+        } else if (!suspend) {
+            active_freezes.erase(key);
+        }
+        return success;
 #endif
-}
+    }
 
-/// Resume all processes by executable name (each cgroup only once on Linux)
-/// @param exe_name Name of the executable
-/// @return Number of processes/cgroups successfully resumed
-inline int resume_processes_by_name(const std::string& exe_name) {
+    /// Wait for all targets of a suspend/resume batch and record the confirmed latency
+    /// @param start_ns metrics::now_ns() taken before the first freeze/thaw call
+    inline void confirm_targets(const std::vector<FreezeTarget>& targets, bool suspend, uint64_t start_ns) {
+        if (confirm_timeout_ms <= 0 || targets.empty()) return;
+        TRACE_SCOPE("procctrl", "confirm");
+
+        bool all_confirmed = true;
+        for (const FreezeTarget& target : targets) {
+            uint64_t elapsed_ms = (metrics::now_ns() - start_ns) / 1000000;
+            int remaining_ms = confirm_timeout_ms > static_cast<int>(elapsed_ms)
+                                   ? confirm_timeout_ms - static_cast<int>(elapsed_ms) : 0;
 #ifdef _WIN32
-    int success_count = 0;
-    for (auto pid : find_all_processes_by_name(exe_name)) {
-        if (set_process_suspended(pid, false)) {
-            success_count++;
+            // NtSuspendProcess has already suspended every thread when it returns
+            (void)remaining_ms;
+            if (!process_exists(target.pid)) all_confirmed = false;
+#else
+            if (!confirmed(target.pid, target.method, suspend, target.cgroup_path, remaining_ms)) all_confirmed = false;
+#endif
+        }
+
+        uint64_t latency_ns = metrics::now_ns() - start_ns;
+        if (all_confirmed) {
+            confirm_histogram(suspend).record(latency_ns);
+            asynclog::write(asynclog::Level::Debug, "[procctrl] %s confirmed after %.2f ms",
+                            suspend ? "Suspend" : "Resume", latency_ns / 1e6);
+        } else {
+            asynclog::write(asynclog::Level::Warn, "[procctrl] %s not confirmed within %d ms",
+                            suspend ? "Suspend" : "Resume", confirm_timeout_ms);
         }
     }
-    return success_count;
+
+    /// set_processes_suspended() on resolved targets
+    inline int set_targets_suspended(const std::vector<FreezeTarget>& targets, bool suspend) {
+        TRACE_SCOPE("procctrl", "control");
+        uint64_t start_ns = metrics::now_ns();
+
+        std::vector<char> succeeded(targets.size(), 0);
+        std::vector<size_t> inline_targets;
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < targets.size(); ++i) {
+#ifdef _WIN32
+            bool slow = true;
 #else
-    std::unordered_set<std::string> handled_cgroups;
-    int success_count = 0;
-    
-    for (auto pid : find_all_processes_by_name(exe_name)) {
-        std::string cgroup_path = get_cgroup_v2_path(pid);
-        if (!cgroup_path.empty()) {
-            if (handled_cgroups.count(cgroup_path)) continue;
-            handled_cgroups.insert(cgroup_path);
+            bool slow = targets[i].method == FreezeMethod::CgroupFreeze;
+#endif
+            if (i == 0 || !slow) {
+                inline_targets.push_back(i);
+                continue;
+            }
+            workers.emplace_back([&targets, &succeeded, i, suspend]() {
+                succeeded[i] = set_target_suspended(targets[i], suspend);
+            });
         }
-        
-        if (set_process_suspended(pid, false)) {
-            success_count++;
+        for (size_t i : inline_targets) {
+            succeeded[i] = set_target_suspended(targets[i], suspend);
+        }
+        for (auto& worker : workers) worker.join();
+
+        std::vector<FreezeTarget> changed;
+        for (size_t i = 0; i < targets.size(); ++i) {
+            if (succeeded[i]) changed.push_back(targets[i]);
         }
+        confirm_targets(changed, suspend, start_ns);
+        return static_cast<int>(changed.size());
     }
-    
-    return success_count;
+
+    /// Every process with this name, resolved in the scan (each frozen cgroup only once on Linux)
+    inline std::vector<FreezeTarget> targets_by_name(const std::string& exe_name, bool suspend) {
+        TRACE_SCOPE("procctrl", "scan");
+        std::vector<FreezeTarget> targets;
+#ifndef _WIN32
+        std::unordered_set<std::string> handled_cgroups;
+#endif
+        for (auto pid : find_all_processes_by_name(exe_name)) {
+            FreezeTarget target;
+            if (!resolve(pid, suspend, target)) continue;
+#ifndef _WIN32
+            // One cgroup.freeze write covers every process in the cgroup
+            if (target.method == FreezeMethod::CgroupFreeze && !handled_cgroups.insert(target.cgroup_path).second) continue;
+#endif
+            targets.push_back(std::move(target));
+        }
+        return targets;
+    }
+} // namespace detail
+
+/// Suspend or resume a process
+/// @param pid Process ID to control
+/// @param suspend true to suspend, false to resume
+/// @return true if successful, false on error
+inline bool set_process_suspended(pid_t pid, bool suspend) {
+    detail::FreezeTarget target;
+    return detail::resolve(pid, suspend, target) && detail::set_target_suspended(target, suspend);
+}
+
+/// Wait until a process that was just suspended/resumed has really stopped or runs again.
+/// Linux: epoll on cgroup.events for cgroup freezes, /proc/<pid>/task/<tid>/stat of the whole tree for signals.
+/// Windows: NtSuspendProcess has already suspended every thread when it returns.
+/// @param pid Process ID passed to set_process_suspended()
+/// @param suspend State to wait for
+/// @param timeout_ms Give up after this long
+/// @return true if the state was confirmed within the timeout
+inline bool wait_for_suspend_state(pid_t pid, bool suspend, int timeout_ms) {
+#ifdef _WIN32
+    (void)suspend;
+    (void)timeout_ms;
+    return process_exists(pid);
+#else
+    std::string cgroup_path = get_cgroup_v2_path(pid);
+    return detail::confirmed(pid, freeze_method_for(pid, cgroup_path), suspend, cgroup_path, timeout_ms);
 #endif
 }
 
+/// Suspend or resume several processes at once, e.g. one per client instance.
+/// Cgroup and freeze method are looked up once per process. Slow freezes
+/// (cgroup.freeze writes, NtSuspendProcess) after the first run on their own
+/// threads, so they overlap instead of adding up. Signals are sent from the
+/// calling thread: a kill() is cheaper than starting a thread.
+/// Waits for all targets with confirm_timeout_ms.
+/// @param pids Processes to control (one per cgroup for cgroup-frozen apps)
+/// @param suspend true to suspend, false to resume
+/// @return Number of processes successfully suspended/resumed
+inline int set_processes_suspended(const std::vector<pid_t>& pids, bool suspend) {
+    std::vector<detail::FreezeTarget> targets;
+    targets.reserve(pids.size());
+    for (auto pid : pids) {
+        detail::FreezeTarget target;
+        if (detail::resolve(pid, suspend, target)) targets.push_back(std::move(target));
+    }
+    return detail::set_targets_suspended(targets, suspend);
+}
+
+/// Suspend all processes by executable name (each frozen cgroup only once on Linux)
+/// @param exe_name Name of the executable
+/// @return Number of processes/cgroups successfully suspended
+inline int suspend_processes_by_name(const std::string& exe_name) {
+    TRACE_SCOPE("procctrl", "suspend");
+    // Scan first so a trace separates /proc walking from the freeze itself
+    return detail::set_targets_suspended(detail::targets_by_name(exe_name, true), true);
+}
+
+/// Resume all processes by executable name (each frozen cgroup only once on Linux)
+/// @param exe_name Name of the executable
+/// @return Number of processes/cgroups successfully resumed
+inline int resume_processes_by_name(const std::string& exe_name) {
+    TRACE_SCOPE("procctrl", "resume");
+    return detail::set_targets_suspended(detail::targets_by_name(exe_name, false), false);
+}
+
 /// Get all PIDs in a process tree (parent and all descendants)
 /// @param root_pid Root process ID
 /// @return Vector of all PIDs in the tree including root_pid
 inline std::vector<pid_t> get_process_tree(pid_t root_pid) {
-    std::vector<pid_t> tree = {root_pid};
-    std::vector<pid_t> to_check = {root_pid};
-    
-    while (!to_check.empty()) {
-        pid_t current = to_check.back();
-        to_check.pop_back();
-        
+    return ProcessSnapshot::take().tree(root_pid);
+}
+
+/// Number of logical CPUs
+inline int cpu_count() {
+    unsigned int count = std::thread::hardware_concurrency();
+    return count > 0 ? static_cast<int>(count) : 1;
+}
+
+#ifndef _WIN32
+/// Thread IDs of a process (Linux only)
+/// @param pid Process ID
+/// @return TIDs from /proc/<pid>/task (empty if the process is gone)
+inline std::vector<pid_t> get_thread_ids(pid_t pid) {
+    std::vector<pid_t> tids;
+    DIR* dir = opendir(("/proc/" + std::to_string(pid) + "/task").c_str());
+    if (!dir) return tids;
+    while (struct dirent* entry = readdir(dir)) {
+        char* endptr;
+        pid_t tid = strtol(entry->d_name, &endptr, 10);
+        if (*endptr == '\0' && endptr != entry->d_name) tids.push_back(tid);
+    }
+    closedir(dir);
+    return tids;
+}
+#endif
+
+/// Restrict a process to a set of CPUs. On Linux the mask is set on every
+/// thread, since affinity is per thread there; new threads inherit it.
+/// @param pid Process ID
+/// @param cpu_mask Bit n = CPU n (first 64 CPUs)
+/// @return true if every thread was updated
+inline bool set_process_affinity(pid_t pid, uint64_t cpu_mask) {
 #ifdef _WIN32
-        HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-        if (hSnapshot == INVALID_HANDLE_VALUE) continue;
-        
-        PROCESSENTRY32W pe32;
-        pe32.dwSize = sizeof(PROCESSENTRY32W);
-        
-        if (Process32FirstW(hSnapshot, &pe32)) {
-            do {
-                if (pe32.th32ParentProcessID == current) {
-                    tree.push_back(pe32.th32ProcessID);
-                    to_check.push_back(pe32.th32ProcessID);
-                }
-            } while (Process32NextW(hSnapshot, &pe32));
+    HANDLE hProcess = OpenProcess(PROCESS_SET_INFORMATION, FALSE, pid);
+    if (!hProcess) return false;
+    bool success = SetProcessAffinityMask(hProcess, static_cast<DWORD_PTR>(cpu_mask)) != 0;
+    CloseHandle(hProcess);
+    return success;
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu = 0; cpu < 64 && cpu < CPU_SETSIZE; ++cpu) {
+        if (cpu_mask & (1ULL << cpu)) CPU_SET(cpu, &set);
+    }
+
+    bool success = true;
+    for (pid_t tid : get_thread_ids(pid)) {
+        if (sched_setaffinity(tid, sizeof(set), &set) != 0 && errno != ESRCH) {
+            asynclog::write(asynclog::Level::Warn, "[procctrl] Failed to set affinity of TID %d: %s",
+                    static_cast<int>(tid), strerror(errno));
+            success = false;
         }
-        
-        CloseHandle(hSnapshot);
+    }
+    return success;
+#endif
+}
+
+/// Set the scheduling priority of a process and all its threads
+/// @param pid Process ID
+/// @param nice -20 (highest) to 19 (lowest). Windows maps it to a priority class.
+/// @return true if successful
+inline bool set_process_nice(pid_t pid, int nice) {
+#ifdef _WIN32
+    DWORD priority_class = nice <= -10 ? HIGH_PRIORITY_CLASS
+                         : nice < 0    ? ABOVE_NORMAL_PRIORITY_CLASS
+                         : nice == 0   ? NORMAL_PRIORITY_CLASS
+                         : nice < 10   ? BELOW_NORMAL_PRIORITY_CLASS
+                                       : IDLE_PRIORITY_CLASS;
+    HANDLE hProcess = OpenProcess(PROCESS_SET_INFORMATION, FALSE, pid);
+    if (!hProcess) return false;
+    bool success = SetPriorityClass(hProcess, priority_class) != 0;
+    CloseHandle(hProcess);
+    return success;
 #else
-        DIR* proc_dir = opendir("/proc");
-        if (!proc_dir) continue;
-        
-        struct dirent* entry;
-        while ((entry = readdir(proc_dir)) != nullptr) {
-            // Skip non-directories
-            if (entry->d_type != DT_UNKNOWN && entry->d_type != DT_DIR) continue;
-            
-            char* endptr;
-            pid_t pid = strtol(entry->d_name, &endptr, 10);
-            if (*endptr != '\0') continue;
-            
-            if (get_parent_pid(pid) == current) {
-                tree.push_back(pid);
-                to_check.push_back(pid);
-            }
+    bool success = true;
+    for (pid_t tid : get_thread_ids(pid)) {
+        if (setpriority(PRIO_PROCESS, static_cast<id_t>(tid), nice) != 0 && errno != ESRCH) {
+            asynclog::write(asynclog::Level::Warn, "[procctrl] Failed to set nice of TID %d: %s",
+                    static_cast<int>(tid), strerror(errno));
+            success = false;
         }
-        closedir(proc_dir);
+    }
+    return success;
+#endif
+}
+
+/// Set the I/O scheduling class of a process and all its threads (Linux only)
+/// @param pid Process ID
+/// @param io_class 1 = realtime, 2 = best-effort, 3 = idle
+/// @param level 0 (highest) to 7 (lowest), ignored for idle
+/// @return true if successful (always false on Windows)
+inline bool set_process_io_priority(pid_t pid, int io_class, int level) {
+#ifdef _WIN32
+    (void)pid;
+    (void)io_class;
+    (void)level;
+    return false;
+#else
+    // IOPRIO_PRIO_VALUE(class, data) and IOPRIO_WHO_PROCESS from linux/ioprio.h
+    int value = (io_class << 13) | (level & 7);
+    bool success = true;
+    for (pid_t tid : get_thread_ids(pid)) {
+        if (syscall(SYS_ioprio_set, 1, static_cast<int>(tid), value) != 0 && errno != ESRCH) {
+            asynclog::write(asynclog::Level::Warn, "[procctrl] Failed to set I/O priority of TID %d: %s",
+                    static_cast<int>(tid), strerror(errno));
+            success = false;
+        }
+    }
+    return success;
 #endif
+}
+
+#ifndef _WIN32
+/// Write a cgroup v2 interface file, e.g. cpu.weight or cpu.max (Linux only)
+/// @param cgroup_path Path returned by get_cgroup_v2_path()
+/// @param file Interface file name
+/// @param value Value to write
+/// @return true if successful (fails if the controller isn't enabled for the cgroup)
+inline bool write_cgroup_value(const std::string& cgroup_path, const char* file, const std::string& value) {
+    std::string path = cgroup_path + "/" + file;
+    int fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        asynclog::write(asynclog::Level::Warn, "[procctrl] Failed to open %s: %s", path.c_str(), strerror(errno));
+        return false;
     }
-    
-    return tree;
+    bool success = write(fd, value.data(), value.size()) == static_cast<ssize_t>(value.size());
+    if (!success) {
+        asynclog::write(asynclog::Level::Warn, "[procctrl] Failed to write \"%s\" to %s: %s",
+                value.c_str(), path.c_str(), strerror(errno));
+    }
+    close(fd);
+    return success;
 }
+#endif
 
 } // namespace procctrl
\ No newline at end of file
@@ -0,0 +1,252 @@
+/*
+===============================================================================
+trace - Scoped trace spans and instant events (Header-Only)
+===============================================================================
+
+A small in-memory tracer producing Chrome trace-event JSON, which can be
+opened in chrome://tracing, Perfetto (ui.perfetto.dev) or Speedscope.
+
+Everything is compiled out unless HYPERSUITE_TRACE is defined (`make trace`),
+so the TRACE_* macros cost nothing in normal builds.
+
+Features:
+- TRACE_SCOPE(cat, name): complete event covering the enclosing scope
+- TRACE_INSTANT(cat, name): zero-length marker
+- TRACE_COMPLETE(...): span with explicit start/duration and two int args
+- Lock-free append into a preallocated buffer; recording stops when it is full
+- Per-thread ids with optional names (TRACE_THREAD_NAME)
+
+Names and categories must be string literals (only the pointers are stored).
+
+Usage example:
+(C++)
+
+----------------------------------------------------------------------
+#include "trace.hpp"
+
+void work() {
+    TRACE_SCOPE("app", "work");
+    TRACE_INSTANT("app", "checkpoint");
+}
+
+int main() {
+    trace::start();
+    work();
+    trace::stop();
+    trace::write_json("session.json");
+}
+----------------------------------------------------------------------
+
+===============================================================================
+*/
+
+#pragma once
+#include <cstdint>
+#include <string>
+
+#ifdef HYPERSUITE_TRACE
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace trace {
+
+struct Event {
+    const char* cat;
+    const char* name;
+    char phase;                 // 'X' complete, 'i' instant
+    uint32_t tid;
+    uint64_t ts_us;
+    uint64_t dur_us;
+    const char* arg_names[2];
+    int64_t arg_values[2];
+    std::atomic<bool> committed{false};
+};
+
+constexpr size_t CAPACITY = 1 << 17;
+
+namespace detail {
+
+struct Buffer {
+    std::unique_ptr<Event[]> events{new Event[CAPACITY]};
+    std::atomic<size_t> count{0};
+    std::atomic<bool> recording{false};
+    std::atomic<uint32_t> next_tid{1};
+
+    std::mutex names_mutex;
+    std::vector<std::pair<uint32_t, std::string>> thread_names;
+};
+
+inline Buffer& buffer() {
+    static Buffer b;
+    return b;
+}
+
+} // namespace detail
+
+inline uint64_t now_us() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline uint32_t thread_id() {
+    thread_local uint32_t tid = detail::buffer().next_tid.fetch_add(1, std::memory_order_relaxed);
+    return tid;
+}
+
+inline bool recording() {
+    return detail::buffer().recording.load(std::memory_order_relaxed);
+}
+
+/// Number of events recorded in the current session
+inline size_t event_count() {
+    size_t n = detail::buffer().count.load(std::memory_order_relaxed);
+    return n < CAPACITY ? n : CAPACITY;
+}
+
+inline void record(const char* cat, const char* name, char phase, uint64_t ts_us, uint64_t dur_us,
+                   const char* arg0 = nullptr, int64_t value0 = 0,
+                   const char* arg1 = nullptr, int64_t value1 = 0) {
+    detail::Buffer& b = detail::buffer();
+    if (!b.recording.load(std::memory_order_relaxed)) return;
+
+    size_t index = b.count.fetch_add(1, std::memory_order_relaxed);
+    if (index >= CAPACITY) {
+        b.recording.store(false, std::memory_order_relaxed);
+        return;
+    }
+
+    Event& e = b.events[index];
+    e.cat = cat;
+    e.name = name;
+    e.phase = phase;
+    e.tid = thread_id();
+    e.ts_us = ts_us;
+    e.dur_us = dur_us;
+    e.arg_names[0] = arg0;
+    e.arg_values[0] = value0;
+    e.arg_names[1] = arg1;
+    e.arg_values[1] = value1;
+    e.committed.store(true, std::memory_order_release);
+}
+
+inline void set_thread_name(const char* name) {
+    detail::Buffer& b = detail::buffer();
+    uint32_t tid = thread_id();
+    std::lock_guard<std::mutex> lock(b.names_mutex);
+    for (auto& entry : b.thread_names) {
+        if (entry.first == tid) {
+            entry.second = name;
+            return;
+        }
+    }
+    b.thread_names.emplace_back(tid, name);
+}
+
+/// Clear the buffer and start recording
+inline void start() {
+    detail::Buffer& b = detail::buffer();
+    b.recording.store(false, std::memory_order_relaxed);
+    size_t used = event_count();
+    for (size_t i = 0; i < used; ++i) {
+        b.events[i].committed.store(false, std::memory_order_relaxed);
+    }
+    b.count.store(0, std::memory_order_relaxed);
+    b.recording.store(true, std::memory_order_release);
+}
+
+inline void stop() {
+    detail::buffer().recording.store(false, std::memory_order_release);
+}
+
+/// Write the recorded events as Chrome trace-event JSON
+/// @return true if the file was written
+inline bool write_json(const std::string& path) {
+    detail::Buffer& b = detail::buffer();
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) return false;
+
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    {
+        std::lock_guard<std::mutex> lock(b.names_mutex);
+        for (const auto& entry : b.thread_names) {
+            fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                    first ? "" : ",\n", entry.first, entry.second.c_str());
+            first = false;
+        }
+    }
+
+    size_t used = event_count();
+    for (size_t i = 0; i < used; ++i) {
+        const Event& e = b.events[i];
+        if (!e.committed.load(std::memory_order_acquire)) continue;
+
+        fprintf(f, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%llu",
+                first ? "" : ",\n", e.name, e.cat, e.phase, e.tid,
+                static_cast<unsigned long long>(e.ts_us));
+        first = false;
+        if (e.phase == 'X') {
+            fprintf(f, ",\"dur\":%llu", static_cast<unsigned long long>(e.dur_us));
+        } else if (e.phase == 'i') {
+            fprintf(f, ",\"s\":\"t\"");
+        }
+        if (e.arg_names[0]) {
+            fprintf(f, ",\"args\":{\"%s\":%lld", e.arg_names[0], static_cast<long long>(e.arg_values[0]));
+            if (e.arg_names[1]) {
+                fprintf(f, ",\"%s\":%lld", e.arg_names[1], static_cast<long long>(e.arg_values[1]));
+            }
+            fprintf(f, "}");
+        }
+        fprintf(f, "}");
+    }
+    fprintf(f, "\n]}\n");
+    fclose(f);
+    return true;
+}
+
+/// RAII span emitted as one complete event when the scope ends
+class Span {
+public:
+    Span(const char* cat, const char* name) : m_cat(cat), m_name(name), m_start(recording() ? now_us() : 0) {}
+    ~Span() {
+        if (m_start != 0) record(m_cat, m_name, 'X', m_start, now_us() - m_start);
+    }
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* m_cat;
+    const char* m_name;
+    uint64_t m_start;
+};
+
+} // namespace trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(cat, name) ::trace::Span TRACE_CONCAT(trace_span_, __LINE__)(cat, name)
+#define TRACE_INSTANT(cat, name) ::trace::record(cat, name, 'i', ::trace::now_us(), 0)
+#define TRACE_COMPLETE(cat, name, start_us, dur_us, arg0, value0, arg1, value1) \
+    ::trace::record(cat, name, 'X', start_us, dur_us, arg0, value0, arg1, value1)
+#define TRACE_THREAD_NAME(name) ::trace::set_thread_name(name)
+
+#else
+
+namespace trace {
+inline void start() {}
+inline void stop() {}
+inline bool recording() { return false; }
+inline size_t event_count() { return 0; }
+inline bool write_json(const std::string&) { return false; }
+} // namespace trace
+
+#define TRACE_SCOPE(cat, name) ((void)0)
+#define TRACE_INSTANT(cat, name) ((void)0)
+#define TRACE_COMPLETE(cat, name, start_us, dur_us, arg0, value0, arg1, value1) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+
+#endif
@@ -0,0 +1,22 @@
+// Global operator new of the allocation-counting build (make alloc-stats).
+// Every allocation is counted for the subsystem running on its thread (see
+// framestats.hpp). The array and nothrow forms of libstdc++ forward to this
+// one and the default operator delete frees with free(), so replacing this
+// form is enough. Normal builds compile this file to nothing.
+#ifdef HYPERSUITE_ALLOC_STATS
+#include <cstdlib>
+#include <new>
+#include "framestats.hpp"
+
+void* operator new(std::size_t size) {
+    framestats::count_allocation(size);
+    if (size == 0) size = 1;
+    while (true) {
+        void* block = std::malloc(size);
+        if (block) return block;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+#endif
@@ -0,0 +1,54 @@
+#include "Assets.hpp"
+#include <cstring>
+
+// .incbin pulls each file in at assembly time; the paths are relative to the
+// directory make runs in. The Makefile lists the files as prerequisites of
+// this object, so a changed image rebuilds it.
+#ifdef _WIN32
+#define ASSET_SECTION ".rdata,\"dr\"\n"
+#else
+#define ASSET_SECTION ".rodata\n"
+#endif
+
+#define EMBED_ASSET(symbol, file)                                   \
+    __asm__(".pushsection " ASSET_SECTION                           \
+            ".global hs_asset_" #symbol "_start\n"                  \
+            ".balign 16\n"                                          \
+            "hs_asset_" #symbol "_start:\n"                         \
+            ".incbin \"resources/" file "\"\n"                      \
+            ".global hs_asset_" #symbol "_end\n"                    \
+            "hs_asset_" #symbol "_end:\n"                           \
+            ".byte 0\n"                                             \
+            ".popsection\n");                                       \
+    extern "C" const unsigned char hs_asset_##symbol##_start[];     \
+    extern "C" const unsigned char hs_asset_##symbol##_end[];
+
+#define ASSET_ENTRY(symbol, file) \
+    {file, hs_asset_##symbol##_start, static_cast<size_t>(hs_asset_##symbol##_end - hs_asset_##symbol##_start)}
+
+EMBED_ASSET(dance_clip, "e-dance-clip.jpg")
+EMBED_ASSET(laugh, "laugh.jpg")
+EMBED_ASSET(buckey, "buckey.jpg")
+EMBED_ASSET(gear_clip, "Gear-clip.jpg")
+EMBED_ASSET(no_head, "no-head.jpg")
+EMBED_ASSET(nhc_roof, "nhc-roof.jpg")
+EMBED_ASSET(gear_desync, "fullgeardesync.png")
+EMBED_ASSET(logo, "logo.png")
+
+static const EmbeddedAsset assets[] = {
+    ASSET_ENTRY(dance_clip, "e-dance-clip.jpg"),
+    ASSET_ENTRY(laugh, "laugh.jpg"),
+    ASSET_ENTRY(buckey, "buckey.jpg"),
+    ASSET_ENTRY(gear_clip, "Gear-clip.jpg"),
+    ASSET_ENTRY(no_head, "no-head.jpg"),
+    ASSET_ENTRY(nhc_roof, "nhc-roof.jpg"),
+    ASSET_ENTRY(gear_desync, "fullgeardesync.png"),
+    ASSET_ENTRY(logo, "logo.png"),
+};
+
+const EmbeddedAsset* findEmbeddedAsset(const char* name) {
+    for (const EmbeddedAsset& asset : assets) {
+        if (strcmp(asset.name, name) == 0) return &asset;
+    }
+    return nullptr;
+}
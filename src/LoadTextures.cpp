@@ -1,10 +1,36 @@
 #include "LoadTextures.hpp"
 #include "raylib.h"
+#include "Assets.hpp"
 #include "Globals.hpp"
+#include "metrics.hpp"
+#include "trace.hpp"
+#include <atomic>
+#include <cstring>
+#include <thread>
 #include <vector>
 
 std::vector<Texture2D> LoadedTextures;
 
+// Decoded on the sprite thread, uploaded to the GPU by GetSprite() on the main thread
+struct SpriteSlot {
+    const char* file;
+    Image image = {};
+    Texture2D texture = {};
+    std::atomic<bool> decoded{false};
+    bool uploaded = false;
+};
+
+static SpriteSlot sprites[SPRITE_COUNT] = {
+    {"e-dance-clip.jpg"},
+    {"laugh.jpg"},
+    {"buckey.jpg"},
+    {"Gear-clip.jpg"},
+    {"no-head.jpg"},
+    {"nhc-roof.jpg"},
+    {"fullgeardesync.png"},
+};
+static std::thread sprite_thread;
+
 Texture2D LoadTextureFromFile(const char* filename) {
     Texture2D texture = LoadTexture(filename);
     SetTextureFilter(texture, TEXTURE_FILTER_POINT);
@@ -13,6 +39,13 @@ Texture2D LoadTextureFromFile(const char* filename) {
 }
 
 void UnloadAllTextures() {
+    if (sprite_thread.joinable()) sprite_thread.join();
+    for (SpriteSlot& sprite : sprites) {
+        if (sprite.uploaded) UnloadTexture(sprite.texture);
+        else if (sprite.decoded) UnloadImage(sprite.image);
+        sprite.uploaded = false;
+        sprite.decoded = false;
+    }
     for (auto& texture : LoadedTextures) {
         UnloadTexture(texture);
     }
@@ -23,12 +56,39 @@ void registerTexture(Texture2D texture) {
     LoadedTextures.push_back(texture);
 }
 
+Image LoadEmbeddedImage(const char* name) {
+    const EmbeddedAsset* asset = findEmbeddedAsset(name);
+    if (!asset) return Image{};
+    // raylib picks the decoder by extension
+    const char* extension = strrchr(name, '.');
+    return LoadImageFromMemory(extension ? extension : "", asset->data, static_cast<int>(asset->size));
+}
+
 void LoadAllSprites() {
-    LoadTextureFromFile("resources/e-dance-clip.jpg"); // 0
-    LoadTextureFromFile("resources/laugh.jpg"); // 1
-    LoadTextureFromFile("resources/buckey.jpg"); // 2
-    LoadTextureFromFile("resources/Gear-clip.jpg"); // 3
-    LoadTextureFromFile("resources/no-head.jpg"); // 4
-    LoadTextureFromFile("resources/nhc-roof.jpg"); // 5
-    LoadTextureFromFile("resources/fullgeardesync.png"); // 6
+    if (sprite_thread.joinable()) return;
+    sprite_thread = std::thread([]() {
+        TRACE_THREAD_NAME("sprites");
+        metrics::Histogram& decode_time = metrics::get("Sprite decode");
+        for (SpriteSlot& sprite : sprites) {
+            TRACE_SCOPE("sprites", "decode");
+            uint64_t start_ns = metrics::now_ns();
+            sprite.image = LoadEmbeddedImage(sprite.file);
+            decode_time.record(metrics::now_ns() - start_ns);
+            sprite.decoded.store(true, std::memory_order_release);
+        }
+    });
+}
+
+const Texture2D* GetSprite(Sprite index) {
+    SpriteSlot& sprite = sprites[index];
+    if (sprite.uploaded) return &sprite.texture;
+    if (!sprite.decoded.load(std::memory_order_acquire) || sprite.image.data == nullptr) return nullptr;
+
+    TRACE_SCOPE("sprites", "upload");
+    sprite.texture = LoadTextureFromImage(sprite.image);
+    SetTextureFilter(sprite.texture, TEXTURE_FILTER_POINT);
+    UnloadImage(sprite.image);
+    sprite.image = Image{};
+    sprite.uploaded = true;
+    return &sprite.texture;
 }
@@ -5,15 +5,41 @@
 #include "rlImGui.h"
 #include "Globals.hpp"
 #include "inpctrl.hpp"
+#include "procctrl.hpp"
 #include "logzz.hpp"
+#include "asynclog.hpp"
+#include "trace.hpp"
+#include "metrics.hpp"
+#include "framestats.hpp"
 #include "Helper.hpp"
 #include "LagSwitch.hpp"
 #include "Speedglitch.hpp"
 #include "GlobalBasicSettings.hpp"
+#include "MacroRecorder.hpp"
+#include "Instances.hpp"
+#include "Performance.hpp"
+#include "Governor.hpp"
+#include "Monitor.hpp"
+#include "PrivilegedHelper.hpp"
+#include "StartupTiming.hpp"
+#include <algorithm>
+#include <mutex>
+#include <set>
 #include <string>
+#include <vector>
 
 ImVec4 orange = ImVec4(1.0f, 0.55f, 0.1f, 1.0f);
 
+// Tutorial image, or blank space of the same size until it's decoded
+static void drawSprite(Sprite sprite, int width, int height) {
+    const Texture2D* texture = GetSprite(sprite);
+    if (texture) {
+        rlImGuiImageSize(texture, width, height);
+    } else {
+        ImGui::Dummy(ImVec2(static_cast<float>(width), static_cast<float>(height)));
+    }
+}
+
 ImVec4 HSVtoRGB(float h, float s, float v) {
     float r, g, b;
 
@@ -160,8 +186,16 @@ void UpdateUI() {
 
         if (ImGui::Button("Elevate", ImVec2(80.0f, 20.0f)))
         {
-            if (!TryElevate(passwordBuffer))
+            // Privileged helper first, so the UI itself stays unprivileged;
+            // re-running everything as root is the fallback
+            if (startPrivilegedHelper(passwordBuffer)) {
+                is_elevated = true;
+                elevationFailed = false;
+                SetWindowSize(500, 400);
+            } else if (!TryElevate(passwordBuffer)) {
                 elevationFailed = true;
+            }
+            memset(passwordBuffer, 0, sizeof(passwordBuffer));
         }
 
         if (elevationFailed)
@@ -252,7 +286,11 @@ void UpdateUI() {
                     // Calculate available width for the child frame
                     float availableWidth = ImGui::GetContentRegionAvail().x;
 
-                    if (CodeName == "Spam-Key") {
+                    bool usesChat = CodeName == "Laugh" || CodeName == "E-Dance" ||
+                                    CodeName == "Buckey-clip" || CodeName == "Disable-Head-Collision" ||
+                                    CodeName == "NHC-Roof";
+
+                    if (CodeName == "Spam-Key" || usesChat) {
                         ImGui::BeginChild(std::string(label + std::string("_frame")).c_str(),
                                         ImVec2(availableWidth, 120), true);
                     } else {
@@ -272,6 +310,23 @@ void UpdateUI() {
                             BindSpamKey();
                         }
                     }
+                    if (usesChat) {
+                        // 0 = one client frame at the configured FPS
+                        auto delay_it = chat_key_delay_us.find(CodeName);
+                        int current_us = delay_it != chat_key_delay_us.end() ? delay_it->second : 0;
+                        int delay_us = current_us;
+                        ImGui::Text("Chat key delay (us, 0 = auto)");
+                        ImGui::SetNextItemWidth(-1);
+                        if (ImGui::InputInt("##chat_delay", &delay_us, 250, 1000)) {
+                            delay_us = std::max(delay_us, 0);
+                            // Only macros with a delay set get an entry (and are saved)
+                            if (delay_us == 0) {
+                                chat_key_delay_us.erase(CodeName);
+                            } else if (delay_us != current_us) {
+                                chat_key_delay_us[CodeName] = delay_us;
+                            }
+                        }
+                    }
                     ImGui::EndChild();
                 }
             };
@@ -309,7 +364,7 @@ void UpdateUI() {
                 if (offset > 0.0f)
                     ImGui::SetCursorPosX(ImGui::GetCursorPosX() + offset);
 
-                rlImGuiImageSize(&LoadedTextures[1], 248, 140);
+                drawSprite(SPRITE_LAUGH, 248, 140);
                 ImGui::TextWrapped("After this, it's pretty straightforward, just trigger the macro.\nJust remember, higher fps is better!\n");
             } else if (current_option == "Extended Dance Clip") {
                 ImGui::Text("Extended Dance Clip information:");
@@ -322,7 +377,7 @@ void UpdateUI() {
                 if (offset > 0.0f)
                     ImGui::SetCursorPosX(ImGui::GetCursorPosX() + offset);
 
-                rlImGuiImageSize(&LoadedTextures[0], 248, 140);
+                drawSprite(SPRITE_DANCE_CLIP, 248, 140);
                 ImGui::TextWrapped("After this, it's pretty straightforward, just trigger the macro.\nYou might not get it the first attempt, try messing with the distance between you and the wall.\n");
             } else if (current_option == "Buckey clip") {
                 ImGui::Text("Buckey Clip information:");
@@ -335,7 +390,7 @@ void UpdateUI() {
                 if (offset > 0.0f)
                     ImGui::SetCursorPosX(ImGui::GetCursorPosX() + offset);
 
-                rlImGuiImageSize(&LoadedTextures[2], 248, 140);
+                drawSprite(SPRITE_BUCKEY, 248, 140);
                 ImGui::TextWrapped("After this, it's pretty straightforward, just trigger the macro! And you should clip through.");
             } else if (current_option == "Speed glitch") {
                 ImGui::Text("Speed glitch information:");
@@ -362,7 +417,7 @@ void UpdateUI() {
                 if (offset > 0.0f)
                     ImGui::SetCursorPosX(ImGui::GetCursorPosX() + offset);
 
-                rlImGuiImageSize(&LoadedTextures[3], 248, 140);
+                drawSprite(SPRITE_GEAR_CLIP, 248, 140);
                 ImGui::TextWrapped("After this, it's pretty straightforward, just trigger the macro and hold W! This glitch can be rng, but you'll get it, especially with low fps.");
             } else if (current_option == "Disable head collision") {
                 ImGui::Text("Disable head collision information:");
@@ -375,7 +430,7 @@ void UpdateUI() {
                 if (offset > 0.0f)
                     ImGui::SetCursorPosX(ImGui::GetCursorPosX() + offset);
 
-                rlImGuiImageSize(&LoadedTextures[4], 248, 140);
+                drawSprite(SPRITE_NO_HEAD, 248, 140);
                 ImGui::TextWrapped("After this, it's pretty straightforward, just trigger the macro! This glitch can be rng, but you'll get it.");
             } else if (current_option == "NHC Roof Clip") {
                 ImGui::Text("NHC Roof Clip information:");
@@ -392,7 +447,7 @@ void UpdateUI() {
                 if (offset > 0.0f)
                     ImGui::SetCursorPosX(ImGui::GetCursorPosX() + offset);
 
-                rlImGuiImageSize(&LoadedTextures[5], imageWidth, 140);
+                drawSprite(SPRITE_NHC_ROOF, imageWidth, 140);
                 ImGui::TextWrapped("After this, it's pretty straightforward, just trigger the macro! This glitch can be rng, but you'll get it.\nAlso make sure you have head collision disabled!!!");
             } else if (current_option == "Helicopter High Jump") {
                 ImGui::Text("Helicopter High Jump information:");
@@ -420,7 +475,7 @@ void UpdateUI() {
                 if (offset > 0.0f)
                     ImGui::SetCursorPosX(ImGui::GetCursorPosX() + offset);
 
-                rlImGuiImageSize(&LoadedTextures[6], imageWidth, 58);
+                drawSprite(SPRITE_GEAR_DESYNC, imageWidth, 58);
                 ImGui::TextWrapped("Look at this video for more details on what you can do with this glitch");
                 ImGui::PushItemWidth(ImGui::GetContentRegionAvail().x); // Fill horizontally
 
@@ -505,6 +560,512 @@ void UpdateUI() {
         }
         renderRobloxSettingsWindow();
 
+        // Client instances
+        if (ImGui::BeginTabItem("Instances")) {
+            static std::map<uint64_t, std::string> place_names;    // by universe, appStorage.json is slow to read
+            std::vector<RobloxInstance> current;
+            std::set<pid_t> selected;
+            {
+                std::lock_guard<std::mutex> lock(instances_mutex);
+                current = instances;
+                selected = selected_instances;
+            }
+
+            if (selected.empty()) {
+                ImGui::TextWrapped("No instance selected: macros freeze every \"%s\" process.", roblox_process_name.c_str());
+            } else {
+                ImGui::Text("Macros freeze %zu selected instance(s) at once.", selected.size());
+            }
+            if (ImGui::Button("Refresh")) {
+                refreshInstances();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Freeze selected") && !selected.empty()) {
+                suspendTargets(roblox_process_name, true);
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Thaw selected") && !selected.empty()) {
+                suspendTargets(roblox_process_name, false);
+            }
+            ImGui::Separator();
+
+            if (ImGui::BeginTable("Instances", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+                ImGui::TableSetupColumn("Target");
+                ImGui::TableSetupColumn("PID");
+                ImGui::TableSetupColumn("User ID");
+                ImGui::TableSetupColumn("State");
+                ImGui::TableSetupColumn("Place");
+                ImGui::TableHeadersRow();
+
+                for (const RobloxInstance& instance : current) {
+                    ImGui::PushID(static_cast<int>(instance.pid));
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    bool target = selected.count(instance.pid) != 0;
+                    if (ImGui::Checkbox("##target", &target)) {
+                        std::lock_guard<std::mutex> lock(instances_mutex);
+                        if (target) selected_instances.insert(instance.pid);
+                        else selected_instances.erase(instance.pid);
+                    }
+                    if (ImGui::IsItemHovered() && !instance.cgroup.empty()) {
+                        ImGui::SetTooltip("%s", instance.cgroup.c_str());
+                    }
+                    ImGui::TableNextColumn();
+                    if (instance.pid == governor_focused) ImGui::Text("%d (front)", static_cast<int>(instance.pid));
+                    else ImGui::Text("%d", static_cast<int>(instance.pid));
+                    ImGui::TableNextColumn();
+                    if (instance.summary.user_ID) ImGui::Text("%llu", instance.summary.user_ID);
+                    else ImGui::TextUnformatted("-");
+                    ImGui::TableNextColumn();
+                    if (instance.log_path.empty()) {
+                        ImGui::TextUnformatted("no log");
+                    } else {
+                        switch (instance.summary.status) {
+                            case IN_GAME:    ImGui::TextUnformatted("in game"); break;
+                            case IN_LUA_APP: ImGui::TextUnformatted("lua app"); break;
+                            default:         ImGui::TextUnformatted("offline"); break;
+                        }
+                    }
+                    ImGui::TableNextColumn();
+                    if (instance.summary.status == IN_GAME) {
+                        auto name = place_names.find(instance.summary.universe_ID);
+                        if (name == place_names.end()) {
+                            name = place_names.emplace(instance.summary.universe_ID, logzz::find_name_for_universe(instance.summary.universe_ID)).first;
+                        }
+                        if (name->second.empty()) ImGui::Text("%llu", static_cast<unsigned long long>(instance.summary.place_ID));
+                        else ImGui::TextUnformatted(name->second.c_str());
+                    }
+                    ImGui::PopID();
+                }
+                ImGui::EndTable();
+            }
+
+            // Background governor
+            ImGui::SeparatorText("Background clients");
+            ImGui::Checkbox("Throttle clients that are not in front", &governor_enabled);
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("The client in front is the last one that had the focus");
+            }
+            ImGui::RadioButton("Limit", &governor_mode, GOVERNOR_LIMIT);
+            ImGui::SameLine();
+            ImGui::RadioButton("Duty cycle", &governor_mode, GOVERNOR_DUTY_CYCLE);
+            if (governor_mode == GOVERNOR_LIMIT) {
+#ifdef _WIN32
+                ImGui::TextDisabled("Limits need cgroups (Linux); use the duty cycle here");
+#else
+                ImGui::SetNextItemWidth(120.0f);
+                if (ImGui::InputInt("cpu.max %##governor", &governor_cpu_percent, 1, 10)) {
+                    governor_cpu_percent = std::clamp(governor_cpu_percent, 1, 100);
+                }
+                ImGui::SetNextItemWidth(120.0f);
+                if (ImGui::InputInt("memory.high (MB)", &governor_memory_high_mb, 64, 512)) {
+                    governor_memory_high_mb = std::max(governor_memory_high_mb, 0);
+                }
+                ImGui::SameLine();
+                ImGui::TextDisabled("(0 = no limit)");
+                ImGui::TextDisabled("Only clients in their own app cgroup (Flatpak/Sober) can be limited");
+#endif
+            } else {
+                ImGui::SetNextItemWidth(120.0f);
+                if (ImGui::InputInt("Period (ms)", &governor_period_ms, 10, 100)) {
+                    governor_period_ms = std::clamp(governor_period_ms, 20, 2000);
+                }
+                ImGui::SetNextItemWidth(120.0f);
+                if (ImGui::InputInt("Running (ms)", &governor_run_ms, 1, 10)) {
+                    governor_run_ms = std::clamp(governor_run_ms, 1, governor_period_ms);
+                }
+                ImGui::SameLine();
+                ImGui::TextDisabled("(%d%% of the time)", governor_run_ms * 100 / governor_period_ms);
+            }
+
+            ImGui::EndTabItem();
+        }
+
+        // CPU placement and priorities
+        if (ImGui::BeginTabItem("Performance")) {
+            static char profile_name[64] = "";
+
+            ImGui::SetNextItemWidth(160.0f);
+            if (ImGui::BeginCombo("Profile", active_performance_profile.c_str())) {
+                for (const auto& [name, profile] : performance_profiles) {
+                    if (ImGui::Selectable(name.c_str(), name == active_performance_profile)) {
+                        active_performance_profile = name;
+                        performance_applied.clear();
+                    }
+                }
+                ImGui::EndCombo();
+            }
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(120.0f);
+            ImGui::InputText("##profile_name", profile_name, sizeof(profile_name));
+            ImGui::SameLine();
+            if (ImGui::Button("Save as") && profile_name[0] != '\0') {
+                performance_profiles[profile_name] = activePerformanceProfile();
+                active_performance_profile = profile_name;
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Delete") && performance_profiles.size() > 1) {
+                performance_profiles.erase(active_performance_profile);
+                active_performance_profile = performance_profiles.begin()->first;
+            }
+
+            PerformanceProfile& profile = activePerformanceProfile();
+            int cpus = std::min(procctrl::cpu_count(), 64);
+
+            auto cpuMask = [cpus](const char* id, uint64_t& mask) {
+                ImGui::PushID(id);
+                for (int cpu = 0; cpu < cpus; ++cpu) {
+                    if (cpu % 8 != 0) ImGui::SameLine();
+                    bool on = (mask >> cpu) & 1;
+                    if (ImGui::Checkbox(std::to_string(cpu).c_str(), &on)) {
+                        mask = on ? (mask | (1ULL << cpu)) : (mask & ~(1ULL << cpu));
+                    }
+                }
+                ImGui::PopID();
+            };
+
+            ImGui::SeparatorText("Roblox CPUs");
+            ImGui::TextDisabled("None checked leaves the affinity alone");
+            cpuMask("game", profile.game_cpus);
+
+            ImGui::SeparatorText("Hypersuite CPUs");
+            ImGui::TextDisabled("Keeps macros and input off the cores the game uses");
+            cpuMask("utility", profile.utility_cpus);
+
+            ImGui::SeparatorText("Priority");
+            ImGui::Checkbox("Set nice", &profile.set_nice);
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(160.0f);
+            ImGui::SliderInt("##nice", &profile.nice, -20, 19);
+            if (ImGui::IsItemHovered()) ImGui::SetTooltip("Lower is higher priority");
+#ifndef _WIN32
+            const char* io_classes[] = {"Leave", "Realtime", "Best-effort", "Idle"};
+            ImGui::SetNextItemWidth(160.0f);
+            ImGui::Combo("IO class", &profile.io_class, io_classes, IM_ARRAYSIZE(io_classes));
+            if (profile.io_class == 1 || profile.io_class == 2) {
+                ImGui::SameLine();
+                ImGui::SetNextItemWidth(100.0f);
+                ImGui::SliderInt("Level", &profile.io_level, 0, 7);
+            }
+
+            ImGui::SeparatorText("cgroup (Flatpak/Sober app scope only)");
+            ImGui::SetNextItemWidth(120.0f);
+            if (ImGui::InputInt("cpu.weight", &profile.cpu_weight, 10, 100)) {
+                profile.cpu_weight = std::clamp(profile.cpu_weight, 0, 10000);
+            }
+            ImGui::SameLine();
+            ImGui::TextDisabled("(0 = leave, default is 100)");
+            ImGui::SetNextItemWidth(120.0f);
+            if (ImGui::InputInt("cpu.max %", &profile.cpu_max_percent, 5, 25)) {
+                profile.cpu_max_percent = std::clamp(profile.cpu_max_percent, 0, 100);
+            }
+            ImGui::SameLine();
+            ImGui::TextDisabled("(of all CPUs, 0 = leave)");
+#endif
+
+            ImGui::Separator();
+            ImGui::Checkbox("Apply to new clients automatically", &performance_auto_apply);
+            if (ImGui::Button("Apply now")) {
+                applyPerformanceNow();
+            }
+            if (!is_elevated) {
+                ImGui::SameLine();
+                ImGui::TextDisabled("Raising priority needs elevated rights");
+            }
+
+            ImGui::EndTabItem();
+        }
+
+        // Resource usage of one client
+        if (ImGui::BeginTabItem("Monitor")) {
+            monitorStart();
+
+            std::vector<pid_t> clients;
+            {
+                std::lock_guard<std::mutex> lock(instances_mutex);
+                for (const RobloxInstance& instance : instances) clients.push_back(instance.pid);
+            }
+            pid_t target = monitor_target;
+            if (target == 0 && !clients.empty()) {
+                target = governor_focused ? governor_focused : clients.front();
+                monitor_target = target;
+            }
+
+            std::string preview = target ? "PID " + std::to_string(target) : "none";
+            ImGui::SetNextItemWidth(140.0f);
+            if (ImGui::BeginCombo("Client", preview.c_str())) {
+                for (pid_t pid : clients) {
+                    if (ImGui::Selectable(("PID " + std::to_string(pid)).c_str(), pid == target)) {
+                        monitor_target = pid;
+                    }
+                }
+                ImGui::EndCombo();
+            }
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(100.0f);
+            if (ImGui::InputInt("Interval (ms)", &monitor_interval_ms, 50, 250)) {
+                monitor_interval_ms = std::clamp(monitor_interval_ms, 50, 5000);
+            }
+
+            MonitorHistory history;
+            {
+                std::lock_guard<std::mutex> lock(monitor_mutex);
+                history = monitor_history;
+            }
+
+            if (history.count == 0) {
+                ImGui::TextDisabled(clients.empty() ? "No client running" : "Waiting for samples...");
+            } else {
+                ImVec2 graph_size(ImGui::GetContentRegionAvail().x, 48.0f);
+                char overlay[64];
+                auto graph = [&](const char* id, const std::vector<float>& series, const char* format, float scale_max) {
+                    snprintf(overlay, sizeof(overlay), format, history.last(series));
+                    ImGui::PlotLines(id, series.data(), history.count, history.count < MONITOR_HISTORY ? 0 : history.offset,
+                                     overlay, 0.0f, scale_max, graph_size);
+                };
+
+                ImGui::TextUnformatted("CPU (% of one core)");
+                graph("##cpu", history.cpu_percent, "%.0f%%", FLT_MAX);
+                ImGui::Text("Memory (%s)", history.memory_source.c_str());
+                graph("##memory", history.memory_mb, "%.0f MB", FLT_MAX);
+#ifndef _WIN32
+                ImGui::TextUnformatted("Threads");
+                graph("##threads", history.threads, "%.0f", FLT_MAX);
+                ImGui::TextUnformatted("Context switches / s");
+                graph("##ctx", history.ctx_switches, "%.0f", FLT_MAX);
+#endif
+            }
+
+            ImGui::EndTabItem();
+        }
+
+        // Logs
+        if (ImGui::BeginTabItem("Logs")) {
+            static std::vector<asynclog::Entry> log_lines;
+            static uint64_t log_version = ~0ULL;
+            static const char* level_names[] = {"Debug", "Info", "Warn", "Error"};
+
+            int level = static_cast<int>(asynclog::min_level());
+            ImGui::Text("Level:");
+            ImGui::SameLine();
+            ImGui::PushItemWidth(100);
+            if (ImGui::Combo("##log_level", &level, level_names, IM_ARRAYSIZE(level_names))) {
+                asynclog::set_min_level(static_cast<asynclog::Level>(level));
+            }
+            ImGui::PopItemWidth();
+            ImGui::SameLine();
+            if (ImGui::Button("Clear")) {
+                asynclog::clear_history();
+            }
+            if (asynclog::dropped() > 0) {
+                ImGui::SameLine();
+                ImGui::TextColored(orange, "%llu dropped", static_cast<unsigned long long>(asynclog::dropped()));
+            }
+            ImGui::Separator();
+
+            if (asynclog::history_version() != log_version) {
+                log_version = asynclog::history_version();
+                asynclog::copy_history(log_lines);
+            }
+
+            ImGui::BeginChild("LogLines", ImVec2(0, 0), true, ImGuiWindowFlags_HorizontalScrollbar);
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(log_lines.size()));
+            while (clipper.Step()) {
+                for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                    const asynclog::Entry& entry = log_lines[i];
+                    if (entry.level == asynclog::Level::Error) {
+                        ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%s", entry.text.c_str());
+                    } else if (entry.level == asynclog::Level::Warn) {
+                        ImGui::TextColored(orange, "%s", entry.text.c_str());
+                    } else {
+                        ImGui::TextUnformatted(entry.text.c_str());
+                    }
+                }
+            }
+            if (ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
+                ImGui::SetScrollHereY(1.0f);
+            }
+            ImGui::EndChild();
+
+            ImGui::EndTabItem();
+        }
+
+        // Diagnostics
+        if (ImGui::BeginTabItem("Diagnostics")) {
+            ImGui::Text("Latency histograms (microseconds):");
+            ImGui::SameLine();
+            if (ImGui::Button("Reset")) {
+                metrics::reset_all();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Export JSON")) {
+                if (metrics::write_json("metrics.json")) {
+                    log("Metrics exported to metrics.json");
+                } else {
+                    log("Could not write metrics.json");
+                }
+            }
+            ImGui::Separator();
+
+            if (ImGui::BeginTable("Metrics", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+                ImGui::TableSetupColumn("Measurement");
+                ImGui::TableSetupColumn("Count");
+                ImGui::TableSetupColumn("p50");
+                ImGui::TableSetupColumn("p99");
+                ImGui::TableSetupColumn("Max");
+                ImGui::TableHeadersRow();
+
+                for (auto& entry : metrics::list()) {
+                    metrics::Summary summary = entry.second->summary();
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(entry.first.c_str());
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%llu", static_cast<unsigned long long>(summary.count));
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.1f", summary.p50_ns / 1000.0);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.1f", summary.p99_ns / 1000.0);
+                    ImGui::TableNextColumn();
+                    if (summary.max_ns > 2 * summary.p99_ns && summary.count > 0) {
+                        ImGui::TextColored(orange, "%.1f", summary.max_ns / 1000.0);
+                    } else {
+                        ImGui::Text("%.1f", summary.max_ns / 1000.0);
+                    }
+                }
+                ImGui::EndTable();
+            }
+
+            ImGui::Separator();
+            ImGui::Text("Startup: first frame after %.1f ms", startup_first_frame_ms);
+            for (const StartupPhase& phase : startup_phases) {
+                ImGui::BulletText("%s: %.1f ms", phase.name, phase.ms);
+            }
+
+            // Main thread cost per frame, over the last framestats::HISTORY frames
+            ImGui::Separator();
+            framestats::Summary frame = framestats::summary();
+            ImGui::Text("Frame cost (average / worst of %zu frames): %.0f / %.0f us CPU", frame.frames,
+                        frame.average.total_cpu_ns() / 1000.0, frame.worst.total_cpu_ns() / 1000.0);
+            if (ImGui::BeginTable("FrameCost", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+                ImGui::TableSetupColumn("Subsystem");
+                ImGui::TableSetupColumn("CPU us");
+                ImGui::TableSetupColumn("Allocations");
+                ImGui::TableSetupColumn("KiB");
+                ImGui::TableHeadersRow();
+
+                for (unsigned i = 0; i < framestats::SUBSYSTEM_COUNT; ++i) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(framestats::subsystem_name(i));
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.0f / %.0f", frame.average.cpu_ns[i] / 1000.0, frame.worst.cpu_ns[i] / 1000.0);
+                    ImGui::TableNextColumn();
+                    if (framestats::counts_allocations()) {
+                        ImGui::Text("%.1f / %.0f", frame.average.allocations[i], frame.worst.allocations[i]);
+                    } else {
+                        ImGui::TextDisabled("-");
+                    }
+                    ImGui::TableNextColumn();
+                    if (framestats::counts_allocations()) {
+                        ImGui::Text("%.1f / %.1f", frame.average.bytes[i] / 1024.0, frame.worst.bytes[i] / 1024.0);
+                    } else {
+                        ImGui::TextDisabled("-");
+                    }
+                }
+                ImGui::EndTable();
+            }
+            if (!framestats::counts_allocations()) {
+                ImGui::TextDisabled("Allocations are counted in `make alloc-stats` builds");
+            }
+
+#ifdef HYPERSUITE_TRACE
+            ImGui::Separator();
+            // Trace session (only in `make trace` builds)
+            if (!trace::recording()) {
+                if (ImGui::Button("Start trace")) {
+                    trace::start();
+                    log("Trace recording started");
+                }
+            } else if (ImGui::Button("Stop trace")) {
+                trace::stop();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Save trace")) {
+                trace::stop();
+                if (trace::write_json("trace.json")) {
+                    logfmt("Trace saved to trace.json (%zu events)", trace::event_count());
+                } else {
+                    logfmt("Could not write trace.json");
+                }
+            }
+            ImGui::SameLine();
+            ImGui::Text("%zu events", trace::event_count());
+#endif
+
+            ImGui::EndTabItem();
+        }
+
+        // Recorder
+        // Directory listing, re-read when the tab opens, after a save and on Refresh
+        static std::vector<std::string> recordings;
+        static bool recordings_stale = true;
+        if (ImGui::BeginTabItem("Recorder")) {
+            static char recording_name[64] = "recording";
+
+            if (input.isRecording()) {
+                ImGui::TextColored(orange, "Recording... %zu events", input.recordedCount());
+            } else {
+                ImGui::Text("Last recording: %zu events", last_recording.size());
+            }
+            ImGui::Text(("Start/stop with " + std::string(input.getKeyName(RecordKey))).c_str());
+            ImGui::SameLine();
+            if (ImGui::Button("Bind record key")) {
+                BindVariable(&RecordKey);
+            }
+            ImGui::Separator();
+
+            ImGui::PushItemWidth(200);
+            ImGui::InputText("##recording_name", recording_name, sizeof(recording_name));
+            ImGui::PopItemWidth();
+            ImGui::SameLine();
+            bool valid_name = isValidRecordingName(recording_name);
+            if (!valid_name) ImGui::BeginDisabled();
+            if (ImGui::Button("Save") && !last_recording.empty()) {
+                if (saveRecording(recording_name, last_recording)) recordings_stale = true;
+            }
+            if (!valid_name) {
+                ImGui::EndDisabled();
+                ImGui::SameLine();
+                ImGui::TextColored(orange, "Letters, digits, _ and - only");
+            }
+            ImGui::Separator();
+
+            ImGui::Text("Saved recordings (replay starts after 3 seconds):");
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Refresh")) recordings_stale = true;
+            if (recordings_stale) {
+                recordings = listRecordings();
+                recordings_stale = false;
+            }
+            for (const std::string& name : recordings) {
+                ImGui::PushID(name.c_str());
+                if (replay_running) ImGui::BeginDisabled();
+                if (ImGui::Button("Play")) {
+                    startReplay(name, 3000);
+                }
+                if (replay_running) ImGui::EndDisabled();
+                ImGui::SameLine();
+                ImGui::TextUnformatted(name.c_str());
+                ImGui::PopID();
+            }
+
+            ImGui::EndTabItem();
+        } else {
+            recordings_stale = true;
+        }
+
 
         if (ImGui::BeginTabItem("Settings")) {
             // ==== GLOBAL SETTINGS ====
@@ -514,7 +1075,9 @@ void UpdateUI() {
             // Keyboard layout
             ImGui::Text("Keyboard layout:");
             ImGui::PushItemWidth(100);
-            if (ImGui::Combo("##kb_layout", (int*)&kb_layout, string_kb_layouts, IM_ARRAYSIZE(string_kb_layouts))) {
+            int layout_index = kb_layout;
+            if (ImGui::Combo("##kb_layout", &layout_index, string_kb_layouts, IM_ARRAYSIZE(string_kb_layouts))) {
+                kb_layout = static_cast<unsigned short>(layout_index);
                 printf("Selected layout: %s (index %d)\n", string_kb_layouts[kb_layout], kb_layout);
             }
             ImGui::SameLine();
@@ -523,6 +1086,11 @@ void UpdateUI() {
             }
             ImGui::SameLine();
             ImGui::Text(("Current: " + std::string(input.getKeyName(ChatKey))).c_str());
+            ImGui::Text("Chat open delay (ms):");
+            ImGui::SameLine();
+            if (ImGui::InputInt("##chat_open_delay", &chat_open_delay_ms)) {
+                if (chat_open_delay_ms < 0) chat_open_delay_ms = 0;
+            }
             ImGui::Checkbox("Window always on top", &windowOnTop);
 #ifdef _WIN32
             ImGui::Checkbox("Decorated window (title bar) (100% DPI recommended)", &decorated_window);
@@ -564,6 +1132,41 @@ void UpdateUI() {
                 roblox_process_name = process_name_buffer;
             }
 
+            // Wait for the kernel to confirm freezes (0 = off)
+            ImGui::Text("Confirm (ms):");
+            ImGui::SameLine(120);
+            if (ImGui::InputInt("##freeze_confirm", &procctrl::confirm_timeout_ms)) {
+                if (procctrl::confirm_timeout_ms < 0) procctrl::confirm_timeout_ms = 0;
+                if (procctrl::confirm_timeout_ms > 1000) procctrl::confirm_timeout_ms = 1000;
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Wait until Roblox is really frozen/thawed before a macro continues.\n"
+                                  "The measured latency shows up in the Diagnostics tab.");
+            }
+
+#ifndef _WIN32
+            // How to freeze; Auto measures the options once per app cgroup
+            ImGui::Text("Freeze with:");
+            ImGui::SameLine(120);
+            static const char* freeze_methods[] = {"Auto", "cgroup.freeze", "SIGSTOP tree", "SIGSTOP group"};
+            int freeze_method = static_cast<int>(procctrl::freeze_method_override);
+            if (ImGui::Combo("##freeze_method", &freeze_method, freeze_methods, IM_ARRAYSIZE(freeze_methods))) {
+                procctrl::freeze_method_override = static_cast<procctrl::FreezeMethod>(freeze_method);
+            }
+            if (ImGui::IsItemHovered()) {
+                std::string measured = "Measured:";
+                for (const auto& [target, method] : procctrl::cached_freeze_methods()) {
+                    measured += "\n" + target + ": " + procctrl::freeze_method_name(method);
+                }
+                ImGui::SetTooltip("%s", measured.c_str());
+            }
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Re-measure")) {
+                procctrl::clear_freeze_methods();
+                calibrateProcessesByName(roblox_process_name);
+            }
+#endif
+
             ImGui::PopItemWidth();
 
             ImGui::NextColumn();
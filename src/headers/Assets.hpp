@@ -0,0 +1,17 @@
+#ifndef ASSETS_HPP
+#define ASSETS_HPP
+#include <cstddef>
+
+// Files of resources/ compiled into the binary (src/Assets.cpp), so the UI
+// doesn't depend on the working directory. The images stay in their
+// compressed JPG/PNG form until decoded.
+struct EmbeddedAsset {
+    const char* name;               // file name in resources/
+    const unsigned char* data;
+    size_t size;
+};
+
+// nullptr if no asset has that name
+const EmbeddedAsset* findEmbeddedAsset(const char* name);
+
+#endif
@@ -0,0 +1,277 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "json.hpp"
+#include "Globals.hpp"
+#include "Helper.hpp"
+#include "Instances.hpp"
+#include "SettingsHandler.hpp"
+#include "logzz.hpp"
+#include "metrics.hpp"
+#include "framestats.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include "privhelper.hpp"
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// Control socket of the headless mode (--headless): a Unix-domain stream
+// socket taking one command per line and answering each with one line of
+// JSON ({"ok": true, ...} or {"ok": false, "error": "..."}). It is polled from
+// the main loop, so commands run on the macro thread.
+//
+//   status                          client state, place, instances
+//   list                            macros with their bind and state
+//   enable|disable|toggle <macro>   e.g. "toggle Freeze"
+//   bind <macro> <key>              key name (F1, Num8, ...) or key code
+//   metrics                         latency histograms (ns), frame cost per subsystem
+//   save                            write saved.json
+//   quit                            stop the daemon
+
+// Key by its getKeyName() name (case-insensitive) or its numeric code
+inline bool keyFromName(const std::string& name, CrossInput::Key& key) {
+    // Single digits are key names ("1"), not codes
+    char* end;
+    unsigned long code = strtoul(name.c_str(), &end, 0);
+    if (*end == '\0' && name.size() > 1) {
+        key = static_cast<CrossInput::Key>(code);
+        return true;
+    }
+    for (unsigned int candidate = 1; candidate <= 0xFF; ++candidate) {
+        std::string candidate_name = input.getKeyName(static_cast<CrossInput::Key>(candidate));
+        if (candidate_name.size() == name.size() &&
+            std::equal(name.begin(), name.end(), candidate_name.begin(),
+                       [](char a, char b) { return tolower(static_cast<unsigned char>(a)) == tolower(static_cast<unsigned char>(b)); })) {
+            key = static_cast<CrossInput::Key>(candidate);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Reply to one command line
+inline nlohmann::json controlCommand(const std::string& line, bool& quit) {
+    std::istringstream words(line);
+    std::string command, macro, argument;
+    words >> command >> macro >> argument;
+
+    auto error = [](const std::string& message) { return nlohmann::json{{"ok", false}, {"error", message}}; };
+    nlohmann::json reply = {{"ok", true}};
+
+    if (command == "status") {
+        const char* states[] = {"in_game", "in_lua_app", "offline", "invalid", "unchanged"};
+        reply["state"] = states[logzz::current_state];
+        reply["place_id"] = logzz::current_place_ID;
+        reply["universe_id"] = logzz::current_universe_ID;
+        std::lock_guard<std::mutex> lock(instances_mutex);
+        reply["instances"] = nlohmann::json::array();
+        for (const RobloxInstance& instance : instances) reply["instances"].push_back(instance.pid);
+    } else if (command == "list") {
+        reply["macros"] = nlohmann::json::array();
+        for (const auto& [name, key] : Binds) {
+            unsigned short id = GetIDFromCodeName(name);
+            reply["macros"].push_back({{"name", name}, {"key", input.getKeyName(key)},
+                                       {"enabled", id < sizeof(enabled) / sizeof(enabled[0]) && enabled[id]}});
+        }
+    } else if (command == "enable" || command == "disable" || command == "toggle") {
+        unsigned short id = GetIDFromCodeName(macro);
+        if (id >= sizeof(enabled) / sizeof(enabled[0])) return error("unknown macro: " + macro);
+        enabled[id] = command == "toggle" ? !enabled[id] : command == "enable";
+        reply["enabled"] = enabled[id];
+        log("Control: " + macro + (enabled[id] ? " enabled" : " disabled"));
+    } else if (command == "bind") {
+        auto bind = Binds.find(macro);
+        if (bind == Binds.end()) return error("unknown macro: " + macro);
+        CrossInput::Key key;
+        if (!keyFromName(argument, key)) return error("unknown key: " + argument);
+        bind->second = key;
+        rebuildMacroProfiles();
+        reply["key"] = input.getKeyName(key);
+        log("Control: " + macro + " bound to " + input.getKeyName(key));
+    } else if (command == "metrics") {
+        reply["histograms"] = nlohmann::json::object();
+        for (auto& entry : metrics::list()) {
+            metrics::Summary s = entry.second->summary();
+            reply["histograms"][entry.first] = {{"count", s.count}, {"mean", s.mean_ns}, {"p50", s.p50_ns},
+                                                {"p90", s.p90_ns}, {"p99", s.p99_ns}, {"max", s.max_ns}};
+        }
+        // Average cost of a tick per subsystem (allocations only in alloc-stats builds)
+        framestats::Summary frame = framestats::summary();
+        for (unsigned i = 0; i < framestats::SUBSYSTEM_COUNT; ++i) {
+            nlohmann::json& subsystem = reply["frame"][framestats::subsystem_name(i)];
+            subsystem["cpu_ns"] = frame.average.cpu_ns[i];
+            if (framestats::counts_allocations()) {
+                subsystem["allocations"] = frame.average.allocations[i];
+                subsystem["bytes"] = frame.average.bytes[i];
+            }
+        }
+    } else if (command == "save") {
+        SettingsHandler::SaveSettings();
+    } else if (command == "quit") {
+        quit = true;
+    } else {
+        return error("unknown command: " + command);
+    }
+    return reply;
+}
+
+class ControlServer {
+public:
+    ~ControlServer() { stop(); }
+
+    bool quitRequested() const { return m_quit; }
+
+#ifndef _WIN32
+    // $XDG_RUNTIME_DIR/hypersuite.sock of the user (the invoking one under sudo)
+    static std::string defaultPath() {
+        const char* sudo_uid = getenv("SUDO_UID");
+        if (sudo_uid) return std::string("/run/user/") + sudo_uid + "/hypersuite.sock";
+        const char* runtime_dir = getenv("XDG_RUNTIME_DIR");
+        if (runtime_dir) return std::string(runtime_dir) + "/hypersuite.sock";
+        return "/tmp/hypersuite-" + std::to_string(getuid()) + ".sock";
+    }
+
+    bool start(const std::string& path) {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) return false;
+        memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+        // Only the user may drive the macros; under sudo that's the invoking user.
+        // The socket is created as them (see privhelper::FilesystemIds), never chown'ed
+        const char* sudo_uid = getenv("SUDO_UID");
+        const char* sudo_gid = getenv("SUDO_GID");
+        m_owner = sudo_uid && sudo_gid ? static_cast<uid_t>(atoi(sudo_uid)) : geteuid();
+        m_group = sudo_uid && sudo_gid ? static_cast<gid_t>(atoi(sudo_gid)) : getegid();
+
+        m_listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (m_listen_fd < 0) return false;
+        bool bound;
+        {
+            privhelper::FilesystemIds ids(m_owner, m_group);
+            unlink(path.c_str());  // left over from a previous run
+            // 0600 from the start, never briefly open to others
+            mode_t old_mask = umask(0177);
+            bound = bind(m_listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+            umask(old_mask);
+        }
+        if (!bound || listen(m_listen_fd, 4) != 0) {
+            asynclog::write(asynclog::Level::Error, "[control] Cannot listen on %s: %s", path.c_str(), strerror(errno));
+            close(m_listen_fd);
+            m_listen_fd = -1;
+            return false;
+        }
+
+        m_path = path;
+        logfmt("Control socket listening on %s", path.c_str());
+        return true;
+    }
+
+    void stop() {
+        for (Client& client : m_clients) close(client.fd);
+        m_clients.clear();
+        if (m_listen_fd >= 0) {
+            close(m_listen_fd);
+            privhelper::remove_socket(m_path, m_owner, m_group);
+            m_listen_fd = -1;
+        }
+    }
+
+    // Serve pending connections and commands; waits up to timeout_ms for one
+    void poll(int timeout_ms) {
+        std::vector<pollfd> fds;
+        if (m_listen_fd >= 0) fds.push_back({m_listen_fd, POLLIN, 0});
+        for (const Client& client : m_clients) fds.push_back({client.fd, POLLIN, 0});
+        if (fds.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+            return;
+        }
+        if (::poll(fds.data(), fds.size(), timeout_ms) <= 0) return;
+
+        if (fds[0].revents & POLLIN) {
+            int fd;
+            while ((fd = accept4(m_listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                m_clients.push_back({fd, ""});
+            }
+        }
+        for (size_t i = m_clients.size(); i-- > 0;) {
+            if (!serve(m_clients[i])) {
+                close(m_clients[i].fd);
+                m_clients.erase(m_clients.begin() + i);
+            }
+        }
+    }
+
+private:
+    struct Client {
+        int fd;
+        std::string pending;    // bytes received after the last newline
+    };
+
+    // Reads what the client sent and answers complete lines. False once it disconnected.
+    bool serve(Client& client) {
+        char buffer[1024];
+        ssize_t n;
+        while ((n = read(client.fd, buffer, sizeof(buffer))) > 0) {
+            client.pending.append(buffer, static_cast<size_t>(n));
+            if (client.pending.size() > 64 * 1024) return false;
+        }
+        bool open = n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+
+        size_t newline;
+        while ((newline = client.pending.find('\n')) != std::string::npos) {
+            std::string line = client.pending.substr(0, newline);
+            client.pending.erase(0, newline + 1);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+
+            std::string reply = controlCommand(line, m_quit).dump() + "\n";
+            size_t sent = 0;
+            while (sent < reply.size()) {
+                ssize_t written = send(client.fd, reply.data() + sent, reply.size() - sent, MSG_NOSIGNAL);
+                if (written > 0) {
+                    sent += static_cast<size_t>(written);
+                } else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                    pollfd out = {client.fd, POLLOUT, 0};
+                    if (::poll(&out, 1, 100) <= 0) return false;
+                } else {
+                    return false;
+                }
+            }
+        }
+        return open;
+    }
+
+    int m_listen_fd = -1;
+    std::string m_path;
+    uid_t m_owner = 0;
+    gid_t m_group = 0;
+    std::vector<Client> m_clients;
+#else
+    static std::string defaultPath() { return ""; }
+
+    bool start(const std::string&) {
+        log("The control socket is not available on Windows");
+        return false;
+    }
+
+    void stop() {}
+
+    void poll(int timeout_ms) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+    }
+#endif
+
+    bool m_quit = false;
+};
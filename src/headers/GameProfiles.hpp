@@ -0,0 +1,331 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "json.hpp"
+#include "asynclog.hpp"
+#include "Globals.hpp"
+#include "logzz.hpp"
+#include "metrics.hpp"
+
+// Per-game macro settings. Macros read their binds and timings from a
+// MacroProfile: an immutable table built ahead of time from the global
+// settings, plus one per place/universe profile in profiles.json (overrides
+// on top of the global settings). When the detected game changes, the active
+// table is swapped with one atomic store, so the macro loop and the
+// speedglitch threads never lock or look anything up by name. Replaced
+// tables are freed after a grace period, long after any reader let go.
+
+inline const char* PROFILES_FILE = "profiles.json";
+
+// Index of every bind in a MacroProfile, in the order of bind_names
+enum MacroBind {
+    BIND_FREEZE = 0,
+    BIND_LAUGH,
+    BIND_E_DANCE,
+    BIND_LAG_SWITCH,
+    BIND_BUCKEY_CLIP,
+    BIND_SPEEDGLITCH,
+    BIND_SPAM_KEY,
+    BIND_DISABLE_HEAD_COLLISION,
+    BIND_NHC_ROOF,
+    BIND_HHJ,
+    BIND_GEAR_DESYNC,
+    BIND_FULL_GEAR_DESYNC,
+    BIND_FLOOR_BOUNCE_HIGH_JUMP,
+    BIND_COUNT
+};
+
+// Keys of the Binds map
+inline const char* bind_names[BIND_COUNT] = {
+    "Freeze", "Laugh", "E-Dance", "Lag-switch", "Buckey-clip", "Speedglitch", "Spam-Key",
+    "Disable-Head-Collision", "NHC-Roof", "HHJ", "Gear-Desync", "Full-Gear-Desync", "Floor-Bounce-High-Jump",
+};
+
+struct MacroProfile {
+    std::string name = "Global";
+    CrossInput::Key binds[BIND_COUNT] = {};
+
+    //-- Helicopter high jump
+    int hhj_length = 243;
+    int hhj_freeze_delay = 0;
+    int hhj_delay1 = 9;
+    int hhj_delay2 = 17;
+    int hhj_delay3 = 16;
+    bool hhj_auto_timing = false;
+    bool hhj_fast_mode = false;
+
+    //-- Speedglitch (speed_pixels follow from the sensitivity and camfix)
+    float roblox_sensitivity = 0.5f;
+    bool cam_fix_active = false;
+    int roblox_fps = 60;
+    int speed_pixels_x = 716;
+    int speed_pixels_y = -716;
+};
+
+// Every table built from one version of the settings; replaced as a whole
+struct MacroProfileSet {
+    MacroProfile global;
+    std::map<uint64_t, MacroProfile> places;
+    std::map<uint64_t, MacroProfile> universes;
+};
+
+inline nlohmann::json game_profiles = nlohmann::json::object();  // profiles.json: {"places": {...}, "universes": {...}}
+inline std::unique_ptr<MacroProfileSet> macro_profiles;
+inline std::atomic<const MacroProfile*> active_macro_profile(nullptr);
+inline uint64_t profile_place_ID = 0;
+inline uint64_t profile_universe_ID = 0;
+
+// Sets that were replaced, kept until no macro can still be using them
+struct RetiredProfiles {
+    std::unique_ptr<MacroProfileSet> set;
+    uint64_t retired_ns;
+};
+inline std::vector<RetiredProfiles> retired_macro_profiles;
+inline const uint64_t PROFILE_GRACE_NS = 5000000000ULL;
+
+// The table the macros use right now
+inline const MacroProfile& macroProfile() {
+    return *active_macro_profile.load(std::memory_order_acquire);
+}
+
+// Pixels of a 180° camera turn
+inline int speedglitchPixels(float sensitivity, bool cam_fix) {
+    float base_value = cam_fix ? 500.0f : 360.0f;
+    float multiplier = (359.0f / 360.0f) * (359.0f / 360.0f); // Slight adjustment for accuracy
+    return static_cast<int>(std::round((base_value / sensitivity) * multiplier));
+}
+
+inline MacroProfile globalMacroProfile() {
+    MacroProfile profile;
+    for (int i = 0; i < BIND_COUNT; ++i) {
+        auto bind = Binds.find(bind_names[i]);
+        if (bind != Binds.end()) profile.binds[i] = bind->second;
+    }
+    profile.hhj_length = hhj_length;
+    profile.hhj_freeze_delay = hhj_freeze_delay;
+    profile.hhj_delay1 = hhj_delay1;
+    profile.hhj_delay2 = hhj_delay2;
+    profile.hhj_delay3 = hhj_delay3;
+    profile.hhj_auto_timing = hhj_auto_timing;
+    profile.hhj_fast_mode = hhj_fast_mode;
+    profile.roblox_sensitivity = roblox_sensitivity;
+    profile.cam_fix_active = cam_fix_active;
+    profile.roblox_fps = roblox_fps;
+    profile.speed_pixels_x = speed_pixels_x;
+    profile.speed_pixels_y = speed_pixels_y;
+    return profile;
+}
+
+inline nlohmann::json macroProfileToJson(const MacroProfile& profile) {
+    nlohmann::json j = {
+        {"name", profile.name},
+        {"hhj_length", profile.hhj_length},
+        {"hhj_freeze_delay", profile.hhj_freeze_delay},
+        {"hhj_delay1", profile.hhj_delay1},
+        {"hhj_delay2", profile.hhj_delay2},
+        {"hhj_delay3", profile.hhj_delay3},
+        {"hhj_auto_timing", profile.hhj_auto_timing},
+        {"hhj_fast_mode", profile.hhj_fast_mode},
+        {"roblox_sensitivity", profile.roblox_sensitivity},
+        {"cam_fix_active", profile.cam_fix_active},
+        {"roblox_fps", profile.roblox_fps},
+    };
+    for (int i = 0; i < BIND_COUNT; ++i) {
+        j["binds"][bind_names[i]] = static_cast<unsigned int>(profile.binds[i]);
+    }
+    return j;
+}
+
+// A profile from profiles.json; keys it leaves out keep their value in `base`
+inline MacroProfile macroProfileFromJson(const nlohmann::json& j, MacroProfile base) {
+    MacroProfile profile = base;
+    profile.name = j.value("name", profile.name);
+    if (j.contains("binds") && j["binds"].is_object()) {
+        for (int i = 0; i < BIND_COUNT; ++i) {
+            if (j["binds"].contains(bind_names[i])) {
+                profile.binds[i] = static_cast<CrossInput::Key>(j["binds"][bind_names[i]].get<unsigned int>());
+            }
+        }
+    }
+    profile.hhj_length = j.value("hhj_length", profile.hhj_length);
+    profile.hhj_freeze_delay = j.value("hhj_freeze_delay", profile.hhj_freeze_delay);
+    profile.hhj_delay1 = j.value("hhj_delay1", profile.hhj_delay1);
+    profile.hhj_delay2 = j.value("hhj_delay2", profile.hhj_delay2);
+    profile.hhj_delay3 = j.value("hhj_delay3", profile.hhj_delay3);
+    profile.hhj_auto_timing = j.value("hhj_auto_timing", profile.hhj_auto_timing);
+    profile.hhj_fast_mode = j.value("hhj_fast_mode", profile.hhj_fast_mode);
+    profile.roblox_sensitivity = std::max(j.value("roblox_sensitivity", profile.roblox_sensitivity), 0.1f);
+    profile.cam_fix_active = j.value("cam_fix_active", profile.cam_fix_active);
+    profile.roblox_fps = std::max(j.value("roblox_fps", profile.roblox_fps), 1);
+    profile.speed_pixels_x = speedglitchPixels(profile.roblox_sensitivity, profile.cam_fix_active);
+    profile.speed_pixels_y = -profile.speed_pixels_x;
+    return profile;
+}
+
+// Point the macros at the table of this place (or else its universe, or
+// else the global settings)
+inline void selectMacroProfile(uint64_t place_ID, uint64_t universe_ID) {
+    if (!macro_profiles) return;
+    const MacroProfile* profile = &macro_profiles->global;
+    auto place = macro_profiles->places.find(place_ID);
+    auto universe = macro_profiles->universes.find(universe_ID);
+    if (place_ID != 0 && place != macro_profiles->places.end()) {
+        profile = &place->second;
+    } else if (universe_ID != 0 && universe != macro_profiles->universes.end()) {
+        profile = &universe->second;
+    }
+    profile_place_ID = place_ID;
+    profile_universe_ID = universe_ID;
+
+    active_macro_profile.store(profile, std::memory_order_release);
+}
+
+// Called from the main loop: follows the detected game
+inline void macroProfileTick(uint64_t place_ID, uint64_t universe_ID) {
+    if (place_ID != profile_place_ID || universe_ID != profile_universe_ID) {
+        static metrics::Histogram& switch_time = metrics::get("Profile switch");
+        uint64_t start_ns = metrics::now_ns();
+        selectMacroProfile(place_ID, universe_ID);
+        switch_time.record(metrics::now_ns() - start_ns);
+        if (macro_profiles) {
+            asynclog::write(asynclog::Level::Info, "[profiles] Place %llu: %s profile",
+                            static_cast<unsigned long long>(place_ID), macroProfile().name.c_str());
+        }
+    }
+}
+
+// Rebuild every table from the global settings and game_profiles. Call it
+// after changing a bind, HHJ timing, the sensitivity, camfix or the FPS.
+inline void rebuildMacroProfiles() {
+    auto set = std::make_unique<MacroProfileSet>();
+    set->global = globalMacroProfile();
+    auto buildSection = [&set](const char* section, std::map<uint64_t, MacroProfile>& tables) {
+        if (!game_profiles.contains(section)) return;
+        for (const auto& [id, overrides] : game_profiles[section].items()) {
+            try {
+                MacroProfile profile = macroProfileFromJson(overrides, set->global);
+                if (!overrides.contains("name")) profile.name = id;
+                tables[std::stoull(id)] = profile;
+            } catch (const std::exception& e) {
+                asynclog::write(asynclog::Level::Warn, "[profiles] Skipping %s %s: %s", section, id.c_str(), e.what());
+            }
+        }
+    };
+    buildSection("places", set->places);
+    buildSection("universes", set->universes);
+
+    uint64_t now_ns = metrics::now_ns();
+    for (size_t i = retired_macro_profiles.size(); i-- > 0;) {
+        if (now_ns - retired_macro_profiles[i].retired_ns > PROFILE_GRACE_NS) {
+            retired_macro_profiles.erase(retired_macro_profiles.begin() + i);
+        }
+    }
+    if (macro_profiles) retired_macro_profiles.push_back({std::move(macro_profiles), now_ns});
+    macro_profiles = std::move(set);
+    selectMacroProfile(profile_place_ID, profile_universe_ID);
+}
+
+inline void saveMacroProfiles() {
+    std::ofstream file(PROFILES_FILE);
+    file << game_profiles.dump(4);
+}
+
+// Reads profiles.json (if there is one) and builds the tables
+inline void loadMacroProfiles() {
+    std::ifstream file(PROFILES_FILE);
+    if (file.is_open()) {
+        try {
+            file >> game_profiles;
+        } catch (const std::exception& e) {
+            asynclog::write(asynclog::Level::Warn, "[profiles] Cannot read %s: %s", PROFILES_FILE, e.what());
+            game_profiles = nlohmann::json::object();
+        }
+    }
+    rebuildMacroProfiles();
+    asynclog::write(asynclog::Level::Info, "[profiles] %zu place and %zu universe profile(s) loaded",
+                    macro_profiles->places.size(), macro_profiles->universes.size());
+}
+
+// Store the current global settings as the profile of a place or universe
+inline void saveMacroProfileFor(bool universe, uint64_t id, const std::string& name) {
+    MacroProfile profile = globalMacroProfile();
+    profile.name = name;
+    game_profiles[universe ? "universes" : "places"][std::to_string(id)] = macroProfileToJson(profile);
+    saveMacroProfiles();
+    rebuildMacroProfiles();
+}
+
+inline void removeMacroProfileFor(bool universe, const std::string& id) {
+    const char* section = universe ? "universes" : "places";
+    if (game_profiles.contains(section)) game_profiles[section].erase(id);
+    saveMacroProfiles();
+    rebuildMacroProfiles();
+}
+
+// "Game profiles" section of the Roblox tab
+inline void renderGameProfiles() {
+    static std::map<uint64_t, std::string> place_names;    // by universe, appStorage.json is slow to read
+    uint64_t place_ID = logzz::current_place_ID;
+    uint64_t universe_ID = logzz::current_universe_ID;
+
+    ImGui::Text("Active: %s", macroProfile().name.c_str());
+    ImGui::TextWrapped("A profile stores the current binds, HHJ timings, sensitivity, camfix and FPS, and replaces "
+                       "them while its place or game is played. Edits in the other tabs change the global settings.");
+
+    if (place_ID != 0) {
+        auto name = place_names.find(universe_ID);
+        if (name == place_names.end()) {
+            name = place_names.emplace(universe_ID, logzz::find_name_for_universe(universe_ID)).first;
+        }
+        std::string label = name->second.empty() ? std::to_string(place_ID) : name->second;
+
+        if (ImGui::Button("Save for this place")) {
+            saveMacroProfileFor(false, place_ID, label);
+        }
+        ImGui::SameLine();
+        if (universe_ID != 0 && ImGui::Button("Save for this game")) {
+            saveMacroProfileFor(true, universe_ID, label);
+        }
+    } else {
+        ImGui::TextDisabled("Join a game to save a profile for it");
+    }
+
+    const char* sections[][2] = {{"places", "place"}, {"universes", "game"}};
+    if (ImGui::BeginTable("GameProfiles", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+        ImGui::TableSetupColumn("Profile");
+        ImGui::TableSetupColumn("For");
+        ImGui::TableSetupColumn("");
+        ImGui::TableHeadersRow();
+
+        // Removing rebuilds game_profiles, so it waits until the table is drawn
+        std::string remove_section, remove_id;
+        for (const auto& [section, kind] : sections) {
+            if (!game_profiles.contains(section)) continue;
+            for (const auto& [id, profile] : game_profiles[section].items()) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(profile.value("name", id).c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%s %s", kind, id.c_str());
+                ImGui::TableNextColumn();
+                ImGui::PushID((std::string(section) + id).c_str());
+                if (ImGui::SmallButton("Remove")) {
+                    remove_section = section;
+                    remove_id = id;
+                }
+                ImGui::PopID();
+            }
+        }
+        ImGui::EndTable();
+
+        if (!remove_id.empty()) removeMacroProfileFor(remove_section == "universes", remove_id);
+    }
+}
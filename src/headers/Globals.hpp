@@ -82,6 +82,11 @@ inline bool cam_fix_active = false;
 inline ImVec4 themeColor = ImVec4(0.8f, 0.1f, 0.1f, 1.0f); // Default red theme
 inline std::string roblox_process_name;
 inline CrossInput::Key ChatKey = CrossInput::Key::Slash;
+inline CrossInput::Key RecordKey = CrossInput::Key::F10;   // starts/stops the input recorder
+
+//-- Chat commands
+inline int chat_open_delay_ms = 40;                    // Time for the chat box to take focus
+inline std::map<std::string, int> chat_key_delay_us;   // Per macro, 0 or missing = one client frame
 
 // Roblox tab
 inline char placeIdBuffer[32] = "";  // buffer for Place ID input
@@ -143,4 +148,4 @@ inline std::map<std::string, CrossInput::Key> Binds = {
 };
 
 inline unsigned short kb_layout;
-inline const char* string_kb_layouts[] = {"US", "FR"};
+inline const char* string_kb_layouts[] = {"US", "FR", "DE", "UK"};
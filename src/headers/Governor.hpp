@@ -0,0 +1,227 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Globals.hpp"
+#include "Helper.hpp"
+#include "Instances.hpp"
+#include "Performance.hpp"
+#include "PrivilegedHelper.hpp"
+#include "procctrl.hpp"
+#include "trace.hpp"
+
+// Keeps background clients from starving the one in front. Either caps them
+// through their app cgroup (cpu.max, memory.high), or duty-cycles them:
+// frozen most of the time and thawed for a short slice every period, which
+// keeps them connected at a fraction of the CPU. A client is in front from
+// the moment one of its windows gets the focus until another client gets it.
+
+enum GovernorMode { GOVERNOR_LIMIT = 0, GOVERNOR_DUTY_CYCLE = 1 };
+
+inline bool governor_enabled = false;
+inline int governor_mode = GOVERNOR_LIMIT;
+inline int governor_cpu_percent = 10;       // cpu.max of a background client, % of all CPUs
+inline int governor_memory_high_mb = 0;     // memory.high of a background client (0 = no limit)
+inline int governor_run_ms = 20;            // duty cycle: thawed for run_ms...
+inline int governor_period_ms = 250;        // ...out of every period_ms
+
+// Client in front (instance PID), 0 until a client had the focus
+inline pid_t governor_focused = 0;
+// cgroups the limits are currently written to
+inline std::set<std::string> governor_limited;
+
+inline std::mutex governor_mutex;
+inline std::condition_variable governor_wake;
+inline std::vector<pid_t> governor_duty_targets;
+inline unsigned int governor_generation = 0;    // bumped when the targets change
+inline bool governor_worker_running = false;
+inline std::thread governor_worker;
+
+#ifndef _WIN32
+// PID of a process inside its own PID namespace (last NSpid field).
+// Flatpak clients report this one in _NET_WM_PID.
+inline pid_t namespacePid(pid_t pid) {
+    std::ifstream status("/proc/" + std::to_string(pid) + "/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "NSpid:") == 0) {
+            return static_cast<pid_t>(atoi(line.c_str() + line.find_last_of(" \t") + 1));
+        }
+    }
+    return pid;
+}
+#endif
+
+// The client whose process tree owns `window_pid` (0 if none). Sandboxed
+// clients can share a namespace PID; then `ambiguous` is set.
+inline pid_t instanceOwning(pid_t window_pid, const std::vector<pid_t>& clients, bool& ambiguous) {
+    ambiguous = false;
+    if (window_pid == 0 || clients.empty()) return 0;
+
+    procctrl::ProcessSnapshot snapshot = procctrl::ProcessSnapshot::take();
+    pid_t owner = 0;
+    int matches = 0;
+    for (pid_t client : clients) {
+        for (pid_t member : snapshot.tree(client)) {
+            if (member == window_pid) return client;
+#ifndef _WIN32
+            if (namespacePid(member) == window_pid) {
+                owner = client;
+                ++matches;
+                break;
+            }
+#endif
+        }
+    }
+    ambiguous = matches > 1;
+    return ambiguous ? 0 : owner;
+}
+
+#ifndef _WIN32
+inline void governorLimit(const std::string& cgroup, bool limit) {
+    if (limit) {
+        writeCgroupValue(cgroup, "cpu.max", cpuMaxValue(governor_cpu_percent));
+        writeCgroupValue(cgroup, "memory.high", governor_memory_high_mb > 0
+                ? std::to_string(governor_memory_high_mb * 1024LL * 1024LL) : std::string("max"));
+        governor_limited.insert(cgroup);
+    } else {
+        // Back to what the performance profile asks for
+        writeCgroupValue(cgroup, "cpu.max", cpuMaxValue(activePerformanceProfile().cpu_max_percent));
+        writeCgroupValue(cgroup, "memory.high", "max");
+        governor_limited.erase(cgroup);
+    }
+}
+#endif
+
+// Freeze/thaw loop of the duty cycle
+inline void governorDutyLoop() {
+    TRACE_THREAD_NAME("governor");
+    std::unique_lock<std::mutex> lock(governor_mutex);
+    while (governor_worker_running) {
+        std::vector<pid_t> targets = governor_duty_targets;
+        unsigned int generation = governor_generation;
+        auto changed = [generation] { return !governor_worker_running || governor_generation != generation; };
+
+        // A macro's freeze takes precedence over the duty cycle
+        if (targets.empty() || targets_frozen) {
+            governor_wake.wait_for(lock, std::chrono::milliseconds(50), changed);
+            continue;
+        }
+        int run_ms = std::clamp(governor_run_ms, 1, governor_period_ms);
+        int frozen_ms = governor_period_ms - run_ms;
+
+        lock.unlock();
+        setProcessesSuspended(targets, true);
+        lock.lock();
+        governor_wake.wait_for(lock, std::chrono::milliseconds(frozen_ms), changed);
+        lock.unlock();
+
+        if (targets_frozen) {
+            // Leave what the macro froze to its own resume
+            std::lock_guard<std::mutex> instances_lock(instances_mutex);
+            if (selected_instances.empty()) targets.clear();
+            targets.erase(std::remove_if(targets.begin(), targets.end(),
+                                         [](pid_t pid) { return selected_instances.count(pid) != 0; }),
+                          targets.end());
+        }
+        setProcessesSuspended(targets, false);
+
+        lock.lock();
+        governor_wake.wait_for(lock, std::chrono::milliseconds(run_ms), changed);
+    }
+}
+
+inline void governorSetDutyTargets(const std::vector<pid_t>& targets, bool run) {
+    {
+        std::lock_guard<std::mutex> lock(governor_mutex);
+        if (targets != governor_duty_targets) {
+            governor_duty_targets = targets;
+            ++governor_generation;
+        }
+        governor_worker_running = run;
+    }
+    governor_wake.notify_all();
+
+    if (run && !governor_worker.joinable()) {
+        governor_worker = std::thread(governorDutyLoop);
+    } else if (!run && governor_worker.joinable()) {
+        governor_worker.join();
+    }
+}
+
+// Called from the main loop with the PID owning the focused window (0 if unknown)
+inline void governorTick(pid_t window_pid) {
+    TRACE_SCOPE("governor", "tick");
+    static pid_t last_window_pid = 0;
+    static std::vector<pid_t> last_clients;
+    static std::pair<int, int> applied_limits;
+
+    std::vector<std::pair<pid_t, std::string>> clients;
+    std::vector<pid_t> client_pids;
+    {
+        std::lock_guard<std::mutex> lock(instances_mutex);
+        for (const RobloxInstance& instance : instances) {
+            clients.emplace_back(instance.pid, instance.cgroup);
+            client_pids.push_back(instance.pid);
+        }
+    }
+
+    if (window_pid != last_window_pid || client_pids != last_clients) {
+        bool ambiguous;
+        pid_t owner = instanceOwning(window_pid, client_pids, ambiguous);
+        if (owner != 0) governor_focused = owner;
+        if (std::find(client_pids.begin(), client_pids.end(), governor_focused) == client_pids.end()) {
+            governor_focused = 0;
+        }
+        last_window_pid = window_pid;
+        last_clients = client_pids;
+    }
+
+    std::vector<std::pair<pid_t, std::string>> background;
+    if (governor_enabled && governor_focused != 0) {
+        for (const auto& client : clients) {
+            if (client.first != governor_focused) background.push_back(client);
+        }
+    }
+
+#ifndef _WIN32
+    std::set<std::string> limit;
+    if (governor_mode == GOVERNOR_LIMIT) {
+        for (const auto& client : background) {
+            if (procctrl::uses_cgroup_freeze(client.second)) limit.insert(client.second);
+        }
+    }
+    std::set<std::string> limited = governor_limited;
+    for (const std::string& cgroup : limited) {
+        if (!limit.count(cgroup)) governorLimit(cgroup, false);
+    }
+    std::pair<int, int> limits(governor_cpu_percent, governor_memory_high_mb);
+    for (const std::string& cgroup : limit) {
+        if (!governor_limited.count(cgroup) || limits != applied_limits) governorLimit(cgroup, true);
+    }
+    applied_limits = limits;
+#endif
+
+    std::vector<pid_t> duty_targets;
+    if (governor_mode == GOVERNOR_DUTY_CYCLE) {
+        for (const auto& client : background) duty_targets.push_back(client.first);
+    }
+    governorSetDutyTargets(duty_targets, governor_enabled && governor_mode == GOVERNOR_DUTY_CYCLE);
+}
+
+// Thaw and lift everything before exiting
+inline void governorShutdown() {
+    governorSetDutyTargets({}, false);
+#ifndef _WIN32
+    std::set<std::string> limited = governor_limited;
+    for (const std::string& cgroup : limited) governorLimit(cgroup, false);
+#endif
+}
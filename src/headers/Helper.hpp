@@ -38,8 +38,14 @@
 #include <string>
 #include <cstdlib>
 #include <algorithm>
+#include <map>
+#include <cstdarg>
 #include "Globals.hpp"
+#include "GameProfiles.hpp"
 #include "inpctrl.hpp"
+#include "asynclog.hpp"
+#include "metrics.hpp"
+#include "MacroBackend.hpp"
 
 inline bool isElevated() {
 #if defined(_WIN32)
@@ -117,7 +123,8 @@ inline bool TryElevate(const char* password)
     if (testResult != 0)
         return false;
 
-    // Password is correct, now elevate and restart
+    // Password is correct, now elevate and restart (root needs the X server opened)
+    runXhostPlus();
     std::string cmd =
         "echo \"" + std::string(password) + "\" | sudo -S -p '' \"" + std::string(exePath) + "\" &";
     system(cmd.c_str());
@@ -195,65 +202,23 @@ inline bool isProcessRunning(const std::string& nameSubstring) {
 #endif
 }
 
-inline void restartRoblox() {
-#ifdef _WIN32
-    // Windows version
-    system("taskkill /IM RobloxPlayerBeta.exe /F"); // forcibly close
-
-    std::string url;
-    bool hasPlaceId = strlen(placeIdBuffer) > 0;
-    bool hasInstanceId = strlen(instanceIdBuffer) > 0;
-
-    if (hasPlaceId) {
-        url = "roblox://experiences/start?placeId=" + std::string(placeIdBuffer);
-        if (hasInstanceId) {
-            url += "&gameInstanceId=" + std::string(instanceIdBuffer);
-        }
-    } else {
-        url = "roblox://";
-    }
-
-    ShellExecuteA(nullptr, "open", url.c_str(), nullptr, nullptr, SW_SHOWNORMAL);
-#else
-    const char* normalUser = getenv("SUDO_USER");
-    if (!normalUser) normalUser = getenv("USER"); // fallback if not using sudo
-
-    if (normalUser) {
-        // Kill the actual Sober process
-        std::string killCmd = "sudo -i -u ";
-        killCmd += normalUser;
-        killCmd += " bash -c 'killall -9 sober.real >/dev/null 2>&1'";
-        std::system(killCmd.c_str());
-
-        std::string url;
-        bool hasPlaceId = strlen(placeIdBuffer) > 0;
-        bool hasInstanceId = strlen(instanceIdBuffer) > 0;
-
-        if (hasPlaceId) {
-            url = "roblox://experiences/start?placeId=" + std::string(placeIdBuffer);
-            if (hasInstanceId) {
-                url += "&gameInstanceId=" + std::string(instanceIdBuffer);
-            }
-
-            // Launch with xdg-open
-            std::string launchCmd = "sudo -i -u ";
-            launchCmd += normalUser;
-            launchCmd += " bash -c 'xdg-open \"" + url + "\" &'";
-            std::system(launchCmd.c_str());
-        } else {
-            // Restart Sober normally (no place ID)
-            std::string runCmd = "sudo -i -u ";
-            runCmd += normalUser;
-            runCmd += " bash -c 'flatpak run org.vinegarhq.Sober &'";
-            std::system(runCmd.c_str());
-        }
-    }
-#endif
+// Queues a line for the async logger; the terminal/file write happens on its drain thread
+inline void log(const std::string& text) {
+    asynclog::write(asynclog::Level::Info, "[3RU] %s", text.c_str());
 }
 
-
-inline void log(std::string text) {
-    std::cout << "[3RU] " << text << std::endl;
+// printf-style variant for hot paths, builds no std::string
+#if defined(__GNUC__)
+__attribute__((format(printf, 1, 2)))
+#endif
+inline void logfmt(const char* fmt, ...) {
+    char prefixed[256];
+    snprintf(prefixed, sizeof(prefixed), "[3RU] %s", fmt);
+
+    va_list args;
+    va_start(args, fmt);
+    asynclog::vwrite(asynclog::Level::Info, prefixed, args);
+    va_end(args);
 }
 
 inline void RunSilent(const std::string &cmd) {
@@ -265,18 +230,75 @@ inline void RunSilent(const std::string &cmd) {
     system(finalCmd.c_str());
 }
 
-inline void typeSlashAzerty() {
-    input.holdKey(CrossInput::Key::LShift);
-    std::this_thread::sleep_for(std::chrono::milliseconds(25));
+// Delay between chat text frames for a macro: its calibrated value, or one client frame
+inline int chatKeyDelayUs(const std::string& macro_name) {
+    auto it = chat_key_delay_us.find(macro_name);
+    if (it != chat_key_delay_us.end() && it->second > 0) {
+        return it->second;
+    }
+    return 1000000 / std::max(roblox_fps, 1);
+}
+
+// Opens the chat and sends a command (Enter included) for the active keyboard layout.
+// Each command is compiled once per layout and reused afterwards.
+inline bool sendChatCommand(const std::string& macro_name, const std::string& command) {
+    static std::map<std::pair<unsigned short, std::string>, CrossInput::CompiledText> compiled;
+
+    auto cache_key = std::make_pair(kb_layout, command);
+    auto it = compiled.find(cache_key);
+    if (it == compiled.end()) {
+        CrossInput::CompiledText text;
+        if (!CrossInput::compileText(command + "\n", static_cast<CrossInput::Layout>(kb_layout), text)) {
+            log("Chat command '" + command + "' cannot be typed on layout " + string_kb_layouts[kb_layout]);
+            return false;
+        }
+        it = compiled.emplace(cache_key, std::move(text)).first;
+    }
+
+    int delay_us = chatKeyDelayUs(macro_name);
 
-    input.holdKey(CrossInput::Key::Dot);
-    std::this_thread::sleep_for(std::chrono::milliseconds(65));
+    macro_backend->holdKey(ChatKey);
+    macro_backend->sleepFor(std::chrono::microseconds(delay_us));
+    macro_backend->releaseKey(ChatKey);
+    macro_backend->sleepFor(std::chrono::milliseconds(chat_open_delay_ms));
 
-    input.releaseKey(CrossInput::Key::Dot);
-    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    macro_backend->typeCompiled(it->second, delay_us);
+    return true;
+}
+
+// Speedglitch mouse flick, timed into the "moveMouse emit" histogram
+inline void emitTimedMouseMove(int dx) {
+    static metrics::Histogram& emit_latency = metrics::get("moveMouse emit");
+    metrics::ScopedTimer timer(emit_latency);
+    macro_backend->moveMouse(dx, 0);
+}
+
+// Split one client frame (1000/fps ms) into the two whole-ms waits of a
+// speedglitch rotation. Fractional frames alternate floor and ceil.
+inline void speedglitchSleeps(int fps, int& sleep1, int& sleep2) {
+    const float EPSILON = 0.008f;
+    float delay_float = 1000.0f / static_cast<float>(fps);
+    int delay_floor = static_cast<int>(delay_float);
+    int delay_ceil = delay_floor + 1;
+    float fractional = delay_float - delay_floor;
+
+    if (fractional < 0.33f - EPSILON) {
+        sleep1 = sleep2 = delay_floor;
+    } else if (fractional > 0.66f + EPSILON) {
+        sleep1 = sleep2 = delay_ceil;
+    } else {
+        sleep1 = delay_floor;
+        sleep2 = delay_ceil;
+    }
+}
 
-    input.releaseKey(CrossInput::Key::LShift);
-    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+// One speedglitch rotation: 180 degrees one way and back, a frame apart.
+// Moves and waits go through the macro backend like any other macro step.
+inline void speedglitchRotation(const MacroProfile& profile, int sleep1, int sleep2) {
+    emitTimedMouseMove(profile.speed_pixels_x);
+    macro_backend->sleepFor(std::chrono::milliseconds(sleep1));
+    emitTimedMouseMove(profile.speed_pixels_y);
+    macro_backend->sleepFor(std::chrono::milliseconds(sleep2));
 }
 
 inline void showMessageBox(const std::string& title, const std::string& msg) {
@@ -296,8 +318,9 @@ inline void bindToMacro(std::string macro_name) {
         events[3] = true;
         CrossInput::Key userKey = input.getCurrentPressedKey(5000); // 5 sec timeout
         if (userKey != static_cast<CrossInput::Key>(0)) {
-            std::cout << "[3RU] [inpctrl] Bound: " << input.getKeyName(userKey) << std::endl;
+            log("[inpctrl] Bound: " + input.getKeyName(userKey));
             Binds[macro_name] = userKey;
+            rebuildMacroProfiles();
         }
         events[3] = false;
     }
@@ -308,7 +331,7 @@ inline void BindSpamKey() {
         events[8] = true;
         CrossInput::Key userKey = input.getCurrentPressedKey(5000); // 5 sec timeout
         if (userKey != static_cast<CrossInput::Key>(0)) {
-            std::cout << "[3RU] [inpctrl] Bound: " << input.getKeyName(userKey) << std::endl;
+            log("[inpctrl] Bound: " + input.getKeyName(userKey));
             SpamKey = userKey;
         }
         events[8] = false;
@@ -320,7 +343,7 @@ inline void BindVariable(CrossInput::Key* keyLoc) {
         events[9] = true;
         CrossInput::Key userKey = input.getCurrentPressedKey(5000); // 5 sec timeout
         if (userKey != static_cast<CrossInput::Key>(0)) {
-            std::cout << "[3RU] [inpctrl] Bound: " << input.getKeyName(userKey) << std::endl;
+            log("[inpctrl] Bound: " + input.getKeyName(userKey));
             *keyLoc = userKey;
         }
         events[9] = false;
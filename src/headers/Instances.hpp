@@ -0,0 +1,217 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Globals.hpp"
+#include "procctrl.hpp"
+#include "logzz.hpp"
+#include "PrivilegedHelper.hpp"
+#include "trace.hpp"
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <climits>
+#include <unistd.h>
+#else
+#include <cstdlib>
+#include <ctime>
+#endif
+
+// Running client instances (e.g. one per alt account), so macros can target
+// some of them instead of every process named roblox_process_name.
+// The list is refreshed every couple of seconds on its own thread: walking
+// /proc, the fds of new clients and re-reading their logs takes tens of ms,
+// which the main loop (macro hotkeys) must not wait for.
+
+struct RobloxInstance {
+    pid_t pid;
+    std::string cgroup;             // cgroup v2 path (Linux), empty if none
+    std::string log_path;           // log file of this client, empty if unknown
+    long long log_size = -1;        // size of the log when it was summarized
+    logzz::LogSummary summary;
+};
+
+inline std::mutex instances_mutex;
+inline std::vector<RobloxInstance> instances;
+// PIDs the macros freeze; empty means every process named roblox_process_name
+inline std::set<pid_t> selected_instances;
+// Set while a macro holds its targets frozen (see Governor.hpp)
+inline std::atomic<bool> targets_frozen(false);
+
+inline std::atomic<bool> instances_running(false);
+inline std::thread instances_thread;
+inline int instances_interval_ms = 2000;
+
+#ifndef _WIN32
+// The .log file a client process has open in logs_folder_path.
+// Matched by file name, because inside a Flatpak sandbox the folder can be mounted elsewhere.
+inline std::string findInstanceLog(pid_t pid) {
+    std::string fd_dir = "/proc/" + std::to_string(pid) + "/fd";
+    DIR* dir = opendir(fd_dir.c_str());
+    if (!dir) return "";
+
+    std::string found;
+    char target[PATH_MAX];
+    while (struct dirent* entry = readdir(dir)) {
+        ssize_t n = readlink((fd_dir + "/" + entry->d_name).c_str(), target, sizeof(target) - 1);
+        if (n <= 4) continue;
+        target[n] = '\0';
+        if (strcmp(target + n - 4, ".log") != 0) continue;
+
+        const char* file_name = strrchr(target, '/');
+        std::string candidate = logzz::logs_folder_path + "/" + (file_name ? file_name + 1 : target);
+        if (calculate_file_size_stat(candidate.c_str()) >= 0) {
+            found = candidate;
+            break;
+        }
+    }
+    closedir(dir);
+    return found;
+}
+#else
+// Log files are named after the client's start time ("..._20250106T120000Z_...").
+// Pick the one closest to the process creation time.
+inline std::string findInstanceLog(pid_t pid) {
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (!process) return "";
+    FILETIME creation, exit_time, kernel, user;
+    bool ok = GetProcessTimes(process, &creation, &exit_time, &kernel, &user) != 0;
+    CloseHandle(process);
+    if (!ok) return "";
+
+    ULARGE_INTEGER ticks;
+    ticks.LowPart = creation.dwLowDateTime;
+    ticks.HighPart = creation.dwHighDateTime;
+    long long started = static_cast<long long>(ticks.QuadPart / 10000000ULL) - 11644473600LL;  // unix seconds
+
+    std::string best;
+    long long best_diff = 120;  // seconds
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(logzz::logs_folder_path, ec)) {
+        std::string name = entry.path().filename().string();
+        size_t t = name.find('T');
+        while (t != std::string::npos && (t < 8 || t + 7 >= name.size() || name[t + 7] != 'Z')) {
+            t = name.find('T', t + 1);
+        }
+        if (t == std::string::npos) continue;
+
+        std::tm tm = {};
+        if (sscanf(name.c_str() + t - 8, "%4d%2d%2dT%2d%2d%2dZ", &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+                   &tm.tm_hour, &tm.tm_min, &tm.tm_sec) != 6) continue;
+        tm.tm_year -= 1900;
+        tm.tm_mon -= 1;
+        long long diff = std::llabs(static_cast<long long>(_mkgmtime(&tm)) - started);
+        if (diff < best_diff) {
+            best_diff = diff;
+            best = entry.path().string();
+        }
+    }
+    return best;
+}
+#endif
+
+// Re-enumerate the clients and re-read the logs that changed
+inline void refreshInstances() {
+    TRACE_SCOPE("instances", "refresh");
+    procctrl::ProcessSnapshot snapshot = procctrl::ProcessSnapshot::take();
+    std::vector<pid_t> pids = snapshot.find_by_name(roblox_process_name);
+
+    std::vector<RobloxInstance> previous;
+    {
+        std::lock_guard<std::mutex> lock(instances_mutex);
+        previous = instances;
+    }
+
+    std::vector<RobloxInstance> found;
+    std::set<std::string> seen_cgroups;
+    for (pid_t pid : pids) {
+        // Helper processes of a client that carry the same name
+        if (std::find(pids.begin(), pids.end(), snapshot.parent_of(pid)) != pids.end()) continue;
+
+        RobloxInstance instance;
+        instance.pid = pid;
+#ifndef _WIN32
+        instance.cgroup = procctrl::get_cgroup_v2_path(pid);
+        // One app cgroup is one client
+        if (procctrl::uses_cgroup_freeze(instance.cgroup) && !seen_cgroups.insert(instance.cgroup).second) continue;
+#endif
+
+        // A client keeps writing the log it opened; only new ones are looked up
+        auto known = std::find_if(previous.begin(), previous.end(),
+                                  [&](const RobloxInstance& other) { return other.pid == pid; });
+        if (known != previous.end() && !known->log_path.empty() &&
+            calculate_file_size_stat(known->log_path.c_str()) >= 0) {
+            instance.log_path = known->log_path;
+        } else {
+#ifndef _WIN32
+            for (pid_t member : snapshot.tree(pid)) {
+                instance.log_path = findInstanceLog(member);
+                if (!instance.log_path.empty()) break;
+            }
+#else
+            instance.log_path = findInstanceLog(pid);
+#endif
+        }
+
+        if (known != previous.end() && known->log_path == instance.log_path) {
+            instance.log_size = known->log_size;
+            instance.summary = known->summary;
+        }
+        if (!instance.log_path.empty()) {
+            long long size = calculate_file_size_stat(instance.log_path.c_str());
+            if (size != instance.log_size) {
+                instance.summary = logzz::summarize_log(instance.log_path);
+                instance.log_size = size;
+            }
+        }
+        found.push_back(instance);
+    }
+
+    std::lock_guard<std::mutex> lock(instances_mutex);
+    instances = found;
+    for (auto it = selected_instances.begin(); it != selected_instances.end();) {
+        bool running = std::any_of(instances.begin(), instances.end(),
+                                   [&](const RobloxInstance& instance) { return instance.pid == *it; });
+        it = running ? std::next(it) : selected_instances.erase(it);
+    }
+}
+
+inline void instancesLoop() {
+    TRACE_THREAD_NAME("instances");
+    while (instances_running) {
+        refreshInstances();
+        // Short steps, so instancesStop() doesn't wait a whole interval
+        for (int waited = 0; waited < instances_interval_ms && instances_running; waited += 50) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+}
+
+inline void instancesStart() {
+    if (instances_running.exchange(true)) return;
+    instances_thread = std::thread(instancesLoop);
+}
+
+inline void instancesStop() {
+    if (!instances_running.exchange(false)) return;
+    if (instances_thread.joinable()) instances_thread.join();
+}
+
+// Freeze/thaw what the macros target: the selected instances all at once,
+// or every process named process_name when none is selected
+inline int suspendTargets(const std::string& process_name, bool suspend) {
+    targets_frozen = suspend;
+    std::vector<pid_t> targets;
+    {
+        std::lock_guard<std::mutex> lock(instances_mutex);
+        targets.assign(selected_instances.begin(), selected_instances.end());
+    }
+    if (targets.empty()) {
+        return setProcessesSuspendedByName(process_name, suspend);
+    }
+    return setProcessesSuspended(targets, suspend);
+}
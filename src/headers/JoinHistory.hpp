@@ -0,0 +1,213 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include "imgui.h"
+#include "Globals.hpp"
+#include "Helper.hpp"
+#include "logzz.hpp"
+
+// Join and load times of every game joined, from the client's
+// "Report game_join_loadtime" log lines, kept per place so the effect of an
+// FPS cap, GlobalBasicSettings or a performance profile on loading can be
+// compared. Stored next to saved.json as fixed 32-byte records.
+
+inline const char* JOIN_HISTORY_FILE = "join_history.bin";
+inline const char JOIN_HISTORY_MAGIC[4] = {'H', 'S', 'J', 'H'};
+inline const uint32_t JOIN_HISTORY_VERSION = 1;
+
+struct JoinRecord {
+    uint64_t place_ID;
+    uint64_t universe_ID;
+    int64_t timestamp_ms;
+    float join_time;        // -1 if the client didn't report it
+    float load_time;
+};
+static_assert(sizeof(JoinRecord) == 32, "join_history.bin record layout");
+
+inline std::vector<JoinRecord> join_history;    // oldest first
+inline int64_t join_history_newest_ms = 0;      // newest join seen, survives clearJoinHistory
+
+struct JoinStats {
+    uint64_t place_ID = 0;
+    uint64_t universe_ID = 0;
+    int joins = 0;
+    float load_median = -1.0f, load_p90 = -1.0f;
+    float join_median = -1.0f;
+    float trend = 0.0f;             // median of the last 5 loads vs the ones before, in %
+    int64_t last_ms = 0;
+};
+
+inline bool loadJoinHistory() {
+    join_history.clear();
+    std::ifstream file(JOIN_HISTORY_FILE, std::ios::binary);
+    if (!file) return false;
+
+    char magic[4];
+    uint32_t version = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    if (!file || memcmp(magic, JOIN_HISTORY_MAGIC, sizeof(magic)) != 0 || version != JOIN_HISTORY_VERSION) {
+        log(std::string("Ignoring ") + JOIN_HISTORY_FILE + ": unknown format");
+        return false;
+    }
+
+    JoinRecord record;
+    while (file.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        join_history.push_back(record);
+        join_history_newest_ms = std::max(join_history_newest_ms, record.timestamp_ms);
+    }
+    return true;
+}
+
+inline bool appendJoinRecord(const JoinRecord& record) {
+    bool fresh = calculate_file_size_stat(JOIN_HISTORY_FILE) <= 0;
+    std::ofstream file(JOIN_HISTORY_FILE, std::ios::binary | std::ios::app);
+    if (!file) return false;
+    if (fresh) {
+        file.write(JOIN_HISTORY_MAGIC, sizeof(JOIN_HISTORY_MAGIC));
+        file.write(reinterpret_cast<const char*>(&JOIN_HISTORY_VERSION), sizeof(JOIN_HISTORY_VERSION));
+    }
+    file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    return static_cast<bool>(file);
+}
+
+inline void clearJoinHistory() {
+    join_history.clear();
+    std::ofstream(JOIN_HISTORY_FILE, std::ios::binary | std::ios::trunc);
+}
+
+// logzz::on_join_timing. Lines come again every time the log is re-read,
+// so only joins newer than the newest one seen are kept, even after a clear.
+inline void recordJoinTiming(const logzz::JoinTiming& timing) {
+    if (timing.timestamp_ms <= join_history_newest_ms) return;
+    join_history_newest_ms = timing.timestamp_ms;
+
+    JoinRecord record;
+    record.place_ID = timing.place_ID;
+    record.universe_ID = timing.universe_ID;
+    record.timestamp_ms = timing.timestamp_ms;
+    record.join_time = static_cast<float>(timing.join_time);
+    record.load_time = static_cast<float>(timing.load_time);
+    join_history.push_back(record);
+    appendJoinRecord(record);
+    logfmt("Join of place %llu: join %.2f, load %.2f", static_cast<unsigned long long>(record.place_ID),
+           record.join_time, record.load_time);
+}
+
+inline void initJoinHistory() {
+    loadJoinHistory();
+    logzz::on_join_timing = recordJoinTiming;
+}
+
+// Value at quantile q of the reported (>= 0) values, -1 if none
+inline float joinQuantile(std::vector<float> values, float q) {
+    values.erase(std::remove_if(values.begin(), values.end(), [](float v) { return v < 0; }), values.end());
+    if (values.empty()) return -1.0f;
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(q * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+// Statistics per place, most recently joined first
+inline std::vector<JoinStats> computeJoinStats() {
+    std::map<uint64_t, std::vector<const JoinRecord*>> by_place;
+    for (const JoinRecord& record : join_history) by_place[record.place_ID].push_back(&record);
+
+    std::vector<JoinStats> stats;
+    for (const auto& [place_ID, records] : by_place) {
+        JoinStats s;
+        s.place_ID = place_ID;
+        s.universe_ID = records.back()->universe_ID;
+        s.joins = static_cast<int>(records.size());
+        s.last_ms = records.back()->timestamp_ms;
+
+        std::vector<float> loads, joins;
+        for (const JoinRecord* record : records) {
+            loads.push_back(record->load_time);
+            joins.push_back(record->join_time);
+        }
+        s.load_median = joinQuantile(loads, 0.5f);
+        s.load_p90 = joinQuantile(loads, 0.9f);
+        s.join_median = joinQuantile(joins, 0.5f);
+
+        const size_t recent = 5;
+        if (loads.size() > recent) {
+            float before = joinQuantile(std::vector<float>(loads.begin(), loads.end() - recent), 0.5f);
+            float after = joinQuantile(std::vector<float>(loads.end() - recent, loads.end()), 0.5f);
+            if (before > 0 && after >= 0) s.trend = (after - before) * 100.0f / before;
+        }
+        stats.push_back(s);
+    }
+    std::sort(stats.begin(), stats.end(), [](const JoinStats& a, const JoinStats& b) { return a.last_ms > b.last_ms; });
+    return stats;
+}
+
+// Section of the Roblox tab
+inline void renderJoinHistory() {
+    static std::map<uint64_t, std::string> place_names;    // by universe, appStorage.json is slow to read
+    static size_t computed_for = static_cast<size_t>(-1);
+    static std::vector<JoinStats> stats;
+    if (computed_for != join_history.size()) {
+        stats = computeJoinStats();
+        computed_for = join_history.size();
+    }
+
+    ImGui::Text("%zu joins recorded", join_history.size());
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Clear##JoinHistory")) {
+        clearJoinHistory();
+    }
+    if (stats.empty()) return;
+
+    auto seconds = [](float value) {
+        if (value < 0) ImGui::TextUnformatted("-");
+        else ImGui::Text("%.2f", value);
+    };
+
+    if (ImGui::BeginTable("JoinHistory", 6, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+        ImGui::TableSetupColumn("Place");
+        ImGui::TableSetupColumn("Joins");
+        ImGui::TableSetupColumn("Load p50");
+        ImGui::TableSetupColumn("Load p90");
+        ImGui::TableSetupColumn("Join p50");
+        ImGui::TableSetupColumn("Trend");
+        ImGui::TableHeadersRow();
+
+        for (const JoinStats& s : stats) {
+            auto name = place_names.find(s.universe_ID);
+            if (name == place_names.end()) {
+                name = place_names.emplace(s.universe_ID, logzz::find_name_for_universe(s.universe_ID)).first;
+            }
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            if (name->second.empty()) ImGui::Text("%llu", static_cast<unsigned long long>(s.place_ID));
+            else ImGui::TextUnformatted(name->second.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", s.joins);
+            ImGui::TableNextColumn();
+            seconds(s.load_median);
+            ImGui::TableNextColumn();
+            seconds(s.load_p90);
+            ImGui::TableNextColumn();
+            seconds(s.join_median);
+            ImGui::TableNextColumn();
+            if (s.joins <= 5) {
+                ImGui::TextUnformatted("-");
+            } else if (s.trend > 10.0f) {
+                ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "+%.0f%%", s.trend);
+            } else if (s.trend < -10.0f) {
+                ImGui::TextColored(ImVec4(0.3f, 1.0f, 0.3f, 1.0f), "%.0f%%", s.trend);
+            } else {
+                ImGui::Text("%+.0f%%", s.trend);
+            }
+            if (ImGui::IsItemHovered()) ImGui::SetTooltip("Median load of the last 5 joins vs the ones before");
+        }
+        ImGui::EndTable();
+    }
+}
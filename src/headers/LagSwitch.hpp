@@ -4,6 +4,7 @@
 #include "Globals.hpp"
 #include "inpctrl.hpp"
 #include "Helper.hpp"
+#include "GameProfiles.hpp"
 #include "netctrl.hpp"
 
 inline namespace LagSwitchNamespace {
@@ -99,7 +100,8 @@ inline namespace LagSwitchNamespace {
 }
 
 inline void LagSwitch() {
-    bool key_pressed = input.isKeyPressed(Binds["Lag-switch"]);
+    CrossInput::Key trigger = macroProfile().binds[BIND_LAG_SWITCH];
+    bool key_pressed = input.isKeyPressed(trigger);
 
     if (!key_pressed && events[4]) {
         if (LagSwitchNamespace::TrafficBlocked) {
@@ -3,10 +3,29 @@
 #include "raylib.h"
 #include <vector>
 
+// Tutorial images of the macro descriptions, embedded in the binary
+enum Sprite {
+    SPRITE_DANCE_CLIP = 0,
+    SPRITE_LAUGH,
+    SPRITE_BUCKEY,
+    SPRITE_GEAR_CLIP,
+    SPRITE_NO_HEAD,
+    SPRITE_NHC_ROOF,
+    SPRITE_GEAR_DESYNC,
+    SPRITE_COUNT
+};
+
 extern std::vector<Texture2D> LoadedTextures;
 Texture2D LoadTextureFromFile(const char* filename);
 void UnloadAllTextures();
 void registerTexture(Texture2D texture);
+
+// Starts decoding the sprites on a worker thread; returns immediately
 void LoadAllSprites();
+// The sprite's texture, uploaded on its first use (main thread only).
+// nullptr while it is still being decoded.
+const Texture2D* GetSprite(Sprite sprite);
+// Decoded embedded image (e.g. "logo.png"), empty if there is none
+Image LoadEmbeddedImage(const char* name);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,176 @@
+#pragma once
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Globals.hpp"
+#include "inpctrl.hpp"
+#include "procctrl.hpp"
+#include "Instances.hpp"
+
+// Everything a macro does to the outside world goes through a MacroBackend:
+// reading its trigger key, emitting keys and mouse motion, suspending the
+// client and waiting. Swapping the backend lets the macro catalogue run
+// against a simulator instead of the real game.
+class MacroBackend {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    virtual ~MacroBackend() = default;
+
+    virtual bool isKeyPressed(CrossInput::Key key) = 0;
+    virtual void holdKey(CrossInput::Key key) = 0;
+    virtual void releaseKey(CrossInput::Key key) = 0;
+    virtual void moveMouse(int dx, int dy) = 0;
+    virtual void typeCompiled(const CrossInput::CompiledText& text, int frameDelayUs) = 0;
+    virtual int suspend(const std::string& process_name) = 0;
+    virtual int resume(const std::string& process_name) = 0;
+
+    virtual Clock::time_point now() = 0;
+    virtual void sleepUntil(Clock::time_point deadline) = 0;
+
+    void sleepFor(std::chrono::microseconds duration) {
+        sleepUntil(now() + duration);
+    }
+
+    // Press and release a key (single tap)
+    void pressKey(CrossInput::Key key, int delayMs = 50) {
+        holdKey(key);
+        sleepFor(std::chrono::milliseconds(delayMs));
+        releaseKey(key);
+    }
+};
+
+// The real thing: CrossInput, procctrl (selected instances) and the steady clock
+class RealBackend : public MacroBackend {
+public:
+    explicit RealBackend(CrossInput& input) : m_input(input) {}
+
+    bool isKeyPressed(CrossInput::Key key) override { return m_input.isKeyPressed(key); }
+    void holdKey(CrossInput::Key key) override { m_input.holdKey(key); }
+    void releaseKey(CrossInput::Key key) override { m_input.releaseKey(key); }
+    void moveMouse(int dx, int dy) override { m_input.moveMouse(dx, dy); }
+    void typeCompiled(const CrossInput::CompiledText& text, int frameDelayUs) override {
+        m_input.typeCompiled(text, frameDelayUs);
+    }
+    int suspend(const std::string& process_name) override {
+        return suspendTargets(process_name, true);
+    }
+    int resume(const std::string& process_name) override {
+        return suspendTargets(process_name, false);
+    }
+
+    Clock::time_point now() override { return Clock::now(); }
+    void sleepUntil(Clock::time_point deadline) override { std::this_thread::sleep_until(deadline); }
+
+private:
+    CrossInput& m_input;
+};
+
+// Records every output with its timestamp instead of performing it.
+// With a virtual clock, waits complete instantly and time only moves when a
+// macro sleeps, so runs are deterministic and much faster than real time.
+// With the real clock it measures the scheduling overhead of the macro code.
+class SimBackend : public MacroBackend {
+public:
+    enum class EventType { KeyDown, KeyUp, MouseMove, Suspend, Resume };
+
+    struct Event {
+        int64_t time_us;        // since reset()
+        EventType type;
+        int code;               // key code, or dx for mouse moves
+        int value;              // dy for mouse moves
+    };
+
+    explicit SimBackend(bool virtual_clock = true) : m_virtual(virtual_clock) {
+        reset();
+    }
+
+    // Clear the recording and restart the clock at zero
+    void reset() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_events.clear();
+        m_origin = Clock::now();
+        m_virtualNow = m_origin;
+    }
+
+    // Trigger keys the macros will see as held
+    void pressTrigger(CrossInput::Key key) { std::lock_guard<std::mutex> lock(m_mutex); m_triggers.insert(key); }
+    void releaseTrigger(CrossInput::Key key) { std::lock_guard<std::mutex> lock(m_mutex); m_triggers.erase(key); }
+
+    std::vector<Event> events() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_events;
+    }
+
+    int64_t elapsedUs() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(now() - m_origin).count();
+    }
+
+    static const char* typeName(EventType type) {
+        switch (type) {
+            case EventType::KeyDown:   return "key_down";
+            case EventType::KeyUp:     return "key_up";
+            case EventType::MouseMove: return "mouse_move";
+            case EventType::Suspend:   return "suspend";
+            default:                   return "resume";
+        }
+    }
+
+    bool isKeyPressed(CrossInput::Key key) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_triggers.count(key) != 0;
+    }
+    void holdKey(CrossInput::Key key) override { record(EventType::KeyDown, static_cast<int>(key), 1); }
+    void releaseKey(CrossInput::Key key) override { record(EventType::KeyUp, static_cast<int>(key), 0); }
+    void moveMouse(int dx, int dy) override { record(EventType::MouseMove, dx, dy); }
+
+    void typeCompiled(const CrossInput::CompiledText& text, int frameDelayUs) override {
+        for (size_t i = 0; i < text.frames.size(); ++i) {
+            if (i > 0) sleepFor(std::chrono::microseconds(frameDelayUs));
+            for (unsigned char e = 0; e < text.frames[i].count; ++e) {
+                const CrossInput::KeyEvent& event = text.frames[i].events[e];
+                record(event.down ? EventType::KeyDown : EventType::KeyUp, static_cast<int>(event.key), event.down);
+            }
+        }
+    }
+
+    int suspend(const std::string&) override { record(EventType::Suspend, 0, 0); return 1; }
+    int resume(const std::string&) override { record(EventType::Resume, 0, 0); return 1; }
+
+    Clock::time_point now() override {
+        if (!m_virtual) return Clock::now();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_virtualNow;
+    }
+
+    void sleepUntil(Clock::time_point deadline) override {
+        if (!m_virtual) {
+            std::this_thread::sleep_until(deadline);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (deadline > m_virtualNow) m_virtualNow = deadline;
+    }
+
+private:
+    void record(EventType type, int code, int value) {
+        Clock::time_point t = now();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_events.push_back({std::chrono::duration_cast<std::chrono::microseconds>(t - m_origin).count(),
+                            type, code, value});
+    }
+
+    bool m_virtual;
+    std::mutex m_mutex;
+    Clock::time_point m_origin;
+    Clock::time_point m_virtualNow;
+    std::set<CrossInput::Key> m_triggers;
+    std::vector<Event> m_events;
+};
+
+inline RealBackend real_backend(input);
+// Backend used by every macro; point it at a SimBackend to simulate
+inline MacroBackend* macro_backend = &real_backend;
@@ -5,6 +5,7 @@
 #include "Speedglitch.hpp"
 #include "HHJ.hpp"
 #include "GearDesync.hpp"
+#include "MacroRecorder.hpp"
 
 inline void initMacros() {
     initSpeedglitch();
@@ -14,6 +15,7 @@ inline void initMacros() {
 
 inline void UpdateMacros() {
     if (is_elevated) {}
+    recorderHotkey();
     if (enabled[0]) freezeMacro();
     if (enabled[1]) laughClip();
     if (enabled[2]) extendedDanceClip();
@@ -0,0 +1,192 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "json.hpp"
+#include "Globals.hpp"
+#include "Helper.hpp"
+#include "MacroBackend.hpp"
+#include "MacroRun.hpp"
+
+// Records the user's own input with kernel timestamps and replays it on an
+// absolute schedule. Recordings are JSON files in recordings/ (next to
+// saved.json) with microsecond offsets, so they can be edited by hand.
+
+inline const char* RECORDINGS_DIR = "recordings";
+inline std::vector<CrossInput::RecordedEvent> last_recording;
+inline std::atomic<bool> replay_running(false);
+
+// Start/stop recording on RecordKey (polled every frame)
+inline void recorderHotkey() {
+    static bool last_key_state = false;
+    bool key_pressed = input.isKeyPressed(RecordKey);
+
+    if (key_pressed && !last_key_state) {
+        if (!input.isRecording()) {
+            input.startRecording(RecordKey);
+            log("Recording started");
+        } else {
+            last_recording = input.stopRecording();
+            logfmt("Recording stopped: %zu events", last_recording.size());
+        }
+    }
+    last_key_state = key_pressed;
+}
+
+// Names become file names in recordings/ (and the app may run as root), so
+// only [A-Za-z0-9_-] is accepted: no separators, no "..", no hidden files
+inline bool isValidRecordingName(const std::string& name) {
+    if (name.empty() || name.size() > 64) return false;
+    return std::all_of(name.begin(), name.end(), [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-';
+    });
+}
+
+inline std::string recordingPath(const std::string& name) {
+    return std::string(RECORDINGS_DIR) + "/" + name + ".json";
+}
+
+inline bool saveRecording(const std::string& name, const std::vector<CrossInput::RecordedEvent>& events) {
+    using Type = CrossInput::RecordedEvent::Type;
+
+    if (!isValidRecordingName(name)) {
+        log("Invalid recording name '" + name + "' (use letters, digits, _ and -)");
+        return false;
+    }
+
+    nlohmann::json j;
+    j["name"] = name;
+    j["format"] = 1;
+    j["events"] = nlohmann::json::array();
+    for (const auto& e : events) {
+        nlohmann::json item;
+        item["t_us"] = e.offset_us;
+        if (e.type == Type::MouseMove) {
+            item["type"] = "mouse_move";
+            item["dx"] = e.dx;
+            item["dy"] = e.dy;
+        } else {
+            item["type"] = e.type == Type::KeyDown ? "key_down" : "key_up";
+            item["key"] = static_cast<unsigned int>(e.key);
+        }
+        j["events"].push_back(item);
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(RECORDINGS_DIR, ec);
+    std::ofstream file(recordingPath(name));
+    if (!file) {
+        log("Could not write " + recordingPath(name));
+        return false;
+    }
+    file << j.dump(1);
+    log("Recording saved to " + recordingPath(name));
+    return true;
+}
+
+inline bool loadRecording(const std::string& name, std::vector<CrossInput::RecordedEvent>& events) {
+    using Type = CrossInput::RecordedEvent::Type;
+
+    if (!isValidRecordingName(name)) {
+        log("Invalid recording name '" + name + "'");
+        return false;
+    }
+
+    std::ifstream file(recordingPath(name));
+    if (!file) {
+        log("Could not open " + recordingPath(name));
+        return false;
+    }
+
+    events.clear();
+    try {
+        nlohmann::json j = nlohmann::json::parse(file);
+        for (const auto& item : j.at("events")) {
+            CrossInput::RecordedEvent e{};
+            e.offset_us = item.at("t_us").get<uint64_t>();
+            std::string type = item.at("type").get<std::string>();
+            if (type == "mouse_move") {
+                e.type = Type::MouseMove;
+                e.dx = item.value("dx", 0);
+                e.dy = item.value("dy", 0);
+            } else {
+                e.type = type == "key_down" ? Type::KeyDown : Type::KeyUp;
+                e.key = static_cast<CrossInput::Key>(item.at("key").get<unsigned int>());
+            }
+            events.push_back(e);
+        }
+    } catch (const std::exception& ex) {
+        log("Invalid recording " + recordingPath(name) + ": " + ex.what());
+        return false;
+    }
+
+    // Hand-edited files may be out of order
+    std::stable_sort(events.begin(), events.end(),
+                     [](const CrossInput::RecordedEvent& a, const CrossInput::RecordedEvent& b) {
+                         return a.offset_us < b.offset_us;
+                     });
+    return true;
+}
+
+// Names of the saved recordings, sorted
+inline std::vector<std::string> listRecordings() {
+    std::vector<std::string> names;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(RECORDINGS_DIR, ec)) {
+        if (entry.path().extension() != ".json") continue;
+        std::string name = entry.path().stem().string();
+        if (isValidRecordingName(name)) names.push_back(name);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+// Replay on the recorded offsets; keys still held at the end are released
+inline void playRecording(const std::vector<CrossInput::RecordedEvent>& events) {
+    using Type = CrossInput::RecordedEvent::Type;
+
+    MacroRun run("replay");
+    std::set<CrossInput::Key> held;
+    for (const auto& e : events) {
+        run.waitUntilUs(static_cast<long long>(e.offset_us));
+        switch (e.type) {
+            case Type::KeyDown:
+                macro_backend->holdKey(e.key);
+                held.insert(e.key);
+                break;
+            case Type::KeyUp:
+                macro_backend->releaseKey(e.key);
+                held.erase(e.key);
+                break;
+            case Type::MouseMove:
+                macro_backend->moveMouse(e.dx, e.dy);
+                break;
+        }
+    }
+    for (CrossInput::Key key : held) macro_backend->releaseKey(key);
+}
+
+// Load and replay a saved recording on a worker thread after `delay_ms`
+// (time to focus the game window)
+inline void startReplay(const std::string& name, int delay_ms) {
+    if (replay_running.exchange(true)) return;
+
+    std::vector<CrossInput::RecordedEvent> events;
+    if (!loadRecording(name, events)) {
+        replay_running = false;
+        return;
+    }
+
+    std::thread([events, delay_ms, name]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+        log("Replaying " + name);
+        playRecording(events);
+        log("Replay of " + name + " finished");
+        replay_running = false;
+    }).detach();
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <chrono>
+#include "Globals.hpp"
+#include "MacroBackend.hpp"
+#include "metrics.hpp"
+#include "trace.hpp"
+
+// Time from the physical key press (kernel event timestamp) to now
+inline void recordHotkeyLatency(CrossInput::Key trigger) {
+    static metrics::Histogram& hotkey_latency = metrics::get("Hotkey latency");
+    uint64_t pressed_ns = input.keyPressTimeNs(trigger);
+    uint64_t now_ns = metrics::now_ns();
+    if (pressed_ns != 0 && pressed_ns <= now_ns) hotkey_latency.record(now_ns - pressed_ns);
+}
+
+// One execution of a macro. Every wait() is a step: it is scheduled to end
+// `ms` after it starts, and how late it actually woke up is traced and
+// recorded in the "Macro step error" histogram. Time comes from the active
+// MacroBackend, so a simulator can run macros on a virtual clock.
+class MacroRun {
+public:
+    MacroRun(const char* name, CrossInput::Key trigger)
+        : m_name(name), m_start(macro_backend->now()) {
+        recordHotkeyLatency(trigger);
+    }
+
+    // A run not started by a hotkey (e.g. a replay started from the UI)
+    explicit MacroRun(const char* name)
+        : m_name(name), m_start(macro_backend->now()) {}
+
+    ~MacroRun() {
+        TRACE_COMPLETE("macro", m_name, toUs(m_start),
+                       toUs(macro_backend->now()) - toUs(m_start),
+                       "steps", m_steps, nullptr, 0);
+    }
+
+    MacroRun(const MacroRun&) = delete;
+    MacroRun& operator=(const MacroRun&) = delete;
+
+    void wait(int ms) {
+        waitUs(static_cast<long long>(ms) * 1000);
+    }
+
+    void waitUs(long long us) {
+        sleepTo(macro_backend->now() + std::chrono::microseconds(us));
+    }
+
+    // Sleep until `offset_us` after the start of the run. Used for absolute
+    // schedules (recordings), so lateness in one step does not shift the rest.
+    void waitUntilUs(long long offset_us) {
+        sleepTo(m_start + std::chrono::microseconds(offset_us));
+    }
+
+    const char* name() const { return m_name; }
+
+private:
+    void sleepTo(MacroBackend::Clock::time_point deadline) {
+        static metrics::Histogram& step_error = metrics::get("Macro step error");
+
+        auto begin = macro_backend->now();
+        macro_backend->sleepUntil(deadline);
+        auto woke = macro_backend->now();
+
+        long long scheduled_us = std::chrono::duration_cast<std::chrono::microseconds>(deadline - begin).count();
+        long long late_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(woke - deadline).count();
+        step_error.record_signed(late_ns);
+        TRACE_COMPLETE("macro", "wait", toUs(begin), toUs(woke) - toUs(begin),
+                       "scheduled_us", scheduled_us, "late_us", late_ns / 1000);
+        (void)scheduled_us;
+        m_steps++;
+    }
+
+    static unsigned long long toUs(std::chrono::steady_clock::time_point t) {
+        return static_cast<unsigned long long>(
+            std::chrono::duration_cast<std::chrono::microseconds>(t.time_since_epoch()).count());
+    }
+
+    const char* m_name;
+    std::chrono::steady_clock::time_point m_start;
+    int m_steps = 0;
+};
@@ -1,58 +1,55 @@
 #pragma once
 #include "Globals.hpp"
 #include "Helper.hpp"
+#include "MacroRun.hpp"
+#include "GameProfiles.hpp"
 
 inline void freezeMacro() {
-    bool key_pressed = input.isKeyPressed(Binds["Freeze"]);
+    CrossInput::Key trigger = macroProfile().binds[BIND_FREEZE];
+    bool key_pressed = macro_backend->isKeyPressed(trigger);
 
     if (key_pressed && !events[0]) {
+        recordHotkeyLatency(trigger);
         log("Freeze triggered for " + roblox_process_name);
-        procctrl::suspend_processes_by_name(roblox_process_name);
+        macro_backend->suspend(roblox_process_name);
     }
 
     if (!key_pressed && events[0]) {
         log("Unfreeze triggered for " + roblox_process_name);
-        procctrl::resume_processes_by_name(roblox_process_name);
+        macro_backend->resume(roblox_process_name);
     }
     events[0] = key_pressed;
 }
 
 inline void laughClip() {
-    bool key_pressed = input.isKeyPressed(Binds["Laugh"]);
+    CrossInput::Key trigger = macroProfile().binds[BIND_LAUGH];
+    bool key_pressed = macro_backend->isKeyPressed(trigger);
     if (key_pressed && !events[1]) {
         events[1] = true;
+        MacroRun run("laugh", trigger);
         log("Laugh clip triggered");
 
-        input.pressKey(ChatKey);
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        sendChatCommand("Laugh", "/e laugh");
 
-        if (kb_layout == 1) {
-            typeSlashAzerty();
-            input.typeText("e lqugh");
-        } else {
-            input.typeText("/e laugh");
-        }
-        input.pressKey(CrossInput::Key::Enter);
+        run.wait(248);
+        macro_backend->holdKey(CrossInput::Key::S);
+        macro_backend->suspend(roblox_process_name);
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(248));
-        input.holdKey(CrossInput::Key::S);
-        procctrl::suspend_processes_by_name(roblox_process_name);
+        run.wait(500);
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        macro_backend->resume(roblox_process_name);
 
-        procctrl::resume_processes_by_name(roblox_process_name);
+        macro_backend->holdKey(CrossInput::Key::Space);
+        macro_backend->holdKey(CrossInput::Key::LShift);
 
-        input.holdKey(CrossInput::Key::Space);
-        input.holdKey(CrossInput::Key::LShift);
+        run.wait(35);
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(35));
+        macro_backend->releaseKey(CrossInput::Key::Space);
+        macro_backend->releaseKey(CrossInput::Key::LShift);
 
-        input.releaseKey(CrossInput::Key::Space);
-        input.releaseKey(CrossInput::Key::LShift);
+        run.wait(40);
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(40));
-
-        input.releaseKey(CrossInput::Key::S);
+        macro_backend->releaseKey(CrossInput::Key::S);
 
         events[1] = false;
         log("Laugh clip finished");
@@ -60,41 +57,29 @@ inline void laughClip() {
 }
 
 inline void extendedDanceClip() {
-    bool key_pressed = input.isKeyPressed(Binds["E-Dance"]);
+    CrossInput::Key trigger = macroProfile().binds[BIND_E_DANCE];
+    bool key_pressed = macro_backend->isKeyPressed(trigger);
     if (key_pressed && !events[2]) {
         events[2] = true;
+        MacroRun run("e-dance", trigger);
         log("Extended Dance clip triggered");
 
-        input.pressKey(ChatKey);
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-
-        if (kb_layout == 1) {
-            typeSlashAzerty();
-            input.typeText("e dqnce");
-            input.holdKey(CrossInput::Key::LShift);
-            input.pressKey(CrossInput::Key::Num2);
-            input.releaseKey(CrossInput::Key::LShift);
-            std::this_thread::sleep_for(std::chrono::milliseconds(30));
-            input.pressKey(CrossInput::Key::Enter);
-        } else {
-            input.typeText("/e dance2");
-            input.pressKey(CrossInput::Key::Enter);
-        }
+        sendChatCommand("E-Dance", "/e dance2");
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(815));
+        run.wait(815);
 
-        input.holdKey(CrossInput::Key::D);
-        procctrl::suspend_processes_by_name(roblox_process_name);
+        macro_backend->holdKey(CrossInput::Key::D);
+        macro_backend->suspend(roblox_process_name);
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        run.wait(500);
 
-        procctrl::resume_processes_by_name(roblox_process_name);
+        macro_backend->resume(roblox_process_name);
 
-        input.pressKey(CrossInput::Key::LShift);
+        macro_backend->pressKey(CrossInput::Key::LShift);
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        run.wait(300);
 
-        input.releaseKey(CrossInput::Key::D);
+        macro_backend->releaseKey(CrossInput::Key::D);
 
         events[2] = false;
         log("Extended Dance clip finished");
@@ -102,46 +87,38 @@ inline void extendedDanceClip() {
 }
 
 inline void BuckeyClip() {
-    bool key_pressed = input.isKeyPressed(Binds["Buckey-clip"]);
+    CrossInput::Key trigger = macroProfile().binds[BIND_BUCKEY_CLIP];
+    bool key_pressed = macro_backend->isKeyPressed(trigger);
     if (key_pressed && !events[5]) {
         events[5] = true;
+        MacroRun run("buckey-clip", trigger);
         log("Buckey clip triggered");
 
-        input.pressKey(ChatKey);
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-
-        if (kb_layout == 1) {
-            typeSlashAzerty();
-            input.typeText("e lqugh");
-        } else {
-            input.typeText("/e laugh");
-        }
-
-        input.pressKey(CrossInput::Key::Enter);
-        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        sendChatCommand("Buckey-clip", "/e laugh");
+        run.wait(200);
 
         // --- Space key ---
-        input.holdKey(CrossInput::Key::Space);
+        macro_backend->holdKey(CrossInput::Key::Space);
 
         // Wait 31ms → S down while Space is still held
-        std::this_thread::sleep_for(std::chrono::milliseconds(31));
-        input.holdKey(CrossInput::Key::S);
+        run.wait(31);
+        macro_backend->holdKey(CrossInput::Key::S);
 
         // Wait 9ms → Shift down while Space+S are still held
-        std::this_thread::sleep_for(std::chrono::milliseconds(9));
-        input.holdKey(CrossInput::Key::LShift);
+        run.wait(9);
+        macro_backend->holdKey(CrossInput::Key::LShift);
 
         // Release Space after 74ms
-        std::this_thread::sleep_for(std::chrono::milliseconds(74));
-        input.releaseKey(CrossInput::Key::Space);
+        run.wait(74);
+        macro_backend->releaseKey(CrossInput::Key::Space);
 
         // Release Shift after 56ms
-        std::this_thread::sleep_for(std::chrono::milliseconds(56));
-        input.releaseKey(CrossInput::Key::LShift);
+        run.wait(56);
+        macro_backend->releaseKey(CrossInput::Key::LShift);
 
         // Release S after 82ms
-        std::this_thread::sleep_for(std::chrono::milliseconds(82));
-        input.releaseKey(CrossInput::Key::S);
+        run.wait(82);
+        macro_backend->releaseKey(CrossInput::Key::S);
 
         events[5] = false;
         log("Buckeyclip finished");
@@ -150,46 +127,39 @@ inline void BuckeyClip() {
 
 
 inline void SpamKeyMacro() {
-    bool key_pressed = input.isKeyPressed(Binds["Spam-Key"]);
+    CrossInput::Key trigger = macroProfile().binds[BIND_SPAM_KEY];
+    bool key_pressed = macro_backend->isKeyPressed(trigger);
     if (key_pressed && !events[7]) {
         events[7] = true;
         log("Spam key triggering");
-        input.pressKey(SpamKey, 1);
+        macro_backend->pressKey(SpamKey, 1);
         events[7] = false;
         log("Spam key finished triggering");
     }
 }
 
 inline void DisableHeadCollision() {
-    bool key_pressed = input.isKeyPressed(Binds["Disable-Head-Collision"]);
+    CrossInput::Key trigger = macroProfile().binds[BIND_DISABLE_HEAD_COLLISION];
+    bool key_pressed = macro_backend->isKeyPressed(trigger);
     if (key_pressed && !events[10]) {
         events[10] = true;
+        MacroRun run("disable-head-collision", trigger);
         log("Disable-Head-Collision triggered");
 
-        input.pressKey(ChatKey);
-        std::this_thread::sleep_for(std::chrono::milliseconds(248));
-
-        if (kb_layout == 1) {
-            typeSlashAzerty();
-            input.typeText("e lqugh");
-        } else {
-            input.typeText("/e laugh");
-        }
+        sendChatCommand("Disable-Head-Collision", "/e laugh");
+        run.wait(200);
 
-        input.pressKey(CrossInput::Key::Enter);
-        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        macro_backend->holdKey(CrossInput::Key::LShift);
+        run.wait(16);
+        macro_backend->releaseKey(CrossInput::Key::LShift);
 
-        input.holdKey(CrossInput::Key::LShift);
-        std::this_thread::sleep_for(std::chrono::milliseconds(16));
-        input.releaseKey(CrossInput::Key::LShift);
+        macro_backend->holdKey(CrossInput::Key::Space);
+        run.wait(16);
+        macro_backend->releaseKey(CrossInput::Key::Space);
 
-        input.holdKey(CrossInput::Key::Space);
-        std::this_thread::sleep_for(std::chrono::milliseconds(16));
-        input.releaseKey(CrossInput::Key::Space);
-
-        input.holdKey(CrossInput::Key::LShift);
-        std::this_thread::sleep_for(std::chrono::milliseconds(16));
-        input.releaseKey(CrossInput::Key::LShift);
+        macro_backend->holdKey(CrossInput::Key::LShift);
+        run.wait(16);
+        macro_backend->releaseKey(CrossInput::Key::LShift);
 
         events[10] = false;
         log("Disable-Head-Collision finished");
@@ -197,33 +167,23 @@ inline void DisableHeadCollision() {
 }
 
 inline void NHCRoofClip() {
-    bool key_pressed = input.isKeyPressed(Binds["NHC-Roof"]);
+    CrossInput::Key trigger = macroProfile().binds[BIND_NHC_ROOF];
+    bool key_pressed = macro_backend->isKeyPressed(trigger);
     if (key_pressed && !events[11]) {
         events[11] = true;
+        MacroRun run("nhc-roof", trigger);
         log("NHC-Roof clip triggered");
 
-        input.pressKey(ChatKey);
-        std::this_thread::sleep_for(std::chrono::milliseconds(248));
-
-        if (kb_layout == 1) {
-            typeSlashAzerty();
-            input.typeText("e cheer", 20);
-        } else {
-            input.typeText("/e cheer", 20);
-        }
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-
-        input.pressKey(CrossInput::Key::Enter);
-        std::this_thread::sleep_for(std::chrono::milliseconds(610));
+        sendChatCommand("NHC-Roof", "/e cheer");
+        run.wait(610);
 
-        input.holdKey(CrossInput::Key::Space);
-        std::this_thread::sleep_for(std::chrono::milliseconds(20));
-        procctrl::suspend_processes_by_name(roblox_process_name);
-        std::this_thread::sleep_for(std::chrono::milliseconds(300));
-        procctrl::resume_processes_by_name(roblox_process_name);
-        std::this_thread::sleep_for(std::chrono::milliseconds(20));
-        input.releaseKey(CrossInput::Key::Space);
+        macro_backend->holdKey(CrossInput::Key::Space);
+        run.wait(20);
+        macro_backend->suspend(roblox_process_name);
+        run.wait(300);
+        macro_backend->resume(roblox_process_name);
+        run.wait(20);
+        macro_backend->releaseKey(CrossInput::Key::Space);
 
         events[11] = false;
         log("NHC-Roof clip finished");
@@ -232,51 +192,55 @@ inline void NHCRoofClip() {
 
 
 inline void FullGearDesync() {
-    bool key_pressed = input.isKeyPressed(Binds["Full-Gear-Desync"]);
+    CrossInput::Key trigger = macroProfile().binds[BIND_FULL_GEAR_DESYNC];
+    bool key_pressed = macro_backend->isKeyPressed(trigger);
     if (key_pressed && !events[14]) {
         events[14] = true;
+        MacroRun run("full-gear-desync", trigger);
         log("Full Gear Desync triggered");
-        input.pressKey(CrossInput::Key::Num2);
-        std::this_thread::sleep_for(std::chrono::milliseconds(40));
-        input.pressKey(CrossInput::Key::Backspace);
-        std::this_thread::sleep_for(std::chrono::milliseconds(200));
-        input.pressKey(CrossInput::Key::Num1);
-        std::this_thread::sleep_for(std::chrono::milliseconds(40));
-        input.holdKey(CrossInput::Key::W);
-        std::this_thread::sleep_for(std::chrono::milliseconds(400));
-        procctrl::suspend_processes_by_name(roblox_process_name);
-        input.pressKey(CrossInput::Key::Num1, 30);
-        std::this_thread::sleep_for(std::chrono::milliseconds(30));
-        input.pressKey(CrossInput::Key::Num1, 30);
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        procctrl::resume_processes_by_name(roblox_process_name);
-        input.releaseKey(CrossInput::Key::W);
-        std::this_thread::sleep_for(std::chrono::milliseconds(40));
-        input.pressKey(CrossInput::Key::Num1);
-        std::this_thread::sleep_for(std::chrono::milliseconds(40));
-        input.pressKey(CrossInput::Key::Backspace);
+        macro_backend->pressKey(CrossInput::Key::Num2);
+        run.wait(40);
+        macro_backend->pressKey(CrossInput::Key::Backspace);
+        run.wait(200);
+        macro_backend->pressKey(CrossInput::Key::Num1);
+        run.wait(40);
+        macro_backend->holdKey(CrossInput::Key::W);
+        run.wait(400);
+        macro_backend->suspend(roblox_process_name);
+        macro_backend->pressKey(CrossInput::Key::Num1, 30);
+        run.wait(30);
+        macro_backend->pressKey(CrossInput::Key::Num1, 30);
+        run.wait(100);
+        macro_backend->resume(roblox_process_name);
+        macro_backend->releaseKey(CrossInput::Key::W);
+        run.wait(40);
+        macro_backend->pressKey(CrossInput::Key::Num1);
+        run.wait(40);
+        macro_backend->pressKey(CrossInput::Key::Backspace);
         events[14] = false;
         log("Full Gear Desync finished");
     }
 }
 
 inline void FloorBounceHighJump() {
-    bool key_pressed = input.isKeyPressed(Binds["Floor-Bounce-High-Jump"]);
+    CrossInput::Key trigger = macroProfile().binds[BIND_FLOOR_BOUNCE_HIGH_JUMP];
+    bool key_pressed = macro_backend->isKeyPressed(trigger);
     if (key_pressed && !events[15]) {
         events[15] = true;
+        MacroRun run("floor-bounce-high-jump", trigger);
         log("Floor bounce high jump triggered");
 
-        input.holdKey(CrossInput::Key::Space);
-        std::this_thread::sleep_for(std::chrono::milliseconds(521));  // Fall timing
-        procctrl::suspend_processes_by_name(roblox_process_name);     // Freeze to clip through floor
-        std::this_thread::sleep_for(std::chrono::milliseconds(72));   // Stay clipped
-        procctrl::resume_processes_by_name(roblox_process_name);      // Register underground position
-        std::this_thread::sleep_for(std::chrono::milliseconds(72));   // Let correction force build
-        procctrl::suspend_processes_by_name(roblox_process_name);     // Freeze the ejection force
-        std::this_thread::sleep_for(std::chrono::milliseconds(72));   // Hold the power
-        procctrl::resume_processes_by_name(roblox_process_name);      // LAUNCH
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        input.releaseKey(CrossInput::Key::Space);
+        macro_backend->holdKey(CrossInput::Key::Space);
+        run.wait(521);  // Fall timing
+        macro_backend->suspend(roblox_process_name);     // Freeze to clip through floor
+        run.wait(72);   // Stay clipped
+        macro_backend->resume(roblox_process_name);      // Register underground position
+        run.wait(72);   // Let correction force build
+        macro_backend->suspend(roblox_process_name);     // Freeze the ejection force
+        run.wait(72);   // Hold the power
+        macro_backend->resume(roblox_process_name);      // LAUNCH
+        run.wait(100);
+        macro_backend->releaseKey(CrossInput::Key::Space);
 
         events[15] = false;
         log("Floor bounce high jump finished");
@@ -0,0 +1,299 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Globals.hpp"
+#include "metrics.hpp"
+#include "procctrl.hpp"
+#include "trace.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Resource monitor for one client's process tree: CPU, memory, threads and
+// context switches, sampled on its own thread into rolling histories for the
+// Monitor tab. On Linux every file is opened once and re-read with pread(),
+// so a sample costs a few syscalls per process; a client in its own app
+// cgroup is read from cpu.stat/memory.current instead, which also counts
+// processes that already exited.
+
+inline const int MONITOR_HISTORY = 240;     // samples kept per graph
+inline int monitor_interval_ms = 250;
+
+struct MonitorHistory {
+    std::vector<float> cpu_percent;         // % of one CPU
+    std::vector<float> memory_mb;
+    std::vector<float> threads;
+    std::vector<float> ctx_switches;        // per second, voluntary + involuntary
+    int offset = 0;                         // oldest sample (ring buffer start)
+    int count = 0;
+    std::string memory_source;              // what memory_mb measures
+
+    void push(float cpu, float memory, float thread_count, float switches) {
+        if (cpu_percent.empty()) {
+            cpu_percent.assign(MONITOR_HISTORY, 0.0f);
+            memory_mb.assign(MONITOR_HISTORY, 0.0f);
+            threads.assign(MONITOR_HISTORY, 0.0f);
+            ctx_switches.assign(MONITOR_HISTORY, 0.0f);
+        }
+        int slot = (offset + count) % MONITOR_HISTORY;
+        cpu_percent[slot] = cpu;
+        memory_mb[slot] = memory;
+        threads[slot] = thread_count;
+        ctx_switches[slot] = switches;
+        if (count < MONITOR_HISTORY) ++count;
+        else offset = (offset + 1) % MONITOR_HISTORY;
+    }
+
+    // Most recent value of a series
+    float last(const std::vector<float>& series) const {
+        return count ? series[(offset + count - 1) % MONITOR_HISTORY] : 0.0f;
+    }
+};
+
+inline std::mutex monitor_mutex;
+inline MonitorHistory monitor_history;
+inline std::atomic<pid_t> monitor_target(0);    // client PID (root of the tree), 0 = idle
+inline std::atomic<bool> monitor_running(false);
+inline std::thread monitor_thread;
+
+#ifndef _WIN32
+// A /proc or cgroup file kept open and re-read from offset 0
+class SampledFile {
+public:
+    SampledFile() = default;
+    explicit SampledFile(const std::string& path) : m_fd(open(path.c_str(), O_RDONLY | O_CLOEXEC)) {}
+    SampledFile(SampledFile&& other) noexcept : m_fd(other.m_fd) { other.m_fd = -1; }
+    SampledFile& operator=(SampledFile&& other) noexcept {
+        std::swap(m_fd, other.m_fd);
+        return *this;
+    }
+    ~SampledFile() {
+        if (m_fd >= 0) close(m_fd);
+    }
+
+    bool valid() const { return m_fd >= 0; }
+
+    // Whole file into buffer, NUL terminated. False once the process is gone.
+    bool read(char* buffer, size_t size) const {
+        ssize_t n = pread(m_fd, buffer, size - 1, 0);
+        if (n <= 0) return false;
+        buffer[n] = '\0';
+        return true;
+    }
+
+private:
+    int m_fd = -1;
+};
+
+class TreeSampler {
+public:
+    struct Sample {
+        double cpu_seconds = 0.0;
+        double memory_bytes = 0.0;
+        long threads = 0;
+        unsigned long long ctx_switches = 0;
+    };
+
+    void reset(pid_t root) {
+        m_root = root;
+        m_processes.clear();
+        m_cgroup_cpu = SampledFile();
+        m_cgroup_memory = SampledFile();
+        m_tree_ns = 0;
+    }
+
+    bool usesCgroup() const { return m_cgroup_cpu.valid() && m_cgroup_memory.valid(); }
+
+    // False once the root process is gone
+    bool sample(Sample& out) {
+        uint64_t now = metrics::now_ns();
+        if (now - m_tree_ns > 2000000000ULL) refreshTree();
+        if (!m_processes.count(m_root)) return false;
+
+        char buffer[4096];
+        unsigned long long ticks = 0;
+        long rss_pages = 0;
+        for (auto it = m_processes.begin(); it != m_processes.end();) {
+            unsigned long utime = 0, stime = 0;
+            long threads = 0, rss = 0;
+            const char* fields = it->second.first.read(buffer, sizeof(buffer)) ? strrchr(buffer, ')') : nullptr;
+            if (!fields || sscanf(fields + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu %*d %*d %*d %*d %ld %*d %*u %*u %ld",
+                                  &utime, &stime, &threads, &rss) != 4) {
+                if (it->first == m_root) return false;
+                it = m_processes.erase(it);
+                continue;
+            }
+            ticks += utime + stime;
+            rss_pages += rss;
+            out.threads += threads;
+
+            if (it->second.second.read(buffer, sizeof(buffer))) {
+                out.ctx_switches += field(buffer, "\nvoluntary_ctxt_switches:") + field(buffer, "\nnonvoluntary_ctxt_switches:");
+            }
+            ++it;
+        }
+
+        if (usesCgroup() && m_cgroup_cpu.read(buffer, sizeof(buffer))) {
+            out.cpu_seconds = field(buffer, "usage_usec") / 1e6;
+        } else {
+            out.cpu_seconds = static_cast<double>(ticks) / sysconf(_SC_CLK_TCK);
+        }
+        if (usesCgroup() && m_cgroup_memory.read(buffer, sizeof(buffer))) {
+            out.memory_bytes = strtod(buffer, nullptr);
+        } else {
+            out.memory_bytes = static_cast<double>(rss_pages) * sysconf(_SC_PAGESIZE);
+        }
+        return true;
+    }
+
+private:
+    // Number after `key` in a "key value" listing
+    static unsigned long long field(const char* text, const char* key) {
+        const char* found = strstr(text, key);
+        return found ? strtoull(found + strlen(key), nullptr, 10) : 0;
+    }
+
+    void refreshTree() {
+        TRACE_SCOPE("monitor", "refresh tree");
+        std::vector<pid_t> tree = procctrl::get_process_tree(m_root);
+        std::map<pid_t, std::pair<SampledFile, SampledFile>> processes;
+        for (pid_t pid : tree) {
+            auto known = m_processes.find(pid);
+            if (known != m_processes.end()) {
+                processes.emplace(pid, std::move(known->second));
+                continue;
+            }
+            std::string dir = "/proc/" + std::to_string(pid);
+            SampledFile stat(dir + "/stat");
+            if (stat.valid()) processes.emplace(pid, std::make_pair(std::move(stat), SampledFile(dir + "/status")));
+        }
+        m_processes = std::move(processes);
+
+        if (!m_cgroup_cpu.valid()) {
+            std::string cgroup = procctrl::get_cgroup_v2_path(m_root);
+            if (procctrl::uses_cgroup_freeze(cgroup)) {
+                m_cgroup_cpu = SampledFile(cgroup + "/cpu.stat");
+                m_cgroup_memory = SampledFile(cgroup + "/memory.current");
+            }
+        }
+        m_tree_ns = metrics::now_ns();
+    }
+
+    pid_t m_root = 0;
+    std::map<pid_t, std::pair<SampledFile, SampledFile>> m_processes;  // stat, status
+    SampledFile m_cgroup_cpu;
+    SampledFile m_cgroup_memory;
+    uint64_t m_tree_ns = 0;
+};
+#else
+// Windows: CPU time and working set of the client process itself
+class TreeSampler {
+public:
+    struct Sample {
+        double cpu_seconds = 0.0;
+        double memory_bytes = 0.0;
+        long threads = 0;
+        unsigned long long ctx_switches = 0;
+    };
+
+    ~TreeSampler() { reset(0); }
+
+    void reset(pid_t root) {
+        if (m_process) CloseHandle(m_process);
+        m_process = root ? OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, root) : nullptr;
+    }
+
+    bool usesCgroup() const { return false; }
+
+    bool sample(Sample& out) {
+        if (!m_process) return false;
+        DWORD exit_code = 0;
+        if (!GetExitCodeProcess(m_process, &exit_code) || exit_code != STILL_ACTIVE) return false;
+
+        FILETIME creation, exit_time, kernel, user;
+        if (!GetProcessTimes(m_process, &creation, &exit_time, &kernel, &user)) return false;
+        auto seconds = [](const FILETIME& time) {
+            return ((static_cast<unsigned long long>(time.dwHighDateTime) << 32) | time.dwLowDateTime) / 1e7;
+        };
+        out.cpu_seconds = seconds(kernel) + seconds(user);
+
+        PROCESS_MEMORY_COUNTERS counters = {};
+        if (GetProcessMemoryInfo(m_process, &counters, sizeof(counters))) {
+            out.memory_bytes = static_cast<double>(counters.WorkingSetSize);
+        }
+        return true;
+    }
+
+private:
+    HANDLE m_process = nullptr;
+};
+#endif
+
+inline void monitorLoop() {
+    TRACE_THREAD_NAME("monitor");
+    metrics::Histogram& sample_time = metrics::get("Monitor sample");
+
+    TreeSampler sampler;
+    TreeSampler::Sample previous;
+    pid_t sampled = 0;
+    uint64_t previous_ns = 0;
+
+    while (monitor_running) {
+        pid_t target = monitor_target;
+        if (target != sampled) {
+            sampler.reset(target);
+            sampled = target;
+            previous_ns = 0;
+            std::lock_guard<std::mutex> lock(monitor_mutex);
+            monitor_history = MonitorHistory();
+        }
+
+        if (sampled != 0) {
+            TreeSampler::Sample current;
+            uint64_t start_ns = metrics::now_ns();
+            bool alive = sampler.sample(current);
+            sample_time.record(metrics::now_ns() - start_ns);
+
+            if (!alive) {
+                sampled = 0;
+                monitor_target.compare_exchange_strong(target, 0);
+            } else {
+                if (previous_ns != 0) {
+                    double elapsed = (start_ns - previous_ns) / 1e9;
+                    double cpu = std::max(0.0, current.cpu_seconds - previous.cpu_seconds) * 100.0 / elapsed;
+                    double switches = current.ctx_switches >= previous.ctx_switches
+                                    ? (current.ctx_switches - previous.ctx_switches) / elapsed : 0.0;
+                    std::lock_guard<std::mutex> lock(monitor_mutex);
+                    monitor_history.memory_source = sampler.usesCgroup() ? "memory.current" : "RSS sum";
+                    monitor_history.push(static_cast<float>(cpu), static_cast<float>(current.memory_bytes / (1024.0 * 1024.0)),
+                                         static_cast<float>(current.threads), static_cast<float>(switches));
+                }
+                previous = current;
+                previous_ns = start_ns;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(monitor_interval_ms));
+    }
+}
+
+inline void monitorStart() {
+    if (monitor_running.exchange(true)) return;
+    monitor_thread = std::thread(monitorLoop);
+}
+
+inline void monitorStop() {
+    if (!monitor_running.exchange(false)) return;
+    if (monitor_thread.joinable()) monitor_thread.join();
+}
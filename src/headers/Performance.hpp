@@ -0,0 +1,152 @@
+#pragma once
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include "json.hpp"
+#include "Globals.hpp"
+#include "Helper.hpp"
+#include "Instances.hpp"
+#include "PrivilegedHelper.hpp"
+#include "procctrl.hpp"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+// CPU placement and priorities for the Roblox client (and for hypersuite
+// itself, so its macro and input threads don't compete with the game).
+// Profiles live in saved.json; the active one is applied to every client
+// process tree that appears while "apply automatically" is on.
+
+struct PerformanceProfile {
+    uint64_t game_cpus = 0;         // affinity of the client, bit n = CPU n (0 = leave)
+    uint64_t utility_cpus = 0;      // affinity of hypersuite's own threads (0 = leave)
+    bool set_nice = false;
+    int nice = -5;                  // -20 (highest) .. 19
+    int io_class = 0;               // 0 = leave, 1 = realtime, 2 = best-effort, 3 = idle (Linux)
+    int io_level = 4;               // 0 (highest) .. 7
+    int cpu_weight = 0;             // cgroup cpu.weight 1..10000 (0 = leave, Linux)
+    int cpu_max_percent = 0;        // cgroup cpu.max in % of all CPUs (0 = leave, Linux)
+};
+
+inline std::map<std::string, PerformanceProfile> performance_profiles = {{"Default", PerformanceProfile()}};
+inline std::string active_performance_profile = "Default";
+inline bool performance_auto_apply = false;
+// Client processes the active profile was applied to
+inline std::set<pid_t> performance_applied;
+
+inline PerformanceProfile& activePerformanceProfile() {
+    return performance_profiles[active_performance_profile];
+}
+
+inline nlohmann::json performanceProfileToJson(const PerformanceProfile& profile) {
+    return {
+        {"game_cpus", profile.game_cpus},
+        {"utility_cpus", profile.utility_cpus},
+        {"set_nice", profile.set_nice},
+        {"nice", profile.nice},
+        {"io_class", profile.io_class},
+        {"io_level", profile.io_level},
+        {"cpu_weight", profile.cpu_weight},
+        {"cpu_max_percent", profile.cpu_max_percent},
+    };
+}
+
+inline PerformanceProfile performanceProfileFromJson(const nlohmann::json& j) {
+    PerformanceProfile profile;
+    profile.game_cpus = j.value("game_cpus", profile.game_cpus);
+    profile.utility_cpus = j.value("utility_cpus", profile.utility_cpus);
+    profile.set_nice = j.value("set_nice", profile.set_nice);
+    profile.nice = j.value("nice", profile.nice);
+    profile.io_class = j.value("io_class", profile.io_class);
+    profile.io_level = j.value("io_level", profile.io_level);
+    profile.cpu_weight = j.value("cpu_weight", profile.cpu_weight);
+    profile.cpu_max_percent = j.value("cpu_max_percent", profile.cpu_max_percent);
+    return profile;
+}
+
+// cgroup cpu.max value for `percent` of all CPUs ("max" when 0)
+inline std::string cpuMaxValue(int percent) {
+    const long long period_us = 100000;
+    if (percent <= 0) return "max " + std::to_string(period_us);
+    long long quota_us = std::max(1000LL, period_us * procctrl::cpu_count() * percent / 100);
+    return std::to_string(quota_us) + " " + std::to_string(period_us);
+}
+
+// Pin hypersuite's own threads (main/macros, input listener, logger) and the
+// privileged helper to the utility CPUs
+inline void applyUtilityAffinity(const PerformanceProfile& profile) {
+    if (profile.utility_cpus == 0) return;
+#ifdef _WIN32
+    SetProcessAffinityMask(GetCurrentProcess(), static_cast<DWORD_PTR>(profile.utility_cpus));
+#else
+    procctrl::set_process_affinity(getpid(), profile.utility_cpus);
+#endif
+    setHelperAffinity(profile.utility_cpus);
+}
+
+// Apply a profile to one client process tree
+inline void applyPerformanceProfile(pid_t pid, const PerformanceProfile& profile) {
+    // Affinity of the user's own processes needs no rights; priority goes through the helper
+    if (profile.game_cpus) {
+        for (pid_t member : procctrl::get_process_tree(pid)) procctrl::set_process_affinity(member, profile.game_cpus);
+    }
+    if (profile.set_nice || profile.io_class) {
+        setProcessTreePriority(pid, profile.set_nice, profile.nice, profile.io_class, profile.io_level);
+    }
+
+#ifndef _WIN32
+    // Only touch cgroups that belong to the client alone
+    std::string cgroup = procctrl::get_cgroup_v2_path(pid);
+    if (procctrl::uses_cgroup_freeze(cgroup)) {
+        if (profile.cpu_weight > 0) {
+            writeCgroupValue(cgroup, "cpu.weight", std::to_string(profile.cpu_weight));
+        }
+        if (profile.cpu_max_percent > 0) {
+            writeCgroupValue(cgroup, "cpu.max", cpuMaxValue(profile.cpu_max_percent));
+        }
+    }
+#endif
+    logfmt("[performance] Applied \"%s\" to PID %d", active_performance_profile.c_str(), static_cast<int>(pid));
+}
+
+// Apply the active profile to every client now
+inline void applyPerformanceNow() {
+    const PerformanceProfile& profile = activePerformanceProfile();
+    applyUtilityAffinity(profile);
+
+    std::vector<pid_t> pids;
+    {
+        std::lock_guard<std::mutex> lock(instances_mutex);
+        for (const RobloxInstance& instance : instances) pids.push_back(instance.pid);
+    }
+    for (pid_t pid : pids) {
+        applyPerformanceProfile(pid, profile);
+        performance_applied.insert(pid);
+    }
+}
+
+// Called after refreshInstances(): applies the profile to clients that just appeared
+inline void performanceTick() {
+    if (!performance_auto_apply || !is_elevated) return;
+
+    std::vector<pid_t> pids;
+    {
+        std::lock_guard<std::mutex> lock(instances_mutex);
+        for (const RobloxInstance& instance : instances) pids.push_back(instance.pid);
+    }
+
+    std::set<pid_t> running(pids.begin(), pids.end());
+    for (auto it = performance_applied.begin(); it != performance_applied.end();) {
+        it = running.count(*it) ? std::next(it) : performance_applied.erase(it);
+    }
+    for (pid_t pid : pids) {
+        if (performance_applied.insert(pid).second) {
+            applyUtilityAffinity(activePerformanceProfile());
+            applyPerformanceProfile(pid, activePerformanceProfile());
+        }
+    }
+}
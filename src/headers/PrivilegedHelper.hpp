@@ -0,0 +1,591 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Globals.hpp"
+#include "asynclog.hpp"
+#include "metrics.hpp"
+#include "privhelper.hpp"
+#include "procctrl.hpp"
+#include "trace.hpp"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Privileged helper: `utility --helper`, started under sudo, owns the input
+// devices and the cgroup files and freezes the clients, while the UI keeps
+// running as the user. Key injections, freezes and cgroup writes cross over
+// through privhelper's shared-memory ring; physical key events come back the
+// same way. Without a helper (already root, or Windows) all of it still runs
+// in-process.
+
+inline std::atomic<bool> helper_connected(false);
+inline bool helper_started_here = false;        // shut it down when we exit
+
+#if defined(__linux__)
+inline privhelper::Channel helper_channel;
+inline int helper_socket = -1;
+inline std::shared_mutex helper_mutex;          // exclusive while the channel is (re)mapped
+inline std::thread helper_event_thread;
+inline int helper_timeout_ms = 1000;            // wait for a freeze/cgroup write to be done
+inline volatile std::sig_atomic_t helper_signalled = 0;
+inline std::atomic<uint64_t> helper_utility_cpus(0);  // pinned on the helper too, sent again on connect
+
+// In the user's runtime dir, next to the control socket
+inline std::string helperSocketPath(uid_t uid) {
+    return "/run/user/" + std::to_string(uid) + "/hypersuite-helper.sock";
+}
+
+// Freeze settings of the UI travel with each freeze: method | confirm timeout << 8
+inline uint32_t helperFreezeOptions() {
+    return static_cast<uint32_t>(procctrl::freeze_method_override) |
+           static_cast<uint32_t>(procctrl::confirm_timeout_ms) << 8;
+}
+
+// Priority settings of OP_SET_PRIORITY: set_nice | (nice + 20) << 1 | io_class << 8 | io_level << 12
+inline uint32_t helperPriorityOptions(bool set_nice, int nice, int io_class, int io_level) {
+    return (set_nice ? 1u : 0u) | static_cast<uint32_t>(std::clamp(nice, -20, 19) + 20) << 1 |
+           static_cast<uint32_t>(std::clamp(io_class, 0, 3)) << 8 | static_cast<uint32_t>(std::clamp(io_level, 0, 7)) << 12;
+}
+
+// ---------------------------------------------------------------- helper side
+
+// Every command is checked against the uid of the connected user, so the
+// socket can't reach other users' processes or arbitrary files
+inline bool helperOwnsProcess(pid_t pid, uid_t uid) {
+    struct stat info;
+    return uid == 0 || (stat(("/proc/" + std::to_string(pid)).c_str(), &info) == 0 && info.st_uid == uid);
+}
+
+// Processes that exit meanwhile don't count, they can't be signalled anymore
+inline bool helperOwnsAll(const std::vector<pid_t>& pids, uid_t uid) {
+    if (uid == 0) return true;
+    for (pid_t pid : pids) {
+        struct stat info;
+        if (stat(("/proc/" + std::to_string(pid)).c_str(), &info) != 0) {
+            if (errno == ENOENT) continue;
+            return false;
+        }
+        if (info.st_uid != uid) return false;
+    }
+    return true;
+}
+
+// A signal method also stops descendants or the whole process group and a
+// cgroup freeze every member, so all of them have to belong to the user
+inline bool helperOwnsTargets(const std::vector<procctrl::detail::FreezeTarget>& targets, uid_t uid) {
+    if (uid == 0) return true;
+    for (const auto& target : targets) {
+        if (!helperOwnsAll(procctrl::detail::reached_by(target.pid, target.method, target.cgroup_path), uid)) return false;
+    }
+    return true;
+}
+
+// Calibration tries every method on each process
+inline bool helperMayCalibrate(const std::string& name, uid_t uid) {
+    if (uid == 0) return true;
+    static const procctrl::FreezeMethod methods[] = {
+        procctrl::FreezeMethod::CgroupFreeze, procctrl::FreezeMethod::ProcessGroup, procctrl::FreezeMethod::SignalTree
+    };
+    for (pid_t pid : procctrl::find_all_processes_by_name(name)) {
+        if (!helperOwnsProcess(pid, uid)) return false;
+        std::string cgroup_path = procctrl::get_cgroup_v2_path(pid);
+        for (procctrl::FreezeMethod method : methods) {
+            if (!helperOwnsAll(procctrl::detail::reached_by(pid, method, cgroup_path), uid)) return false;
+        }
+    }
+    return true;
+}
+
+inline bool helperMayWriteCgroup(const std::string& cgroup, const std::string& file, uid_t uid) {
+    if (cgroup.compare(0, 15, "/sys/fs/cgroup/") != 0 || cgroup.find("..") != std::string::npos) return false;
+    if (file != "cpu.max" && file != "cpu.weight" && file != "memory.high") return false;
+    return uid == 0 || cgroup.find("/user-" + std::to_string(uid) + ".slice/") != std::string::npos;
+}
+
+// What the client still has frozen; thawed if it goes away
+struct HelperFrozen {
+    std::set<pid_t> pids;
+    std::set<std::string> names;
+};
+
+// Run one command for a client of `uid`. Negative errno on refusal.
+inline int32_t helperExecute(const privhelper::Command& command, uid_t uid, HelperFrozen& frozen, bool& shutdown) {
+    switch (command.op) {
+    case privhelper::OP_NOP:
+        return 0;
+
+    case privhelper::OP_EMIT_INPUT: {
+        struct input_event events[privhelper::MAX_EVENTS] = {};
+        size_t count = std::min(static_cast<size_t>(command.count), privhelper::MAX_EVENTS);
+        for (size_t i = 0; i < count; ++i) {
+            events[i].type = command.events[i].type;
+            events[i].code = command.events[i].code;
+            events[i].value = command.events[i].value;
+        }
+        input.writeEvents(events, count);
+        return static_cast<int32_t>(count);
+    }
+
+    case privhelper::OP_SUSPEND:
+    case privhelper::OP_RESUME: {
+        bool suspend = command.op == privhelper::OP_SUSPEND;
+        procctrl::freeze_method_override = static_cast<procctrl::FreezeMethod>(command.arg & 0xFF);
+        procctrl::confirm_timeout_ms = static_cast<int>(command.arg >> 8);
+        std::vector<pid_t> pids;
+        std::vector<procctrl::detail::FreezeTarget> targets;
+        size_t count = std::min(static_cast<size_t>(command.count), privhelper::MAX_PIDS);
+        for (size_t i = 0; i < count; ++i) {
+            if (!helperOwnsProcess(command.pids[i], uid)) return -EPERM;
+            pids.push_back(command.pids[i]);
+            procctrl::detail::FreezeTarget target;
+            if (procctrl::detail::resolve(command.pids[i], suspend, target)) targets.push_back(std::move(target));
+        }
+        if (!helperOwnsTargets(targets, uid)) return -EPERM;
+        int done = procctrl::detail::set_targets_suspended(targets, suspend);
+        for (pid_t pid : pids) {
+            if (suspend) frozen.pids.insert(pid);
+            else frozen.pids.erase(pid);
+        }
+        return done;
+    }
+
+    case privhelper::OP_SUSPEND_BY_NAME:
+    case privhelper::OP_RESUME_BY_NAME:
+    case privhelper::OP_CALIBRATE: {
+        std::string name(command.text, strnlen(command.text, sizeof(command.text)));
+        if (name.empty()) return -EPERM;
+        procctrl::freeze_method_override = static_cast<procctrl::FreezeMethod>(command.arg & 0xFF);
+        procctrl::confirm_timeout_ms = static_cast<int>(command.arg >> 8);
+        // Measuring takes up to a second; freezes keep being served meanwhile
+        if (command.op == privhelper::OP_CALIBRATE) {
+            if (!helperMayCalibrate(name, uid)) return -EPERM;
+            return procctrl::calibrate_processes_by_name_async(name) ? 1 : 0;
+        }
+        bool suspend = command.op == privhelper::OP_SUSPEND_BY_NAME;
+        std::vector<procctrl::detail::FreezeTarget> targets = procctrl::detail::targets_by_name(name, suspend);
+        if (!helperOwnsTargets(targets, uid)) return -EPERM;
+        if (suspend) frozen.names.insert(name);
+        else frozen.names.erase(name);
+        return procctrl::detail::set_targets_suspended(targets, suspend);
+    }
+
+    case privhelper::OP_CGROUP_WRITE: {
+        // "<cgroup>\0<file>\0<value>", count bytes
+        size_t length = std::min<size_t>(command.count, sizeof(command.text));
+        std::vector<std::string> parts;
+        size_t start = 0;
+        for (size_t i = 0; i < length; ++i) {
+            if (command.text[i] != '\0') continue;
+            parts.emplace_back(command.text + start, i - start);
+            start = i + 1;
+        }
+        if (start < length) parts.emplace_back(command.text + start, length - start);
+        if (parts.size() != 3 || !helperMayWriteCgroup(parts[0], parts[1], uid)) return -EPERM;
+        return procctrl::write_cgroup_value(parts[0], parts[1].c_str(), parts[2]) ? 0 : -EIO;
+    }
+
+    case privhelper::OP_SET_PRIORITY: {
+        // Negative nice and the realtime I/O class need root; the whole tree must be the user's
+        pid_t pid = command.pids[0];
+        if (command.count != 1 || !helperOwnsProcess(pid, uid)) return -EPERM;
+        std::vector<pid_t> tree = procctrl::get_process_tree(pid);
+        if (!helperOwnsAll(tree, uid)) return -EPERM;
+        bool set_nice = command.arg & 1;
+        int nice = static_cast<int>((command.arg >> 1) & 0x7F) - 20;
+        int io_class = static_cast<int>((command.arg >> 8) & 0xF);
+        int io_level = static_cast<int>((command.arg >> 12) & 0x7);
+        if (nice > 19 || io_class > 3) return -EINVAL;
+        bool success = true;
+        for (pid_t member : tree) {
+            if (set_nice) success = procctrl::set_process_nice(member, nice) && success;
+            if (io_class) success = procctrl::set_process_io_priority(member, io_class, io_level) && success;
+        }
+        return success ? 0 : -EIO;
+    }
+
+    case privhelper::OP_SET_AFFINITY:
+        // Only the helper itself, so no ownership to check
+        if (command.values[0] == 0) return 0;
+        return procctrl::set_process_affinity(getpid(), command.values[0]) ? 0 : -EIO;
+
+    case privhelper::OP_SHUTDOWN:
+        shutdown = true;
+        return 0;
+
+    default:
+        return -EINVAL;
+    }
+}
+
+// Serve one connected client until it disconnects or asks for a shutdown
+inline void helperServe(privhelper::Channel& channel, int sock, uid_t uid, bool& shutdown) {
+    metrics::Histogram& command_time = metrics::get("Helper command");
+    HelperFrozen frozen;
+    privhelper::Command command;
+    while (!helper_signalled && !shutdown) {
+        if (channel.wait_command(command, 250)) {
+            uint64_t start_ns = metrics::now_ns();
+            channel.complete(command.seq, helperExecute(command, uid, frozen, shutdown));
+            command_time.record(metrics::now_ns() - start_ns);
+            continue;
+        }
+        // The client never writes to the socket: readable means it hung up
+        pollfd fd = {sock, POLLIN | POLLRDHUP, 0};
+        if (poll(&fd, 1, 0) > 0) break;
+    }
+
+    // Never leave a client frozen behind a crashed UI
+    if (!frozen.pids.empty()) {
+        procctrl::set_processes_suspended(std::vector<pid_t>(frozen.pids.begin(), frozen.pids.end()), false);
+    }
+    for (const std::string& name : frozen.names) procctrl::resume_processes_by_name(name);
+}
+
+// `--helper`: runs as root until SIGINT/SIGTERM or a client's OP_SHUTDOWN.
+// One client at a time, which must be the sudo user (or root).
+inline int runPrivilegedHelper(std::string socket_path) {
+    if (geteuid() != 0) {
+        asynclog::write(asynclog::Level::Error, "[helper] The helper has to run as root");
+        return 1;
+    }
+    const char* sudo_uid = getenv("SUDO_UID");
+    const char* sudo_gid = getenv("SUDO_GID");
+    uid_t uid = sudo_uid ? static_cast<uid_t>(atoi(sudo_uid)) : 0;
+    gid_t gid = sudo_gid ? static_cast<gid_t>(atoi(sudo_gid)) : 0;
+    if (socket_path.empty()) socket_path = helperSocketPath(uid);
+
+    int listener = privhelper::listen_socket(socket_path, uid, gid);
+    if (listener < 0) {
+        asynclog::write(asynclog::Level::Error, "[helper] Cannot listen on %s: %s", socket_path.c_str(), strerror(errno));
+        return 1;
+    }
+    std::signal(SIGINT, [](int) { helper_signalled = 1; });
+    std::signal(SIGTERM, [](int) { helper_signalled = 1; });
+
+    // Device events go to whichever client is connected
+    std::mutex active_mutex;
+    privhelper::Channel* active = nullptr;
+    input.setRawListener([&](size_t device, const struct input_event& event, bool recordable) {
+        std::lock_guard<std::mutex> lock(active_mutex);
+        if (!active) return;
+        privhelper::DeviceEvent forwarded;
+        forwarded.time_ns = static_cast<uint64_t>(event.input_event_sec) * 1000000000ULL +
+                            static_cast<uint64_t>(event.input_event_usec) * 1000ULL;
+        forwarded.device = static_cast<uint32_t>(device);
+        forwarded.type = event.type;
+        forwarded.code = event.code;
+        forwarded.value = event.value;
+        forwarded.recordable = recordable;
+        active->post_event(forwarded);
+    });
+    input.init();
+    asynclog::write(asynclog::Level::Info, "[helper] Listening on %s for uid %u", socket_path.c_str(), uid);
+
+    bool shutdown = false;
+    while (!helper_signalled && !shutdown) {
+        pollfd fd = {listener, POLLIN, 0};
+        if (poll(&fd, 1, 500) <= 0) continue;
+        int sock = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (sock < 0) continue;
+
+        // Device events include every key typed: only our own UI gets the channel
+        long peer = privhelper::peer_uid(sock);
+        privhelper::Channel channel;
+        if ((peer != static_cast<long>(uid) && peer != 0) || !privhelper::peer_runs_same_executable(sock) ||
+            !channel.create() || !channel.send(sock)) {
+            asynclog::write(asynclog::Level::Warn, "[helper] Refused a connection from uid %ld", peer);
+            close(sock);
+            continue;
+        }
+        asynclog::write(asynclog::Level::Info, "[helper] Client connected (uid %ld)", peer);
+        {
+            std::lock_guard<std::mutex> lock(active_mutex);
+            active = &channel;
+        }
+        helperServe(channel, sock, static_cast<uid_t>(peer), shutdown);
+        {
+            std::lock_guard<std::mutex> lock(active_mutex);
+            active = nullptr;
+        }
+        close(sock);
+        asynclog::write(asynclog::Level::Info, "[helper] Client disconnected");
+    }
+
+    procctrl::stop_calibration();
+    input.cleanup();
+    input.setRawListener(nullptr);
+    close(listener);
+    privhelper::remove_socket(socket_path, uid, gid);
+    return 0;
+}
+
+// ---------------------------------------------------------------- UI side
+
+inline int32_t helperCall(privhelper::Command& command) {
+    uint32_t seq = helper_channel.submit(command, helper_timeout_ms);
+    int32_t result;
+    if (seq == 0 || !helper_channel.wait_result(seq, helper_timeout_ms, result)) return -ETIMEDOUT;
+    return result;
+}
+
+// Physical key events from the helper into our CrossInput (key states, recorder)
+inline void helperEventLoop() {
+    TRACE_THREAD_NAME("helper events");
+    privhelper::DeviceEvent event;
+    while (helper_connected) {
+        if (helper_channel.wait_event(event, 100)) {
+            struct input_event forwarded = {};
+            forwarded.input_event_sec = static_cast<decltype(forwarded.input_event_sec)>(event.time_ns / 1000000000ULL);
+            forwarded.input_event_usec = static_cast<decltype(forwarded.input_event_usec)>(event.time_ns % 1000000000ULL / 1000ULL);
+            forwarded.type = event.type;
+            forwarded.code = event.code;
+            forwarded.value = event.value;
+            input.feedEvent(event.device, forwarded, event.recordable != 0);
+            continue;
+        }
+        pollfd fd = {helper_socket, POLLIN | POLLRDHUP, 0};
+        if (poll(&fd, 1, 0) > 0) {
+            helper_connected = false;
+            input.setOutputSink(nullptr);
+            asynclog::write(asynclog::Level::Warn, "[helper] The privileged helper went away");
+        }
+    }
+}
+
+inline void disconnectPrivilegedHelper(bool shutdown_helper) {
+    if (shutdown_helper && helper_connected) {
+        privhelper::Command command = {};
+        command.op = privhelper::OP_SHUTDOWN;
+        helper_channel.submit(command);
+    }
+    helper_connected = false;
+    input.setOutputSink(nullptr);
+    if (helper_event_thread.joinable()) helper_event_thread.join();
+
+    std::unique_lock<std::shared_mutex> lock(helper_mutex);
+    helper_channel.reset();
+    if (helper_socket >= 0) close(helper_socket);
+    helper_socket = -1;
+}
+
+// Connect to a running helper (default: the one of this user)
+inline bool connectPrivilegedHelper(std::string path = "") {
+    disconnectPrivilegedHelper(false);
+    if (path.empty()) path = helperSocketPath(getuid());
+    int sock = privhelper::connect_socket(path);
+    if (sock < 0) return false;
+    {
+        std::unique_lock<std::shared_mutex> lock(helper_mutex);
+        if (!helper_channel.receive(sock)) {
+            close(sock);
+            asynclog::write(asynclog::Level::Warn, "[helper] %s did not hand over its channel", path.c_str());
+            return false;
+        }
+        helper_socket = sock;
+        helper_connected = true;
+    }
+    // The utility CPUs of a profile applied before this helper was there
+    if (helper_utility_cpus) {
+        std::shared_lock<std::shared_mutex> lock(helper_mutex);
+        privhelper::Command command = {};
+        command.op = privhelper::OP_SET_AFFINITY;
+        command.values[0] = helper_utility_cpus;
+        helperCall(command);
+    }
+
+    input.setOutputSink([](const struct input_event* events, size_t count) {
+        privhelper::Command command = {};
+        command.op = privhelper::OP_EMIT_INPUT;
+        command.count = static_cast<uint32_t>(std::min(count, privhelper::MAX_EVENTS));
+        for (size_t i = 0; i < command.count; ++i) {
+            command.events[i] = {events[i].type, events[i].code, events[i].value};
+        }
+        std::shared_lock<std::shared_mutex> lock(helper_mutex);
+        if (helper_connected) helper_channel.submit(command);    // fire and forget
+    });
+    helper_event_thread = std::thread(helperEventLoop);
+    asynclog::write(asynclog::Level::Info, "[helper] Connected to %s", path.c_str());
+    return true;
+}
+
+// Start `utility --helper` through sudo with the user's password and connect to it
+inline bool startPrivilegedHelper(const char* password) {
+    char exe_path[4096] = {0};
+    if (readlink("/proc/self/exe", exe_path, sizeof(exe_path) - 1) <= 0) return false;
+    std::string socket_path = helperSocketPath(getuid());
+
+    // The password goes through a pipe to sudo -S, never through a shell
+    int password_pipe[2];
+    if (pipe2(password_pipe, O_CLOEXEC) != 0) return false;
+    pid_t child = fork();
+    if (child < 0) {
+        close(password_pipe[0]);
+        close(password_pipe[1]);
+        return false;
+    }
+    if (child == 0) {
+        setsid();
+        // Second fork: the helper is reparented and never becomes our zombie
+        if (fork() != 0) _exit(0);
+        dup2(password_pipe[0], STDIN_FILENO);
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd >= 0) dup2(null_fd, STDOUT_FILENO);
+        execlp("sudo", "sudo", "-S", "-p", "", exe_path, "--helper", "--socket", socket_path.c_str(),
+               static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    close(password_pipe[0]);
+    std::string line = std::string(password) + "\n";
+    ssize_t written = write(password_pipe[1], line.data(), line.size());
+    (void)written;
+    close(password_pipe[1]);
+    waitpid(child, nullptr, 0);
+
+    // sudo checks the password first; give it a few seconds to come up
+    for (int attempt = 0; attempt < 60; ++attempt) {
+        if (connectPrivilegedHelper(socket_path)) {
+            helper_started_here = true;
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    return false;
+}
+#else
+inline void disconnectPrivilegedHelper(bool) {}
+#endif
+
+// ---------------------------------------------------------------- routing
+// Privileged operations of the app: through the helper when connected,
+// in-process otherwise
+
+inline int setProcessesSuspended(const std::vector<pid_t>& pids, bool suspend) {
+#if defined(__linux__)
+    std::shared_lock<std::shared_mutex> lock(helper_mutex);
+    if (helper_connected) {
+        int done = 0;
+        for (size_t start = 0; start < pids.size(); start += privhelper::MAX_PIDS) {
+            privhelper::Command command = {};
+            command.op = suspend ? privhelper::OP_SUSPEND : privhelper::OP_RESUME;
+            command.arg = helperFreezeOptions();
+            command.count = static_cast<uint32_t>(std::min(pids.size() - start, privhelper::MAX_PIDS));
+            std::copy(pids.begin() + start, pids.begin() + start + command.count, command.pids);
+            done += std::max(0, helperCall(command));
+        }
+        return done;
+    }
+#endif
+    return procctrl::set_processes_suspended(pids, suspend);
+}
+
+inline int setProcessesSuspendedByName(const std::string& name, bool suspend) {
+#if defined(__linux__)
+    std::shared_lock<std::shared_mutex> lock(helper_mutex);
+    if (helper_connected && name.size() < privhelper::COMMAND_PAYLOAD) {
+        privhelper::Command command = {};
+        command.op = suspend ? privhelper::OP_SUSPEND_BY_NAME : privhelper::OP_RESUME_BY_NAME;
+        command.arg = helperFreezeOptions();
+        command.count = static_cast<uint32_t>(name.size());
+        memcpy(command.text, name.c_str(), name.size() + 1);
+        return std::max(0, helperCall(command));
+    }
+#endif
+    return suspend ? procctrl::suspend_processes_by_name(name) : procctrl::resume_processes_by_name(name);
+}
+
+// Nice and I/O class of a process and all its descendants
+inline bool setProcessTreePriority(pid_t pid, bool set_nice, int nice, int io_class, int io_level) {
+#if defined(__linux__)
+    std::shared_lock<std::shared_mutex> lock(helper_mutex);
+    if (helper_connected) {
+        privhelper::Command command = {};
+        command.op = privhelper::OP_SET_PRIORITY;
+        command.arg = helperPriorityOptions(set_nice, nice, io_class, io_level);
+        command.count = 1;
+        command.pids[0] = pid;
+        int32_t result = helperCall(command);
+        if (result != 0) {
+            asynclog::write(asynclog::Level::Warn, "[helper] Setting the priority of PID %d failed: %s",
+                            static_cast<int>(pid), strerror(-result));
+        }
+        return result == 0;
+    }
+#endif
+    bool success = true;
+    for (pid_t member : procctrl::get_process_tree(pid)) {
+        if (set_nice) success = procctrl::set_process_nice(member, nice) && success;
+        if (io_class) success = procctrl::set_process_io_priority(member, io_class, io_level) && success;
+    }
+    return success;
+}
+
+// The helper emits the keys and freezes, so it runs on the utility CPUs as well
+inline void setHelperAffinity(uint64_t cpu_mask) {
+#if defined(__linux__)
+    std::shared_lock<std::shared_mutex> lock(helper_mutex);
+    helper_utility_cpus = cpu_mask;
+    if (!helper_connected || cpu_mask == 0) return;
+    privhelper::Command command = {};
+    command.op = privhelper::OP_SET_AFFINITY;
+    command.values[0] = cpu_mask;
+    int32_t result = helperCall(command);
+    if (result != 0) {
+        asynclog::write(asynclog::Level::Warn, "[helper] Pinning the helper failed: %s", strerror(-result));
+    }
+#else
+    (void)cpu_mask;
+#endif
+}
+
+#ifndef _WIN32
+// Measure the freeze methods in the background (in the helper when there is
+// one). Returns at once; 1 if a measurement started.
+inline int calibrateProcessesByName(const std::string& name) {
+#if defined(__linux__)
+    std::shared_lock<std::shared_mutex> lock(helper_mutex);
+    if (helper_connected && name.size() < privhelper::COMMAND_PAYLOAD) {
+        privhelper::Command command = {};
+        command.op = privhelper::OP_CALIBRATE;
+        command.arg = helperFreezeOptions();
+        command.count = static_cast<uint32_t>(name.size());
+        memcpy(command.text, name.c_str(), name.size() + 1);
+        return std::max(0, helperCall(command));
+    }
+#endif
+    return procctrl::calibrate_processes_by_name_async(name) ? 1 : 0;
+}
+
+inline bool writeCgroupValue(const std::string& cgroup, const char* file, const std::string& value) {
+#if defined(__linux__)
+    std::shared_lock<std::shared_mutex> lock(helper_mutex);
+    std::string text = cgroup + '\0' + file + '\0' + value;
+    if (helper_connected && text.size() <= privhelper::COMMAND_PAYLOAD) {
+        privhelper::Command command = {};
+        command.op = privhelper::OP_CGROUP_WRITE;
+        command.count = static_cast<uint32_t>(text.size());
+        memcpy(command.text, text.data(), text.size());
+        int32_t result = helperCall(command);
+        if (result != 0) {
+            asynclog::write(asynclog::Level::Warn, "[helper] Writing %s/%s failed: %s", cgroup.c_str(), file, strerror(-result));
+        }
+        return result == 0;
+    }
+#endif
+    return procctrl::write_cgroup_value(cgroup, file, value);
+}
+#endif
@@ -0,0 +1,298 @@
+#pragma once
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Globals.hpp"
+#include "Helper.hpp"
+#include "metrics.hpp"
+#include "procctrl.hpp"
+#include "trace.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <grp.h>
+#include <poll.h>
+#include <pwd.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char** environ;
+#endif
+
+// Restart/rejoin without shells: the running clients are killed by PID,
+// their exit is awaited (pidfds on Linux, process handles on Windows) and
+// the roblox:// URI is launched with fork/exec, as the invoking user when
+// hypersuite runs under sudo. Every phase is timed.
+
+struct RejoinTimings {
+    int killed = 0;
+    double kill_ms = 0.0;
+    double exit_ms = 0.0;
+    double launch_ms = 0.0;
+    bool exited = true;         // every old client was gone before the launch
+    bool launched = false;
+};
+
+inline std::mutex rejoin_mutex;
+inline RejoinTimings last_rejoin;
+inline std::atomic<bool> rejoin_running(false);
+inline int rejoin_exit_timeout_ms = 3000;
+
+inline std::string rejoinUrl() {
+    if (strlen(placeIdBuffer) == 0) return "";
+    std::string url = "roblox://experiences/start?placeId=" + std::string(placeIdBuffer);
+    if (strlen(instanceIdBuffer) > 0) {
+        url += "&gameInstanceId=" + std::string(instanceIdBuffer);
+    }
+    return url;
+}
+
+#ifndef _WIN32
+// Kill `pids` and wait until they have exited (or timeout_ms passed).
+// @return true if all of them exited in time
+inline bool killAndWait(const std::vector<pid_t>& pids, int timeout_ms, RejoinTimings& timings) {
+    uint64_t start_ns = metrics::now_ns();
+    std::vector<pollfd> pidfds;
+    std::vector<pid_t> unwatched;
+    for (pid_t pid : pids) {
+#if defined(SYS_pidfd_open) && defined(SYS_pidfd_send_signal)
+        int fd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+        if (fd >= 0) {
+            // Signalled through the pidfd, so a recycled PID can't be hit
+            if (syscall(SYS_pidfd_send_signal, fd, SIGKILL, nullptr, 0) == 0) {
+                pidfds.push_back({fd, POLLIN, 0});
+                ++timings.killed;
+            } else {
+                close(fd);
+            }
+            continue;
+        }
+#endif
+        // Kernel without pidfds
+        if (kill(pid, SIGKILL) == 0) {
+            unwatched.push_back(pid);
+            ++timings.killed;
+        }
+    }
+    uint64_t killed_ns = metrics::now_ns();
+    timings.kill_ms = (killed_ns - start_ns) / 1e6;
+
+    // A pidfd turns readable once its process has exited
+    bool exited = true;
+    uint64_t deadline_ns = killed_ns + static_cast<uint64_t>(timeout_ms) * 1000000ULL;
+    while (!pidfds.empty()) {
+        uint64_t now_ns = metrics::now_ns();
+        if (now_ns >= deadline_ns) {
+            exited = false;
+            break;
+        }
+        int ready = poll(pidfds.data(), pidfds.size(), static_cast<int>((deadline_ns - now_ns) / 1000000ULL) + 1);
+        if (ready < 0 && errno != EINTR) break;
+        for (size_t i = pidfds.size(); i-- > 0;) {
+            if (pidfds[i].revents) {
+                close(pidfds[i].fd);
+                pidfds.erase(pidfds.begin() + i);
+            }
+        }
+    }
+    for (const pollfd& fd : pidfds) close(fd.fd);
+
+    for (pid_t pid : unwatched) {
+        while (kill(pid, 0) == 0) {
+            if (metrics::now_ns() >= deadline_ns) {
+                exited = false;
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+    timings.exit_ms = (metrics::now_ns() - killed_ns) / 1e6;
+    return exited;
+}
+
+// Start `args` detached (own session, output to /dev/null). Under sudo it runs
+// as SUDO_USER with that user's home, runtime dir and session bus.
+// @return true once the program was exec'd
+inline bool launchDetached(const std::vector<std::string>& args) {
+    // Everything the child needs is prepared here: after fork() only
+    // async-signal-safe calls are allowed in a multithreaded process
+    const char* sudo_user = geteuid() == 0 ? getenv("SUDO_USER") : nullptr;
+    struct passwd* pw = sudo_user ? getpwnam(sudo_user) : nullptr;
+    uid_t uid = pw ? pw->pw_uid : 0;
+    gid_t gid = pw ? pw->pw_gid : 0;
+    std::vector<gid_t> groups;
+
+    std::vector<std::string> env_strings;
+    if (pw) {
+        int count = 64;
+        groups.resize(count);
+        if (getgrouplist(pw->pw_name, gid, groups.data(), &count) < 0) {
+            groups.resize(count);
+            getgrouplist(pw->pw_name, gid, groups.data(), &count);
+        }
+        groups.resize(count);
+
+        const char* replaced[] = {"HOME=", "USER=", "LOGNAME=", "SHELL=", "MAIL=", "SUDO_", "XDG_RUNTIME_DIR=",
+                                  "DBUS_SESSION_BUS_ADDRESS="};
+        for (char** entry = environ; *entry; ++entry) {
+            bool keep = true;
+            for (const char* prefix : replaced) keep = keep && strncmp(*entry, prefix, strlen(prefix)) != 0;
+            if (keep) env_strings.push_back(*entry);
+        }
+        std::string runtime_dir = "/run/user/" + std::to_string(uid);
+        env_strings.push_back(std::string("HOME=") + pw->pw_dir);
+        env_strings.push_back(std::string("USER=") + pw->pw_name);
+        env_strings.push_back(std::string("LOGNAME=") + pw->pw_name);
+        env_strings.push_back(std::string("SHELL=") + pw->pw_shell);
+        env_strings.push_back("XDG_RUNTIME_DIR=" + runtime_dir);
+        env_strings.push_back("DBUS_SESSION_BUS_ADDRESS=unix:path=" + runtime_dir + "/bus");
+    } else {
+        for (char** entry = environ; *entry; ++entry) env_strings.push_back(*entry);
+    }
+    std::vector<char*> envp;
+    for (std::string& entry : env_strings) envp.push_back(&entry[0]);
+    envp.push_back(nullptr);
+
+    std::vector<std::string> arg_strings = args;
+    std::vector<char*> argv;
+    for (std::string& arg : arg_strings) argv.push_back(&arg[0]);
+    argv.push_back(nullptr);
+    const char* home = pw ? pw->pw_dir : "/";
+
+    // The exec error comes back through this pipe; EOF means exec succeeded
+    int error_pipe[2];
+    if (pipe2(error_pipe, O_CLOEXEC) != 0) return false;
+
+    pid_t child = fork();
+    if (child < 0) {
+        close(error_pipe[0]);
+        close(error_pipe[1]);
+        return false;
+    }
+    if (child == 0) {
+        setsid();
+        // Second fork: the launched program is reparented and never becomes our zombie
+        if (fork() != 0) _exit(0);
+
+        int error = 0;
+        if (pw && (setgroups(groups.size(), groups.data()) != 0 || setgid(gid) != 0 || setuid(uid) != 0)) {
+            error = errno;
+        } else {
+            if (chdir(home) != 0) {
+                // Not fatal, the program gets the current directory
+            }
+            int null_fd = open("/dev/null", O_RDWR);
+            if (null_fd >= 0) {
+                dup2(null_fd, STDIN_FILENO);
+                dup2(null_fd, STDOUT_FILENO);
+                dup2(null_fd, STDERR_FILENO);
+                if (null_fd > STDERR_FILENO) close(null_fd);
+            }
+            execvpe(argv[0], argv.data(), envp.data());
+            error = errno;
+        }
+        ssize_t written = write(error_pipe[1], &error, sizeof(error));
+        (void)written;
+        _exit(127);
+    }
+
+    close(error_pipe[1]);
+    waitpid(child, nullptr, 0);
+    int error = 0;
+    ssize_t n;
+    do {
+        n = read(error_pipe[0], &error, sizeof(error));
+    } while (n < 0 && errno == EINTR);
+    close(error_pipe[0]);
+
+    if (n > 0) {
+        asynclog::write(asynclog::Level::Warn, "[rejoin] Could not start %s: %s", args[0].c_str(), strerror(error));
+        return false;
+    }
+    return true;
+}
+#endif
+
+// Kill the running clients, wait for them to exit and launch `url`
+// (or the app when it is empty). Runs on the calling thread.
+inline RejoinTimings runRejoin(const std::string& url) {
+    TRACE_SCOPE("rejoin", "rejoin");
+    static metrics::Histogram& kill_time = metrics::get("Rejoin kill");
+    static metrics::Histogram& exit_time = metrics::get("Rejoin exit wait");
+    static metrics::Histogram& launch_time = metrics::get("Rejoin launch");
+
+    RejoinTimings timings;
+
+    procctrl::ProcessSnapshot snapshot = procctrl::ProcessSnapshot::take(procctrl::ProcessSnapshot::Names);
+    std::vector<pid_t> clients = snapshot.find_by_name(roblox_process_name);
+#ifdef _WIN32
+    std::vector<HANDLE> handles;
+    uint64_t start_ns = metrics::now_ns();
+    for (pid_t pid : clients) {
+        HANDLE process = OpenProcess(PROCESS_TERMINATE | SYNCHRONIZE, FALSE, pid);
+        if (!process) continue;
+        if (TerminateProcess(process, 1)) {
+            handles.push_back(process);
+            ++timings.killed;
+        } else {
+            CloseHandle(process);
+        }
+    }
+    uint64_t killed_ns = metrics::now_ns();
+    timings.kill_ms = (killed_ns - start_ns) / 1e6;
+    for (size_t i = 0; i < handles.size(); i += MAXIMUM_WAIT_OBJECTS) {
+        DWORD count = static_cast<DWORD>(std::min<size_t>(MAXIMUM_WAIT_OBJECTS, handles.size() - i));
+        if (WaitForMultipleObjects(count, handles.data() + i, TRUE, rejoin_exit_timeout_ms) != WAIT_OBJECT_0) {
+            timings.exited = false;
+        }
+    }
+    for (HANDLE process : handles) CloseHandle(process);
+    uint64_t exited_ns = metrics::now_ns();
+    timings.exit_ms = (exited_ns - killed_ns) / 1e6;
+
+    timings.launched = reinterpret_cast<INT_PTR>(ShellExecuteA(nullptr, "open", url.empty() ? "roblox://" : url.c_str(),
+                                                               nullptr, nullptr, SW_SHOWNORMAL)) > 32;
+    timings.launch_ms = (metrics::now_ns() - exited_ns) / 1e6;
+#else
+    // The Flatpak client runs as sober.real under its launcher
+    for (pid_t pid : snapshot.find_by_name("sober.real")) {
+        if (std::find(clients.begin(), clients.end(), pid) == clients.end()) clients.push_back(pid);
+    }
+    timings.exited = killAndWait(clients, rejoin_exit_timeout_ms, timings);
+
+    uint64_t launch_start_ns = metrics::now_ns();
+    if (!url.empty()) {
+        timings.launched = launchDetached({"xdg-open", url});
+    } else {
+        timings.launched = launchDetached({"flatpak", "run", "org.vinegarhq.Sober"});
+    }
+    timings.launch_ms = (metrics::now_ns() - launch_start_ns) / 1e6;
+#endif
+
+    kill_time.record(static_cast<uint64_t>(timings.kill_ms * 1e6));
+    exit_time.record(static_cast<uint64_t>(timings.exit_ms * 1e6));
+    launch_time.record(static_cast<uint64_t>(timings.launch_ms * 1e6));
+    logfmt("Rejoin: killed %d client(s) in %.2f ms, exited after %.1f ms%s, launched in %.1f ms%s",
+           timings.killed, timings.kill_ms, timings.exit_ms, timings.exited ? "" : " (timed out)",
+           timings.launch_ms, timings.launched ? "" : " (failed)");
+
+    std::lock_guard<std::mutex> lock(rejoin_mutex);
+    last_rejoin = timings;
+    return timings;
+}
+
+// Restart/rejoin on a worker thread, so waiting for the old client doesn't stall the UI.
+// The URL is built here: the ID buffers belong to the UI thread.
+inline void restartRoblox() {
+    if (rejoin_running.exchange(true)) return;
+    std::thread([url = rejoinUrl()]() {
+        TRACE_THREAD_NAME("rejoin");
+        runRejoin(url);
+        rejoin_running = false;
+    }).detach();
+}
@@ -4,10 +4,14 @@
 #include <string>
 #include "json.hpp"
 #include "inpctrl.hpp"
+#include "procctrl.hpp"
+#include "asynclog.hpp"
 #include "Globals.hpp"
 #include "Speedglitch.hpp"
 #include "LagSwitch.hpp"
 #include "UserInterface.hpp"
+#include "Performance.hpp"
+#include "Governor.hpp"
 #include "imgui.h"
 
 using json = nlohmann::json;
@@ -24,6 +28,7 @@ inline namespace SettingsHandler {
         }
 
         j["ChatKey"] = static_cast<unsigned int>(ChatKey);
+        j["RecordKey"] = static_cast<unsigned int>(RecordKey);
         j["SpamKey"] = static_cast<unsigned int>(SpamKey);
 
         //-- Settings tab
@@ -32,6 +37,27 @@ inline namespace SettingsHandler {
         j["cam_fix_active"] = cam_fix_active;
         j["roblox_fps"] = roblox_fps;
         j["kb_layout"] = kb_layout;
+        j["chat_open_delay_ms"] = chat_open_delay_ms;
+        j["chat_key_delay_us"] = chat_key_delay_us;
+        j["freeze_confirm_timeout_ms"] = procctrl::confirm_timeout_ms;
+        j["freeze_method"] = static_cast<int>(procctrl::freeze_method_override);
+
+        //-- Performance profiles
+        for (const auto& [name, profile] : performance_profiles) {
+            j["performance_profiles"][name] = performanceProfileToJson(profile);
+        }
+        j["active_performance_profile"] = active_performance_profile;
+        j["performance_auto_apply"] = performance_auto_apply;
+
+        //-- Background governor
+        j["governor"] = {
+            {"enabled", governor_enabled},
+            {"mode", governor_mode},
+            {"cpu_percent", governor_cpu_percent},
+            {"memory_high_mb", governor_memory_high_mb},
+            {"run_ms", governor_run_ms},
+            {"period_ms", governor_period_ms},
+        };
 
         //-- Saves state
         for (int i = 0; i < sizeof(enabled) / sizeof(enabled[0]); i++) {
@@ -50,6 +76,7 @@ inline namespace SettingsHandler {
         j["rainbowSpeed"] = rainbowSpeed;
         j["rainbowSaturation"] = rainbowSaturation;
         j["rainbowValue"] = rainbowValue;
+        j["log_level"] = static_cast<int>(asynclog::min_level());
         j["resizable_window"] = resizable_window;
         j["decorated_window"] = decorated_window;
 
@@ -74,6 +101,8 @@ inline namespace SettingsHandler {
 
         if (j.contains("ChatKey"))
             ChatKey = static_cast<CrossInput::Key>(j["ChatKey"].get<unsigned int>());
+        if (j.contains("RecordKey"))
+            RecordKey = static_cast<CrossInput::Key>(j["RecordKey"].get<unsigned int>());
 
         if (j.contains("SpamKey"))
             SpamKey = static_cast<CrossInput::Key>(j["SpamKey"].get<unsigned int>());
@@ -93,6 +122,45 @@ inline namespace SettingsHandler {
         if (j.contains("kb_layout"))
             kb_layout = j["kb_layout"];
 
+        if (j.contains("chat_open_delay_ms"))
+            chat_open_delay_ms = j["chat_open_delay_ms"];
+
+        if (j.contains("chat_key_delay_us"))
+            chat_key_delay_us = j["chat_key_delay_us"].get<std::map<std::string, int>>();
+
+        if (j.contains("freeze_confirm_timeout_ms"))
+            procctrl::confirm_timeout_ms = j["freeze_confirm_timeout_ms"];
+
+        if (j.contains("freeze_method"))
+            procctrl::freeze_method_override = static_cast<procctrl::FreezeMethod>(j["freeze_method"].get<int>());
+
+        // -- Performance profiles
+        if (j.contains("performance_profiles")) {
+            performance_profiles.clear();
+            for (const auto& [name, profile] : j["performance_profiles"].items()) {
+                performance_profiles[name] = performanceProfileFromJson(profile);
+            }
+        }
+        if (j.contains("active_performance_profile"))
+            active_performance_profile = j["active_performance_profile"];
+        if (performance_profiles.count(active_performance_profile) == 0)
+            active_performance_profile = performance_profiles.empty() ? "Default" : performance_profiles.begin()->first;
+        activePerformanceProfile();
+
+        if (j.contains("performance_auto_apply"))
+            performance_auto_apply = j["performance_auto_apply"];
+
+        // -- Background governor
+        if (j.contains("governor")) {
+            const json& governor = j["governor"];
+            governor_enabled = governor.value("enabled", governor_enabled);
+            governor_mode = governor.value("mode", governor_mode);
+            governor_cpu_percent = governor.value("cpu_percent", governor_cpu_percent);
+            governor_memory_high_mb = governor.value("memory_high_mb", governor_memory_high_mb);
+            governor_run_ms = governor.value("run_ms", governor_run_ms);
+            governor_period_ms = governor.value("period_ms", governor_period_ms);
+        }
+
         // -- Load enabled array
         if (j.contains("enabled")) {
             for (int i = 0; i < 12; i++) {
@@ -123,6 +191,9 @@ inline namespace SettingsHandler {
         if (j.contains("rainbowSaturation"))
             rainbowSaturation = j["rainbowSaturation"].get<float>();
 
+        if (j.contains("log_level"))
+            asynclog::set_min_level(static_cast<asynclog::Level>(j["log_level"].get<int>()));
+
         if (j.contains("resizable_window")) {
             resizable_window = j["resizable_window"].get<float>();
             lastResizable = resizable_window;
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Helper.hpp"
+#include "metrics.hpp"
+#include "trace.hpp"
+
+// Time to first frame, split into the startup phases of main(). Everything
+// here runs on the main thread; the report is logged once and shown in the
+// Diagnostics tab.
+
+struct StartupPhase {
+    const char* name;
+    double ms;
+};
+
+inline uint64_t startup_begin_ns = metrics::now_ns();
+inline std::vector<StartupPhase> startup_phases;
+inline double startup_first_frame_ms = 0.0;
+
+// Times its scope as one phase; `name` must be a literal
+class StartupTimer {
+public:
+    explicit StartupTimer(const char* name)
+        : m_name(name), m_start_ns(metrics::now_ns())
+#ifdef HYPERSUITE_TRACE
+        , m_span("startup", name)
+#endif
+    {}
+    ~StartupTimer() { startup_phases.push_back({m_name, (metrics::now_ns() - m_start_ns) / 1e6}); }
+
+    StartupTimer(const StartupTimer&) = delete;
+    StartupTimer& operator=(const StartupTimer&) = delete;
+
+private:
+    const char* m_name;
+    uint64_t m_start_ns;
+#ifdef HYPERSUITE_TRACE
+    trace::Span m_span;
+#endif
+};
+
+// Called once the first frame (or headless tick) is done
+inline void startupFinished() {
+    if (startup_first_frame_ms > 0.0) return;
+    startup_first_frame_ms = (metrics::now_ns() - startup_begin_ns) / 1e6;
+
+    std::string phases;
+    for (const StartupPhase& phase : startup_phases) {
+        char entry[96];
+        snprintf(entry, sizeof(entry), "%s%s %.1f ms", phases.empty() ? "" : ", ", phase.name, phase.ms);
+        phases += entry;
+    }
+    logfmt("Startup: first frame after %.1f ms (%s)", startup_first_frame_ms, phases.c_str());
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include "Globals.hpp"
 #include "Helper.hpp"
+#include "GameProfiles.hpp"
 #include "procctrl.hpp"
 
 // Gear Desync Configuration
@@ -18,7 +19,7 @@ inline void gearDesyncLoop() {
         
         // Rapidly spam the gear slot
         // This needs to be VERY fast to trigger server throttling
-        input.pressKey(static_cast<CrossInput::Key>(
+        macro_backend->pressKey(static_cast<CrossInput::Key>(
             static_cast<int>(CrossInput::Key::Num0) + desync_gear_slot), 0);
         
         // No delay - we want this as fast as possible
@@ -36,7 +37,8 @@ inline void initGearDesync() {
 
 // Main gear desync macro
 inline void gearDesyncMacro() {
-    bool key_pressed = input.isKeyPressed(Binds["Gear-Desync"]);
+    CrossInput::Key trigger = macroProfile().binds[BIND_GEAR_DESYNC];
+    bool key_pressed = macro_backend->isKeyPressed(trigger);
     
     // This is a HOLD macro - must hold key to desync
     // User needs to hold for 4-7 seconds
@@ -16,6 +16,9 @@
 #include "Globals.hpp"
 #include "Helper.hpp"
 #include "RobloxFiles.hpp"
+#include "JoinHistory.hpp"
+#include "GameProfiles.hpp"
+#include "Rejoin.hpp"
 
 inline std::string GlobalBasicSettingsFile = "empty";
 inline char gbsPathBuffer[512] = "";
@@ -407,6 +410,15 @@ inline void renderRobloxSettingsWindow() {
             }
         }
 
+        {
+            std::lock_guard<std::mutex> lock(rejoin_mutex);
+            if (last_rejoin.launched || last_rejoin.killed > 0) {
+                ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "Last: kill %.1f ms, exit %.0f ms%s, launch %.0f ms",
+                                   last_rejoin.kill_ms, last_rejoin.exit_ms, last_rejoin.exited ? "" : " (timeout)",
+                                   last_rejoin.launch_ms);
+            }
+        }
+
         if (showRestartSuccess && restartMessageTimer > 0.0f) {
             if (isRestarting) {
                 ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.2f, 1.0f), "%s", restartStatusMsg.c_str());
@@ -423,6 +435,20 @@ inline void renderRobloxSettingsWindow() {
         ImGui::Separator();
         ImGui::Spacing();
 
+        // ===== JOIN LOAD TIMES SECTION =====
+        if (ImGui::CollapsingHeader("Join load times")) {
+            ImGui::Spacing();
+            renderJoinHistory();
+            ImGui::Spacing();
+        }
+
+        // ===== GAME PROFILES SECTION =====
+        if (ImGui::CollapsingHeader("Game profiles")) {
+            ImGui::Spacing();
+            renderGameProfiles();
+            ImGui::Spacing();
+        }
+
         // ===== ADVANCED SETTINGS SECTION =====
         if (ImGui::CollapsingHeader("Global basic settings editor")) {
             ImGui::Spacing();
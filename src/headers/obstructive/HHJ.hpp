@@ -1,6 +1,8 @@
 #pragma once
 #include "Globals.hpp"
 #include "Helper.hpp"
+#include "MacroRun.hpp"
+#include "GameProfiles.hpp"
 #include <thread>
 #include <atomic>
 #include <chrono>
@@ -10,7 +12,6 @@ inline void hhjSpeedglitchLoop()
 {
     int sleep1 = 16, sleep2 = 16;
     int last_fps = 0;
-    const float EPSILON = 0.008f;
 
     while (true) {
         // Wait until HHJ speedglitch is activated
@@ -18,35 +19,17 @@ inline void hhjSpeedglitchLoop()
             std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
 
-        // Recalculate delays if FPS changed
-        if (last_fps != roblox_fps) {
-            float delay_float = 1000.0f / static_cast<float>(roblox_fps);
-            int delay_floor = static_cast<int>(delay_float);
-            int delay_ceil = delay_floor + 1;
-            float fractional = delay_float - delay_floor;
+        // The table of the current game, for this rotation
+        const MacroProfile& profile = macroProfile();
 
-            if (fractional < 0.33f - EPSILON)
-            {
-                sleep1 = sleep2 = delay_floor;
-            }
-            else if (fractional > 0.66f + EPSILON)
-            {
-                sleep1 = sleep2 = delay_ceil;
-            }
-            else
-            {
-                sleep1 = delay_floor;
-                sleep2 = delay_ceil;
-            }
-
-            last_fps = roblox_fps;
+        // Recalculate delays if FPS changed
+        if (last_fps != profile.roblox_fps) {
+            speedglitchSleeps(profile.roblox_fps, sleep1, sleep2);
+            last_fps = profile.roblox_fps;
         }
 
         // Perform the speedglitch rotation
-        input.moveMouse(speed_pixels_x, 0);
-        std::this_thread::sleep_for(std::chrono::milliseconds(sleep1));
-        input.moveMouse(speed_pixels_y, 0);
-        std::this_thread::sleep_for(std::chrono::milliseconds(sleep2));
+        speedglitchRotation(profile, sleep1, sleep2);
     }
 }
 
@@ -62,95 +45,98 @@ inline void initHHJ()
 inline void helicopterHighJump()
 {
     static bool last_key_state = false;
-    bool key_pressed = input.isKeyPressed(Binds["HHJ"]);
+    const MacroProfile& profile = macroProfile();
+    CrossInput::Key trigger = profile.binds[BIND_HHJ];
+    bool key_pressed = macro_backend->isKeyPressed(trigger);
 
     // Trigger on key press (not hold)
     if (key_pressed && !last_key_state)
     {
-        log("HHJ triggered");
+        logfmt("HHJ triggered");
+        MacroRun run("hhj", trigger);
 
         // AUTO-TIMING MODE (Experimental)
-        if (hhj_auto_timing)
+        if (profile.hhj_auto_timing)
         {
-            input.holdKey(CrossInput::Key::Space); // Jump
-            std::this_thread::sleep_for(std::chrono::milliseconds(550));
-            input.holdKey(CrossInput::Key::W); // Hold W
-            std::this_thread::sleep_for(std::chrono::milliseconds(68));
+            macro_backend->holdKey(CrossInput::Key::Space); // Jump
+            run.wait(550);
+            macro_backend->holdKey(CrossInput::Key::W); // Hold W
+            run.wait(68);
         }
 
         // FREEZE PHASE
-        procctrl::suspend_processes_by_name(roblox_process_name);
-        log("HHJ: Game suspended");
+        macro_backend->suspend(roblox_process_name);
+        logfmt("HHJ: Game suspended");
 
         // Determine freeze duration
         int freeze_duration = 200; // Base duration
 
-        if (hhj_freeze_delay > 0)
+        if (profile.hhj_freeze_delay > 0)
         {
             // User override
-            freeze_duration = hhj_freeze_delay;
+            freeze_duration = profile.hhj_freeze_delay;
         }
         else
         {
             // Default: 500ms total, or 200ms if fast mode
-            if (!hhj_fast_mode)
+            if (!profile.hhj_fast_mode)
             {
                 freeze_duration += 300; // 500ms total
             }
         }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(freeze_duration));
+        run.wait(freeze_duration);
 
         // Release auto-timing keys if active
-        if (hhj_auto_timing)
+        if (profile.hhj_auto_timing)
         {
-            input.releaseKey(CrossInput::Key::Space);
-            input.releaseKey(CrossInput::Key::W);
+            macro_backend->releaseKey(CrossInput::Key::Space);
+            macro_backend->releaseKey(CrossInput::Key::W);
         }
 
         // UNFREEZE PHASE
-        procctrl::resume_processes_by_name(roblox_process_name);
-        log("HHJ: Game resumed");
+        macro_backend->resume(roblox_process_name);
+        logfmt("HHJ: Game resumed");
 
         // Delay 1: Wait before shiftlock
-        std::this_thread::sleep_for(std::chrono::milliseconds(hhj_delay1));
+        run.wait(profile.hhj_delay1);
 
         // Hold shiftlock (or zoom in if configured)
         if (!globalzoomin)
         {
-            input.holdKey(CrossInput::Key::LShift);
+            macro_backend->holdKey(CrossInput::Key::LShift);
         }
         else
         {
             // Note: Mouse wheel simulation would go here
             // For now using shift as fallback
-            input.holdKey(CrossInput::Key::LShift);
+            macro_backend->holdKey(CrossInput::Key::LShift);
         }
 
         // Delay 2: Wait before spinning
-        std::this_thread::sleep_for(std::chrono::milliseconds(hhj_delay2));
+        run.wait(profile.hhj_delay2);
 
         // START SPINNING (activate HHJ speedglitch)
         hhj_speedglitch_active.store(true, std::memory_order_relaxed);
-        log("HHJ: Spinning started");
+        logfmt("HHJ: Spinning started");
 
         // Delay 3: Hold shiftlock while spinning
-        std::this_thread::sleep_for(std::chrono::milliseconds(hhj_delay3));
+        run.wait(profile.hhj_delay3);
 
         // Release shiftlock
         if (!globalzoomin)
         {
-            input.releaseKey(CrossInput::Key::LShift);
+            macro_backend->releaseKey(CrossInput::Key::LShift);
         }
 
         // Continue spinning for HHJ length
-        std::this_thread::sleep_for(std::chrono::milliseconds(hhj_length));
+        run.wait(profile.hhj_length);
 
         // STOP SPINNING
         hhj_speedglitch_active.store(false, std::memory_order_relaxed);
-        log("HHJ: Spinning stopped");
+        logfmt("HHJ: Spinning stopped");
 
-        log("HHJ completed");
+        logfmt("HHJ completed");
     }
 
     last_key_state = key_pressed;
@@ -160,6 +146,7 @@ inline void helicopterHighJump()
 inline void updateHHJLength(int new_length)
 {
     hhj_length = new_length;
+    rebuildMacroProfiles();
     log("HHJ length updated to: " + std::to_string(new_length) + "ms");
 }
 
@@ -168,6 +155,7 @@ inline void updateHHJDelays(int delay1, int delay2, int delay3)
     hhj_delay1 = delay1;
     hhj_delay2 = delay2;
     hhj_delay3 = delay3;
+    rebuildMacroProfiles();
     log("HHJ delays updated: " + std::to_string(delay1) + ", " +
         std::to_string(delay2) + ", " + std::to_string(delay3));
 }
@@ -175,17 +163,20 @@ inline void updateHHJDelays(int delay1, int delay2, int delay3)
 inline void updateHHJFreezeDelay(int delay)
 {
     hhj_freeze_delay = delay;
+    rebuildMacroProfiles();
     log("HHJ freeze delay override: " + std::to_string(delay) + "ms");
 }
 
 inline void setHHJAutoTiming(bool enabled)
 {
     hhj_auto_timing = enabled;
+    rebuildMacroProfiles();
     log("HHJ auto-timing: " + std::string(enabled ? "enabled" : "disabled"));
 }
 
 inline void setHHJFastMode(bool enabled)
 {
     hhj_fast_mode = enabled;
+    rebuildMacroProfiles();
     log("HHJ fast mode: " + std::string(enabled ? "enabled" : "disabled"));
 }
\ No newline at end of file
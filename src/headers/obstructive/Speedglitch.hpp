@@ -1,15 +1,13 @@
 #pragma once
 #include "Globals.hpp"
 #include "Helper.hpp"
+#include "GameProfiles.hpp"
 #include "raylib.h"
 #include <cmath>
 
 // Calculate pixel value for 180° rotation based on sensitivity
 inline void calculateSpeedglitchPixels() {
-    float base_value = cam_fix_active ? 500.0f : 360.0f;
-    float multiplier = (359.0f / 360.0f) * (359.0f / 360.0f); // Slight adjustment for accuracy
-    
-    speed_pixels_x = static_cast<int>(std::round((base_value / roblox_sensitivity) * multiplier));
+    speed_pixels_x = speedglitchPixels(roblox_sensitivity, cam_fix_active);
     speed_pixels_y = -speed_pixels_x; // Opposite direction
     
     log("Speedglitch pixels calculated: " + std::to_string(speed_pixels_x));
@@ -19,7 +17,6 @@ inline void calculateSpeedglitchPixels() {
 inline void speedglitchLoop() {
     int sleep1 = 16, sleep2 = 16;
     int last_fps = 0;
-    const float EPSILON = 0.008f; // For floating-point comparison
     
     while (true) {
         // Wait until speedglitch is activated
@@ -27,35 +24,20 @@ inline void speedglitchLoop() {
             std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
         
+        // The table of the current game, for this rotation
+        const MacroProfile& profile = macroProfile();
+
         // Recalculate delays if FPS changed
-        if (last_fps != roblox_fps) {
-            float delay_float = 1000.0f / static_cast<float>(roblox_fps);
-            int delay_floor = static_cast<int>(delay_float);
-            int delay_ceil = delay_floor + 1;
-            float fractional = delay_float - delay_floor;
-            
+        if (last_fps != profile.roblox_fps) {
             // Distribute delays intelligently
-            if (fractional < 0.33f - EPSILON) {
-                sleep1 = sleep2 = delay_floor;
-            }
-            else if (fractional > 0.66f + EPSILON) {
-                sleep1 = sleep2 = delay_ceil;
-            }
-            else {
-                sleep1 = delay_floor;
-                sleep2 = delay_ceil;
-            }
-            
-            last_fps = roblox_fps;
+            speedglitchSleeps(profile.roblox_fps, sleep1, sleep2);
+            last_fps = profile.roblox_fps;
             log("Speedglitch delays updated: sleep1=" + std::to_string(sleep1) + 
                 ", sleep2=" + std::to_string(sleep2));
         }
         
-        // Perform the speedglitch rotation
-        input.moveMouse(speed_pixels_x, 0);  // Rotate 180° one way
-        std::this_thread::sleep_for(std::chrono::milliseconds(sleep1));
-        input.moveMouse(speed_pixels_y, 0);  // Rotate 180° back
-        std::this_thread::sleep_for(std::chrono::milliseconds(sleep2));
+        // Perform the speedglitch rotation (180° one way and back)
+        speedglitchRotation(profile, sleep1, sleep2);
     }
 }
 
@@ -70,7 +52,8 @@ inline void initSpeedglitch() {
 // Macro function to toggle speedglitch
 inline void speedglitchMacro() {
     static bool last_key_state = false;
-    bool key_pressed = input.isKeyPressed(Binds["Speedglitch"]);
+    CrossInput::Key trigger = macroProfile().binds[BIND_SPEEDGLITCH];
+    bool key_pressed = macro_backend->isKeyPressed(trigger);
     
     // Toggle on key press (not hold)
     if (key_pressed && !last_key_state) {
@@ -88,7 +71,8 @@ inline void speedglitchMacro() {
 
 // Alternative: Hold-key version of speedglitch
 inline void speedglitchMacroHold() {
-    bool key_pressed = input.isKeyPressed(Binds["Speedglitch"]);
+    CrossInput::Key trigger = macroProfile().binds[BIND_SPEEDGLITCH];
+    bool key_pressed = macro_backend->isKeyPressed(trigger);
     
     if (key_pressed) {
         speedglitch_active = true;
@@ -102,11 +86,13 @@ inline void updateSpeedglitchSensitivity(float new_sensitivity, bool new_cam_fix
     roblox_sensitivity = new_sensitivity;
     cam_fix_active = new_cam_fix;
     calculateSpeedglitchPixels();
+    rebuildMacroProfiles();
 }
 
 // Update FPS (call this when user changes FPS setting)
 inline void updateSpeedglitchFPS(int new_fps) {
     SetTargetFPS(new_fps);
     roblox_fps = new_fps;
+    rebuildMacroProfiles();
     log("Speedglitch FPS updated to: " + std::to_string(new_fps));
 }
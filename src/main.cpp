@@ -33,8 +33,21 @@
 #include "procctrl.hpp"
 #include "netctrl.hpp"
 #include "logzz.hpp"
+#include "asynclog.hpp"
+#include "trace.hpp"
+#include "metrics.hpp"
+#include "framestats.hpp"
 #include "LagSwitch.hpp"
 #include "MacroLoopHandler.hpp"
+#include "Instances.hpp"
+#include "Performance.hpp"
+#include "Governor.hpp"
+#include "Monitor.hpp"
+#include "JoinHistory.hpp"
+#include "ControlSocket.hpp"
+#include "PrivilegedHelper.hpp"
+#include "GameProfiles.hpp"
+#include "StartupTiming.hpp"
 #include "Helper.hpp"
 #include "RobloxFiles.hpp"
 #include "UserInterface.hpp"
@@ -51,29 +64,184 @@
 #include <cstdlib>
 #include <cstdio>
 #include <map>
+#include <csignal>
 
-int main() {
+// PID owning the focused window, 0 if unknown
 #if defined(__linux__)
+static pid_t focusedWindowPid() {
+    static Display* display = nullptr;
+    static Atom active_window, wm_pid;
+    if (!display) {
+        if (!hasX11Display() || !(display = XOpenDisplay(nullptr))) return 0;
+        active_window = XInternAtom(display, "_NET_ACTIVE_WINDOW", False);
+        wm_pid = XInternAtom(display, "_NET_WM_PID", False);
+    }
+
+    auto readCardinal = [](Window window, Atom property, Atom type, unsigned long& value) {
+        Atom actual_type;
+        int actual_format;
+        unsigned long items, bytes_after;
+        unsigned char* data = nullptr;
+        if (XGetWindowProperty(display, window, property, 0, 1, False, type, &actual_type, &actual_format,
+                               &items, &bytes_after, &data) != Success || !data) return false;
+        bool found = items == 1 && actual_format == 32;
+        if (found) value = *reinterpret_cast<unsigned long*>(data);
+        XFree(data);
+        return found;
+    };
+
+    // A window can be gone by the time it is queried; don't let Xlib exit on BadWindow.
+    // Only around these requests, the rest of the process (raylib/GLFW) keeps its own handler
+    XErrorHandler previous = XSetErrorHandler([](Display*, XErrorEvent*) { return 0; });
+    unsigned long window = 0, pid = 0;
+    bool found = readCardinal(DefaultRootWindow(display), active_window, XA_WINDOW, window) && window != 0 &&
+                 readCardinal(static_cast<Window>(window), wm_pid, XA_CARDINAL, pid);
+    XSync(display, False);
+    XSetErrorHandler(previous);
+    return found ? static_cast<pid_t>(pid) : 0;
+}
+#else
+static pid_t focusedWindowPid() {
+    DWORD pid = 0;
+    HWND window = GetForegroundWindow();
+    if (window) GetWindowThreadProcessId(window, &pid);
+    return pid;
+}
+#endif
+
+// Work of the main loop that doesn't depend on the window (GUI and headless)
+static void periodicWork(double now) {
+    // Profiles for clients the instances thread found
+    static double last_performance_tick = -10.0;
+    if (now - last_performance_tick > 2.0) {
+        performanceTick();
+        last_performance_tick = now;
+    }
+
+    // Limits/duty cycle for the clients in the background
+    static double last_governor_tick = -10.0;
+    if (now - last_governor_tick > 0.25) {
+        governorTick(focusedWindowPid());
+        last_governor_tick = now;
+    }
+
+    // Binds and timings of the game being played (profiles.json)
+    macroProfileTick(logzz::current_place_ID, logzz::current_universe_ID);
+
+#ifndef _WIN32
+    // Measure the freeze methods while the game is loading, not on the first macro
+    static state last_state = OFFLINE;
+    if (is_elevated && logzz::current_state == IN_GAME && last_state != IN_GAME) {
+        calibrateProcessesByName(roblox_process_name);
+    }
+    last_state = logzz::current_state;
+#endif
+}
+
+static volatile std::sig_atomic_t stop_requested = 0;
+
+// --headless: macros, log watcher and control socket, no window or GL context
+static void runHeadless(const std::string& socket_path) {
+    std::signal(SIGINT, [](int) { stop_requested = 1; });
+    std::signal(SIGTERM, [](int) { stop_requested = 1; });
+
+    ControlServer control;
+    control.start(socket_path.empty() ? ControlServer::defaultPath() : socket_path);
+    log("Running headless");
+
+    // Macros poll their keys every tick; the client log only needs a look every 100 ms
+    const int TICK_MS = 4;
+    metrics::Histogram& tick_time = metrics::get("Headless tick");
+    uint64_t last_log_check_ns = 0;
+    while (!stop_requested && !control.quitRequested()) {
+        TRACE_SCOPE("headless", "tick");
+        uint64_t tick_start_ns = metrics::now_ns();
+        {
+            FRAME_SCOPE(framestats::MACROS);
+            UpdateMacros();
+        }
+        if (tick_start_ns - last_log_check_ns > 100000000ULL) {
+            FRAME_SCOPE(framestats::LOGZZ);
+            logzz::loop_handle();
+            last_log_check_ns = tick_start_ns;
+        }
+        periodicWork(tick_start_ns / 1e9);
+        tick_time.record(metrics::now_ns() - tick_start_ns);
+        framestats::end_frame();
+        startupFinished();
+
+        control.poll(TICK_MS);  // sleeps until the next tick or a command
+    }
+    control.stop();
+}
+
+int main(int argc, char** argv) {
+    bool headless = false;
+    bool helper = false;
+    std::string socket_path;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--helper") {
+            helper = true;
+        } else if (arg == "--socket" && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--headless | --helper] [--socket PATH]\n";
+            return 2;
+        }
+    }
+
+    // Async logger: stdout, a rotating file and the in-app log panel
+    asynclog::set_file(helper ? "hypersuite-helper.log" : "hypersuite.log", 1 << 20, 3);
+    asynclog::start();
+    TRACE_THREAD_NAME("main");
+
+#if defined(__linux__)
+    // Privileged helper for an unprivileged UI: devices, cgroups and freezing only
+    if (helper) {
+        int status = runPrivilegedHelper(socket_path);
+        asynclog::stop();
+        return status;
+    }
+
     //Fix for unable to open display ":0" on wayland
-    runXhostPlus();
+    // (only root needs it; a UI using the helper is the user's own X client)
+    if (isElevated()) runXhostPlus();
 #else
     SetConfigFlags(FLAG_WINDOW_HIGHDPI);
     //SetThreadDpiAwarenessContext(DPI_AWARENESS_CONTEXT_UNAWARE_GDISCALED); // Fixes weird scaling issues.
 #endif
     is_elevated = isElevated();
-    if (is_elevated) {
-        InitWindow(500, 400, "Roblox hypersuite");
-    } else InitWindow(300, 150, "Roblox hypersuite");
+#if defined(__linux__)
+    // A helper left running by an earlier session does the privileged work for us
+    if (!is_elevated) {
+        StartupTimer timer("helper connect");
+        if (connectPrivilegedHelper()) is_elevated = true;
+    }
+#endif
+    if (!headless) {
+        // The tutorial images decode on their own thread while the window opens
+        LoadAllSprites();
 
-    screen_width = GetScreenWidth();
-    screen_height = GetScreenHeight();
+        StartupTimer timer("window init");
+        if (is_elevated) {
+            InitWindow(500, 400, "Roblox hypersuite");
+        } else InitWindow(300, 150, "Roblox hypersuite");
+
+        screen_width = GetScreenWidth();
+        screen_height = GetScreenHeight();
+    }
 
     // Default values
 #ifdef _WIN32
     roblox_process_name = "RobloxPlayerBeta.exe";
-    Image icon = LoadImage("resources/logo.png");
-    SetWindowIcon(icon);                           // Sets taskbar + title bar icon
-    UnloadImage(icon);                             // Free image memory
+    if (!headless) {
+        Image icon = LoadEmbeddedImage("logo.png");
+        SetWindowIcon(icon);                           // Sets taskbar + title bar icon
+        UnloadImage(icon);                             // Free image memory
+    }
     logzz::logs_folder_path = getRobloxAppDataDirectory() + "\\logs";
     logzz::local_storage_folder_path = getRobloxAppDataDirectory() + "\\LocalStorage";
 #else
@@ -83,29 +251,71 @@ int main() {
 #endif
 
     kb_layout = 0;
-    SetTargetFPS(60);
+    if (!headless) SetTargetFPS(60);
     //-------- LOADING THE FREAKING SETTINGS
-    SettingsHandler::LoadSettings();
+    {
+        StartupTimer timer("settings load");
+        SettingsHandler::LoadSettings();
+        loadMacroProfiles();
+    }
 
     // getting the username, userid, display name etc.. from appstorage.json
-    logzz::load_user_info();
+    {
+        StartupTimer timer("load_user_info");
+        logzz::load_user_info();
+    }
+
+    // Join/load time history for the Roblox tab, fed by logzz::loop_handle()
+    {
+        StartupTimer timer("join history");
+        initJoinHistory();
+    }
 
     //Initializes the user interface.
-    initUI();
-    LoadAllSprites();
+    if (!headless) {
+        StartupTimer timer("UI init");
+        initUI();
+    }
     // For globalbasicsettings
-    if (GlobalBasicSettingsFile == "empty") setGBSFileDirectory();
+    if (GlobalBasicSettingsFile == "empty") {
+        StartupTimer timer("setGBSFileDirectory");
+        setGBSFileDirectory();
+    }
 
     //Initlializes the ctrl object for netctrl
     g_ctrl = &ctrl;
 
     //Initializes the input object.
-    if (!input.init()) {
-        std::cerr << "Failed to initialize input system!\n";
-        return 1;
+    {
+        StartupTimer timer("input init");
+        if (!input.init()) {
+            std::cerr << "Failed to initialize input system!\n";
+            return 1;
+        }
+    }
+
+    {
+        StartupTimer timer("macros init");
+        initMacros();
+    }
+
+    // Client instances for the Instances tab and macro targets
+    instancesStart();
+
+    if (headless) {
+        runHeadless(socket_path);
+        SettingsHandler::SaveSettings();
+        instancesStop();
+        governorShutdown();
+#ifndef _WIN32
+        procctrl::stop_calibration();
+#endif
+        disconnectPrivilegedHelper(helper_started_here);
+        input.cleanup();
+        asynclog::stop();
+        return 0;
     }
 
-    initMacros();
     // No window border for windows :p
 #ifdef _WIN32
     if (!decorated_window) SetWindowState(FLAG_WINDOW_UNDECORATED);
@@ -114,10 +324,20 @@ int main() {
 
     Vector2 dragOffset = {0};
     bool isDragging = false;
+    metrics::Histogram& ui_frame_time = metrics::get("UI frame");
 
     while (!WindowShouldClose()) {
-       UpdateMacros();
-       logzz::loop_handle();
+       TRACE_SCOPE("ui", "frame");
+       uint64_t frame_start_ns = metrics::now_ns();
+       {
+           FRAME_SCOPE(framestats::MACROS);
+           UpdateMacros();
+       }
+       {
+           FRAME_SCOPE(framestats::LOGZZ);
+           logzz::loop_handle();
+       }
+       periodicWork(GetTime());
 
        if (resizable_window != lastResizable) {
             if (resizable_window)
@@ -205,19 +425,39 @@ int main() {
         rlImGuiBegin();
 
         //Updates the imgui window.
-        UpdateUI();
+        {
+            TRACE_SCOPE("ui", "UpdateUI");
+            FRAME_SCOPE(framestats::UI);
+            UpdateUI();
+        }
+        // Frame work only: macros, log polling and building the UI (not the FPS limiter wait)
+        ui_frame_time.record(metrics::now_ns() - frame_start_ns);
 
         // End ImGui frame
-        rlImGuiEnd();
-        EndDrawing();
+        {
+            TRACE_SCOPE("ui", "EndDrawing");
+            FRAME_SCOPE(framestats::RENDER);
+            rlImGuiEnd();
+            EndDrawing();
+        }
+        framestats::end_frame();
+        startupFinished();
         std::this_thread::sleep_for(std::chrono::milliseconds(10)); // no 100% cpu usage
     }
 
     // Cleanup
     SettingsHandler::SaveSettings();
+    instancesStop();
+    governorShutdown();
+    monitorStop();
+#ifndef _WIN32
+    procctrl::stop_calibration();
+#endif
+    disconnectPrivilegedHelper(helper_started_here);
     input.cleanup();
     rlImGuiShutdown();
     UnloadAllTextures();
     CloseWindow();
+    asynclog::stop();
     return 0;
 }